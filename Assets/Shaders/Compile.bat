@@ -1,3 +1,5 @@
+C:\VulkanSDK\1.2.189.2\Bin\glslc.exe Graphics.vert -o Graphics.vert.spv
+C:\VulkanSDK\1.2.189.2\Bin\glslc.exe Graphics.frag -o Graphics.frag.spv
 C:\VulkanSDK\1.2.189.2\Bin\glslc.exe RayTracing.rgen -o RayTracing.rgen.spv --target-spv=spv1.4
 C:\VulkanSDK\1.2.189.2\Bin\glslc.exe RayTracing.rmiss -o RayTracing.rmiss.spv --target-spv=spv1.4
 C:\VulkanSDK\1.2.189.2\Bin\glslc.exe RayTracing.rchit -o RayTracing.rchit.spv --target-spv=spv1.4
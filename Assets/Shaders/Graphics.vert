@@ -2,15 +2,18 @@
 #extension GL_ARB_separate_shader_objects : enable
 #extension GL_GOOGLE_include_directive : require
 #include "Material.glsl"
+#include "Packing.glsl"
 #include "UniformBufferObject.glsl"
 
 layout(binding = 0) readonly uniform UniformBufferObjectStruct { UniformBufferObject Camera; };
 layout(binding = 1) readonly buffer MaterialArray { Material[] Materials; };
 
 layout(location = 0) in vec3 InPosition;
-layout(location = 1) in vec3 InNormal;
+layout(location = 1) in vec2 InNormal; // Octahedral encoded.
 layout(location = 2) in vec2 InTexCoord;
-layout(location = 3) in int InMaterialIndex;
+layout(location = 3) in uint InMaterialIndex;
+layout(location = 4) in mat4 InTransform; // Per instance, occupies locations 4 to 7.
+layout(location = 8) in int InMaterialOverride; // Per instance, replaces the vertex material when not negative.
 
 layout(location = 0) out vec3 FragColor;
 layout(location = 1) out vec3 FragNormal;
@@ -24,11 +27,14 @@ out gl_PerVertex
 
 void main() 
 {
-	Material m = Materials[InMaterialIndex];
+	const int materialIndex = InMaterialOverride >= 0 ? InMaterialOverride : int(InMaterialIndex);
+	Material m = Materials[materialIndex];
 
-    gl_Position = Camera.Projection * Camera.ModelView * vec4(InPosition, 1.0);
+	const vec3 worldNormal = mat3(transpose(inverse(InTransform))) * DecodeOctahedralNormal(InNormal);
+
+    gl_Position = Camera.Projection * Camera.ModelView * InTransform * vec4(InPosition, 1.0);
     FragColor = m.Diffuse.xyz;
-	FragNormal = vec3(Camera.ModelView * vec4(InNormal, 0.0)); // technically not correct, should be ModelInverseTranspose
+	FragNormal = vec3(Camera.ModelView * vec4(worldNormal, 0.0)); // technically not correct, should be ModelInverseTranspose
 	FragTexCoord = InTexCoord;
-	FragMaterialIndex = InMaterialIndex;
+	FragMaterialIndex = materialIndex;
 }
@@ -0,0 +1,10 @@
+
+// Matches Resources::InstanceData. One entry per model instance, found at gl_InstanceCustomIndexEXT + gl_GeometryIndexEXT.
+struct Instance
+{
+	mat4 Transform;
+	uint IndexOffset;
+	uint VertexOffset;
+	int MaterialIndex; // Overrides the vertex materials when not negative.
+	uint ModelIndex;
+};
\ No newline at end of file
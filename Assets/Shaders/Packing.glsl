@@ -0,0 +1,12 @@
+
+// Inverse of the octahedral encoding in Resources::Vertex::Compress. Unfolds the lower hemisphere from the corners of the square.
+vec3 DecodeOctahedralNormal(const vec2 octahedral)
+{
+	vec3 normal = vec3(octahedral.xy, 1.0 - abs(octahedral.x) - abs(octahedral.y));
+	const float fold = max(-normal.z, 0.0);
+
+	normal.x += normal.x >= 0.0 ? -fold : fold;
+	normal.y += normal.y >= 0.0 ? -fold : fold;
+
+	return normalize(normal);
+}
\ No newline at end of file
@@ -1,23 +1,23 @@
+#include "Packing.glsl"
 
 struct Vertex
 {
-  vec3 Position;
   vec3 Normal;
   vec2 TexCoord;
   int MaterialIndex;
 };
 
+// Vertices holds Resources::CompressedVertex entries. Positions live in a separate buffer only used to build the acceleration structures.
 Vertex UnpackVertex(uint index)
 {
-	const uint vertexSize = 9;
+	const uint vertexSize = 3;
 	const uint offset = index * vertexSize;
 	
 	Vertex v;
 	
-	v.Position = vec3(Vertices[offset + 0], Vertices[offset + 1], Vertices[offset + 2]);
-	v.Normal = vec3(Vertices[offset + 3], Vertices[offset + 4], Vertices[offset + 5]);
-	v.TexCoord = vec2(Vertices[offset + 6], Vertices[offset + 7]);
-	v.MaterialIndex = floatBitsToInt(Vertices[offset + 8]);
+	v.Normal = DecodeOctahedralNormal(unpackSnorm2x16(Vertices[offset + 0]));
+	v.TexCoord = unpackHalf2x16(Vertices[offset + 1]);
+	v.MaterialIndex = int(Vertices[offset + 2] & 0xFFFF);
 
 	return v;
 }
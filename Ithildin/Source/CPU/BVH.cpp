@@ -0,0 +1,441 @@
+#include "BVH.h"
+#include "Core/TaskPool.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <numeric>
+
+namespace CPU
+{
+    namespace BVHUtilities
+    {
+        const uint32_t BinCount = 16;
+        const uint32_t MaxLeafSize = 8;
+        const uint32_t TaskThreshold = 4 * 1024; // Smaller subtrees are built by the task that splits them off.
+        const uint32_t ChunkSize = 64 * 1024;    // Passes over more primitives than this are split across the pool.
+
+        // Relative costs of visiting a node and intersecting a primitive.
+        const float TraversalCost = 1.0f;
+        const float IntersectionCost = 1.0f;
+
+        struct Bounds
+        {
+            glm::vec3 m_Minimum = glm::vec3(std::numeric_limits<float>::max());
+            glm::vec3 m_Maximum = glm::vec3(std::numeric_limits<float>::lowest());
+
+            void Grow(const glm::vec3& point)
+            {
+                m_Minimum = glm::min(m_Minimum, point);
+                m_Maximum = glm::max(m_Maximum, point);
+            }
+
+            void Grow(const Bounds& bounds)
+            {
+                m_Minimum = glm::min(m_Minimum, bounds.m_Minimum);
+                m_Maximum = glm::max(m_Maximum, bounds.m_Maximum);
+            }
+
+            float GetSurfaceArea() const
+            {
+                if (m_Minimum.x > m_Maximum.x)
+                {
+                    return 0.0f;
+                }
+
+                const glm::vec3 extent = m_Maximum - m_Minimum;
+                return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+            }
+        };
+
+        struct Bin
+        {
+            Bounds m_Bounds;
+            uint32_t m_Count = 0;
+        };
+
+        typedef std::array<std::array<Bin, BinCount>, 3> BinGrid; // Binned along each axis.
+
+        // Slab test. Returns the entry distance, or infinity if the box is missed within [tMin, tMax).
+        float IntersectBounds(const BVH::Node& node, const glm::vec3& origin, const glm::vec3& inverseDirection, float tMin, float tMax)
+        {
+            const glm::vec3 t0 = (node.m_BoundsMinimum - origin) * inverseDirection;
+            const glm::vec3 t1 = (node.m_BoundsMaximum - origin) * inverseDirection;
+            const glm::vec3 tNear = glm::min(t0, t1);
+            const glm::vec3 tFar = glm::max(t0, t1);
+
+            const float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, tMin));
+            const float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+
+            return entry <= exit ? entry : std::numeric_limits<float>::infinity();
+        }
+
+        // Maps a centroid to its bin. Binning and partitioning have to agree exactly, so both go through here.
+        uint32_t GetBinIndex(float centroid, float minimum, float scale)
+        {
+            const int32_t bin = static_cast<int32_t>((centroid - minimum) * scale);
+            return static_cast<uint32_t>(std::clamp(bin, 0, static_cast<int32_t>(BinCount) - 1));
+        }
+
+        // Reduces function(chunkBegin, chunkEnd) over [begin, end), in parallel when the range is large enough to pay for it.
+        template<typename TResult, typename TFunction, typename TMerge>
+        TResult ParallelReduce(Parallel::TaskPool& taskPool, uint32_t begin, uint32_t end, const TFunction& function, const TMerge& merge)
+        {
+            const uint32_t chunkCount = std::min((end - begin) / ChunkSize, taskPool.GetWorkerCount() * 4);
+
+            if (chunkCount <= 1)
+            {
+                return function(begin, end);
+            }
+
+            std::vector<TResult> results(chunkCount);
+
+            taskPool.ForEach(chunkCount, [&](uint32_t chunk)
+            {
+                const uint32_t chunkBegin = begin + static_cast<uint32_t>(uint64_t(end - begin) * chunk / chunkCount);
+                const uint32_t chunkEnd = begin + static_cast<uint32_t>(uint64_t(end - begin) * (chunk + 1) / chunkCount);
+
+                results[chunk] = function(chunkBegin, chunkEnd);
+            });
+
+            for (uint32_t i = 1; i != chunkCount; ++i)
+            {
+                merge(results[0], results[i]);
+            }
+
+            return results[0];
+        }
+    }
+
+    struct BVH::BuildState
+    {
+        explicit BuildState(Parallel::TaskPool& taskPool) : m_TaskPool(taskPool)
+        {
+        }
+
+        Parallel::TaskPool& m_TaskPool;
+        Parallel::TaskPool::TaskGroup m_TaskGroup;
+
+        std::vector<BVHUtilities::Bounds> m_PrimitiveBounds;
+        std::vector<glm::vec3> m_Centroids;
+
+        std::atomic<uint32_t> m_NodeCount = 1; // The root.
+        std::atomic<uint32_t> m_LeafCount = 0;
+        std::atomic<uint32_t> m_MaxDepth = 0;
+    };
+
+    BVH::BVH(const SceneGeometry& geometry, Parallel::TaskPool& taskPool) : m_Geometry(geometry)
+    {
+        const std::chrono::high_resolution_clock::time_point timer = std::chrono::high_resolution_clock::now();
+        const uint32_t primitiveCount = geometry.GetNumberOfPrimitives();
+
+        if (primitiveCount == 0)
+        {
+            return;
+        }
+
+        BuildState state(taskPool);
+        state.m_PrimitiveBounds.resize(primitiveCount);
+        state.m_Centroids.resize(primitiveCount);
+
+        const uint32_t chunkCount = (primitiveCount + BVHUtilities::ChunkSize - 1) / BVHUtilities::ChunkSize;
+
+        taskPool.ForEach(chunkCount, [&](uint32_t chunk)
+        {
+            const uint32_t end = std::min(primitiveCount, (chunk + 1) * BVHUtilities::ChunkSize);
+
+            for (uint32_t i = chunk * BVHUtilities::ChunkSize; i != end; ++i)
+            {
+                const std::pair<glm::vec3, glm::vec3> bounds = geometry.GetBoundingBox(i);
+
+                state.m_PrimitiveBounds[i] = { bounds.first, bounds.second };
+                state.m_Centroids[i] = (bounds.first + bounds.second) * 0.5f;
+            }
+        });
+
+        m_PrimitiveIndices.resize(primitiveCount);
+        std::iota(m_PrimitiveIndices.begin(), m_PrimitiveIndices.end(), 0u);
+
+        // A binary tree with at least one primitive per leaf never needs more nodes than this.
+        m_Nodes.resize(2 * static_cast<size_t>(primitiveCount) - 1);
+
+        Build(state, 0, 0, primitiveCount, 0);
+        taskPool.Wait(state.m_TaskGroup);
+
+        m_Nodes.resize(state.m_NodeCount);
+        m_Nodes.shrink_to_fit();
+
+        m_Statistics.m_BuildTime = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+        m_Statistics.m_NodeCount = state.m_NodeCount;
+        m_Statistics.m_LeafCount = state.m_LeafCount;
+        m_Statistics.m_MaxDepth = state.m_MaxDepth;
+        m_Statistics.m_SAHCost = ComputeSAHCost();
+    }
+
+    void BVH::Build(BuildState& state, uint32_t nodeIndex, uint32_t begin, uint32_t end, uint32_t depth)
+    {
+        using namespace BVHUtilities;
+
+        const uint32_t count = end - begin;
+
+        // Bounds of the primitives and of their centroids. Nodes near the root cover most of the scene, so this runs in parallel for them.
+        typedef std::pair<Bounds, Bounds> NodeBounds;
+
+        const NodeBounds nodeBounds = ParallelReduce<NodeBounds>(state.m_TaskPool, begin, end, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+        {
+            NodeBounds result;
+
+            for (uint32_t i = chunkBegin; i != chunkEnd; ++i)
+            {
+                result.first.Grow(state.m_PrimitiveBounds[m_PrimitiveIndices[i]]);
+                result.second.Grow(state.m_Centroids[m_PrimitiveIndices[i]]);
+            }
+
+            return result;
+        },
+        [](NodeBounds& result, const NodeBounds& other)
+        {
+            result.first.Grow(other.first);
+            result.second.Grow(other.second);
+        });
+
+        const Bounds& bounds = nodeBounds.first;
+        const Bounds& centroidBounds = nodeBounds.second;
+        const glm::vec3 centroidExtent = centroidBounds.m_Maximum - centroidBounds.m_Minimum;
+
+        const auto makeLeaf = [&]()
+        {
+            m_Nodes[nodeIndex] = { bounds.m_Minimum, begin, bounds.m_Maximum, count };
+            state.m_LeafCount.fetch_add(1, std::memory_order_relaxed);
+
+            uint32_t maxDepth = state.m_MaxDepth.load(std::memory_order_relaxed);
+            while (depth > maxDepth && !state.m_MaxDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed))
+            {
+            }
+        };
+
+        if (count == 1 || depth + 1 >= MaxDepth)
+        {
+            makeLeaf();
+            return;
+        }
+
+        // Sort the primitive centroids into bins along every axis.
+        const glm::vec3 scale(
+            centroidExtent.x > 0.0f ? BinCount / centroidExtent.x : 0.0f,
+            centroidExtent.y > 0.0f ? BinCount / centroidExtent.y : 0.0f,
+            centroidExtent.z > 0.0f ? BinCount / centroidExtent.z : 0.0f);
+
+        const BinGrid bins = ParallelReduce<BinGrid>(state.m_TaskPool, begin, end, [&](uint32_t chunkBegin, uint32_t chunkEnd)
+        {
+            BinGrid result = {};
+
+            for (uint32_t i = chunkBegin; i != chunkEnd; ++i)
+            {
+                const uint32_t primitiveIndex = m_PrimitiveIndices[i];
+                const glm::vec3& centroid = state.m_Centroids[primitiveIndex];
+
+                for (int axis = 0; axis != 3; ++axis)
+                {
+                    Bin& bin = result[axis][GetBinIndex(centroid[axis], centroidBounds.m_Minimum[axis], scale[axis])];
+                    bin.m_Bounds.Grow(state.m_PrimitiveBounds[primitiveIndex]);
+                    bin.m_Count++;
+                }
+            }
+
+            return result;
+        },
+        [](BinGrid& result, const BinGrid& other)
+        {
+            for (int axis = 0; axis != 3; ++axis)
+            {
+                for (uint32_t i = 0; i != BinCount; ++i)
+                {
+                    result[axis][i].m_Bounds.Grow(other[axis][i].m_Bounds);
+                    result[axis][i].m_Count += other[axis][i].m_Count;
+                }
+            }
+        });
+
+        // Evaluate the surface area heuristic for the planes between the bins, sweeping from both ends.
+        int bestAxis = -1;
+        uint32_t bestBin = 0;
+        float bestCost = std::numeric_limits<float>::max();
+
+        for (int axis = 0; axis != 3; ++axis)
+        {
+            if (centroidExtent[axis] <= 0.0f)
+            {
+                continue;
+            }
+
+            std::array<float, BinCount> rightAreas = {};
+            std::array<uint32_t, BinCount> rightCounts = {};
+            Bounds rightBounds;
+            uint32_t rightCount = 0;
+
+            for (uint32_t i = BinCount - 1; i != 0; --i)
+            {
+                rightBounds.Grow(bins[axis][i].m_Bounds);
+                rightCount += bins[axis][i].m_Count;
+                rightAreas[i] = rightBounds.GetSurfaceArea();
+                rightCounts[i] = rightCount;
+            }
+
+            Bounds leftBounds;
+            uint32_t leftCount = 0;
+
+            for (uint32_t i = 1; i != BinCount; ++i)
+            {
+                leftBounds.Grow(bins[axis][i - 1].m_Bounds);
+                leftCount += bins[axis][i - 1].m_Count;
+
+                if (leftCount == 0 || rightCounts[i] == 0)
+                {
+                    continue;
+                }
+
+                const float cost = leftBounds.GetSurfaceArea() * leftCount + rightAreas[i] * rightCounts[i];
+
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = i;
+                }
+            }
+        }
+
+        const float parentArea = bounds.GetSurfaceArea();
+        const float splitCost = TraversalCost + IntersectionCost * (parentArea > 0.0f ? bestCost / parentArea : 0.0f);
+        const float leafCost = IntersectionCost * count;
+
+        if (count <= MaxLeafSize && (bestAxis < 0 || splitCost >= leafCost))
+        {
+            makeLeaf();
+            return;
+        }
+
+        uint32_t middle = begin;
+
+        if (bestAxis >= 0)
+        {
+            const float minimum = centroidBounds.m_Minimum[bestAxis];
+            const float axisScale = scale[bestAxis];
+
+            middle = static_cast<uint32_t>(std::partition(m_PrimitiveIndices.begin() + begin, m_PrimitiveIndices.begin() + end, [&](uint32_t primitiveIndex)
+            {
+                return GetBinIndex(state.m_Centroids[primitiveIndex][bestAxis], minimum, axisScale) < bestBin;
+            }) - m_PrimitiveIndices.begin());
+        }
+
+        // Every centroid coincides, yet there are too many primitives for one leaf. Any split is as good as another.
+        if (middle == begin || middle == end)
+        {
+            middle = begin + count / 2;
+        }
+
+        const uint32_t firstChild = state.m_NodeCount.fetch_add(2, std::memory_order_relaxed);
+        m_Nodes[nodeIndex] = { bounds.m_Minimum, firstChild, bounds.m_Maximum, 0 };
+
+        // Hand one side to the pool and keep building the other, until the subtrees are too small to be worth a task.
+        if (count >= TaskThreshold)
+        {
+            state.m_TaskPool.Run(state.m_TaskGroup, [this, &state, firstChild, begin, middle, depth]()
+            {
+                Build(state, firstChild, begin, middle, depth + 1);
+            });
+        }
+        else
+        {
+            Build(state, firstChild, begin, middle, depth + 1);
+        }
+
+        Build(state, firstChild + 1, middle, end, depth + 1);
+    }
+
+    float BVH::ComputeSAHCost() const
+    {
+        const auto getArea = [](const Node& node)
+        {
+            const glm::vec3 extent = node.m_BoundsMaximum - node.m_BoundsMinimum;
+            return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+        };
+
+        const float rootArea = getArea(m_Nodes[0]);
+
+        if (rootArea <= 0.0f)
+        {
+            return 0.0f;
+        }
+
+        // Probability of a ray through the root visiting each node, times the cost of visiting it.
+        double cost = 0.0;
+
+        for (const Node& node : m_Nodes)
+        {
+            cost += getArea(node) / rootArea * (node.IsLeaf() ? BVHUtilities::IntersectionCost * node.m_PrimitiveCount : BVHUtilities::TraversalCost);
+        }
+
+        return static_cast<float>(cost);
+    }
+
+    bool BVH::Intersect(const Ray& ray, float tMin, float tMax, Hit& hit) const
+    {
+        const float miss = std::numeric_limits<float>::infinity();
+        const glm::vec3 inverseDirection = 1.0f / ray.m_Direction;
+
+        if (m_Nodes.empty() || BVHUtilities::IntersectBounds(m_Nodes[0], ray.m_Origin, inverseDirection, tMin, tMax) == miss)
+        {
+            return false;
+        }
+
+        hit.m_Distance = tMax;
+        bool isHit = false;
+
+        uint32_t stack[MaxDepth];
+        uint32_t stackSize = 0;
+        uint32_t nodeIndex = 0;
+
+        for (;;)
+        {
+            const Node& node = m_Nodes[nodeIndex];
+
+            if (node.IsLeaf())
+            {
+                for (uint32_t i = node.m_Offset; i != node.m_Offset + node.m_PrimitiveCount; ++i)
+                {
+                    isHit |= m_Geometry.Intersect(m_PrimitiveIndices[i], ray, tMin, hit);
+                }
+            }
+            else
+            {
+                // Visit the nearer child first, the farther one is often culled by the closer hit found meanwhile.
+                const float leftDistance = BVHUtilities::IntersectBounds(m_Nodes[node.m_Offset], ray.m_Origin, inverseDirection, tMin, hit.m_Distance);
+                const float rightDistance = BVHUtilities::IntersectBounds(m_Nodes[node.m_Offset + 1], ray.m_Origin, inverseDirection, tMin, hit.m_Distance);
+
+                if (leftDistance != miss && rightDistance != miss)
+                {
+                    const bool isLeftNearer = leftDistance <= rightDistance;
+                    stack[stackSize++] = node.m_Offset + (isLeftNearer ? 1 : 0);
+                    nodeIndex = node.m_Offset + (isLeftNearer ? 0 : 1);
+                    continue;
+                }
+
+                if (leftDistance != miss || rightDistance != miss)
+                {
+                    nodeIndex = node.m_Offset + (leftDistance != miss ? 0 : 1);
+                    continue;
+                }
+            }
+
+            if (stackSize == 0)
+            {
+                return isHit;
+            }
+
+            nodeIndex = stack[--stackSize];
+        }
+    }
+}
\ No newline at end of file
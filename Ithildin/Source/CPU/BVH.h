@@ -0,0 +1,62 @@
+#pragma once
+#include "SceneGeometry.h"
+#include <cstdint>
+#include <vector>
+
+namespace Parallel
+{
+    class TaskPool;
+}
+
+namespace CPU
+{
+    // Binary bounding volume hierarchy over the triangles and procedural spheres of a SceneGeometry.
+    // Built top down with the binned surface area heuristic, large subtrees are built in parallel on a task pool.
+    class BVH final
+    {
+    public:
+        // Two nodes per cache line. Siblings are always stored next to each other, so a single offset addresses both.
+        struct Node
+        {
+            glm::vec3 m_BoundsMinimum;
+            uint32_t m_Offset;         // Inner nodes: index of the first child, the second one follows it. Leaves: first entry of their primitive range.
+            glm::vec3 m_BoundsMaximum;
+            uint32_t m_PrimitiveCount; // 0 for inner nodes.
+
+            bool IsLeaf() const { return m_PrimitiveCount != 0; }
+        };
+
+        struct Statistics
+        {
+            float m_BuildTime = 0.0f; // Seconds.
+            uint32_t m_NodeCount = 0;
+            uint32_t m_LeafCount = 0;
+            uint32_t m_MaxDepth = 0;
+            float m_SAHCost = 0.0f;   // Expected cost of a ray through the root, in units of one primitive intersection.
+        };
+
+        static const uint32_t MaxDepth = 64; // Bounds the traversal stack.
+
+        BVH(const SceneGeometry& geometry, Parallel::TaskPool& taskPool);
+
+        const SceneGeometry& GetGeometry() const { return m_Geometry; }
+        const std::vector<Node>& GetNodes() const { return m_Nodes; }
+        const std::vector<uint32_t>& GetPrimitiveIndices() const { return m_PrimitiveIndices; } // Leaf ranges index into this array.
+        const Statistics& GetStatistics() const { return m_Statistics; }
+
+        // Finds the closest hit within [tMin, tMax).
+        bool Intersect(const Ray& ray, float tMin, float tMax, Hit& hit) const;
+
+    private:
+        struct BuildState;
+
+        void Build(BuildState& state, uint32_t nodeIndex, uint32_t begin, uint32_t end, uint32_t depth);
+        float ComputeSAHCost() const;
+
+    private:
+        const SceneGeometry& m_Geometry;
+        std::vector<Node> m_Nodes;
+        std::vector<uint32_t> m_PrimitiveIndices;
+        Statistics m_Statistics;
+    };
+}
\ No newline at end of file
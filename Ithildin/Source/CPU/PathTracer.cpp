@@ -0,0 +1,352 @@
+#include "PathTracer.h"
+#include "Random.h"
+#include "RayPacket.h"
+#include "WideBVH.h"
+#include "Core/ProcessorFeatures.h"
+#include "Core/TaskPool.h"
+#include "Resources/Model.h"
+#include "Resources/Scene.h"
+#include "Resources/Texture.h"
+#include "Resources/UniformBuffer.h"
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+namespace CPU
+{
+    namespace PathTracerUtilities
+    {
+        // The ray extent passed to traceRayEXT() by the shaders.
+        const float MinimumDistance = 0.001f;
+        const float MaximumDistance = 10000.0f;
+
+        // Polynomial approximation by Christophe Schlick.
+        float Schlick(const float cosine, const float refractionIndex)
+        {
+            float r0 = (1 - refractionIndex) / (1 + refractionIndex);
+            r0 *= r0;
+            return r0 + (1 - r0) * std::pow(1 - cosine, 5.0f);
+        }
+    }
+
+    PathTracer::PathTracer(const Resources::Scene& scene) : PathTracer(scene.GetModels(), scene.GetTextures())
+    {
+    }
+
+    PathTracer::PathTracer(const std::vector<Resources::Model>& models, const std::vector<Resources::Texture>& textures)
+    {
+        m_TaskPool.reset(new Parallel::TaskPool());
+        m_Geometry.reset(new SceneGeometry(models, textures));
+
+        std::unique_ptr<BVH> bvh(new BVH(*m_Geometry, *m_TaskPool));
+        const BVH::Statistics& statistics = bvh->GetStatistics();
+        std::cout << "- CPU BVH: " << m_Geometry->GetNumberOfPrimitives() << " primitives, " << statistics.m_NodeCount << " nodes (" << statistics.m_LeafCount << " leaves, depth " << statistics.m_MaxDepth
+                  << "), SAH cost " << statistics.m_SAHCost << ", built in " << statistics.m_BuildTime << " seconds.\n";
+
+        // Traced through a collapsed copy whose nodes are as wide as the vector registers.
+        if (ProcessorFeatures::Get().m_HasAVX2)
+        {
+            m_BVH8.reset(new WideBVH<8>(*bvh));
+
+            const WideBVH<8>::Statistics& wideStatistics = m_BVH8->GetStatistics();
+            std::cout << "- CPU BVH8: " << wideStatistics.m_NodeCount << " nodes, " << wideStatistics.m_AverageChildCount << " children on average, collapsed in " << wideStatistics.m_BuildTime << " seconds (AVX2).\n";
+        }
+        else
+        {
+            m_BVH4.reset(new WideBVH<4>(*bvh));
+
+            const WideBVH<4>::Statistics& wideStatistics = m_BVH4->GetStatistics();
+            std::cout << "- CPU BVH4: " << wideStatistics.m_NodeCount << " nodes, " << wideStatistics.m_AverageChildCount << " children on average, collapsed in " << wideStatistics.m_BuildTime << " seconds ("
+                      << (m_BVH4->IsVectorized() ? "SSE" : "scalar") << ").\n";
+        }
+
+        // Camera rays are traced as packets through the binary tree, which is only kept for them.
+        if (PacketTraverser::IsSupported())
+        {
+            m_BVH = std::move(bvh);
+            m_PacketTraverser.reset(new PacketTraverser(*m_BVH));
+        }
+    }
+
+    PathTracer::~PathTracer()
+    {
+        m_TaskPool.reset(); // Workers go first, nothing may be tracing once the scene data is released.
+        m_PacketTraverser.reset();
+        m_BVH.reset();
+        m_BVH4.reset();
+        m_BVH8.reset();
+        m_Geometry.reset();
+    }
+
+    void PathTracer::Render(const Resources::UniformBufferObject& camera, uint32_t width, uint32_t height, std::vector<float>& accumulation) const
+    {
+        if (accumulation.size() != static_cast<size_t>(width) * height * 4)
+        {
+            throw std::invalid_argument("Accumulation image does not match the render size.");
+        }
+
+        // Tiles keep the rays of a task close together, and are small enough for stealing to even out slow regions of the image.
+        const uint32_t tileCountX = (width + TileSize - 1) / TileSize;
+        const uint32_t tileCountY = (height + TileSize - 1) / TileSize;
+        const bool accumulate = camera.m_SampleCount != camera.m_TotalSamplesCount;
+
+        m_TaskPool->ForEach(tileCountX * tileCountY, [&](uint32_t tileIndex)
+        {
+            const uint32_t beginX = (tileIndex % tileCountX) * TileSize;
+            const uint32_t beginY = (tileIndex / tileCountX) * TileSize;
+            const uint32_t endX = std::min(beginX + TileSize, width);
+            const uint32_t endY = std::min(beginY + TileSize, height);
+
+            for (uint32_t blockY = beginY; blockY < endY; blockY += RayPacket::BlockWidth)
+            {
+                for (uint32_t blockX = beginX; blockX < endX; blockX += RayPacket::BlockWidth)
+                {
+                    glm::vec3 blockColors[RayPacket::Size];
+                    TraceBlock(camera, blockX, blockY, width, height, blockColors);
+
+                    for (uint32_t lane = 0; lane != RayPacket::Size; ++lane)
+                    {
+                        const uint32_t x = blockX + lane % RayPacket::BlockWidth;
+                        const uint32_t y = blockY + lane / RayPacket::BlockWidth;
+
+                        if (x >= endX || y >= endY)
+                        {
+                            continue;
+                        }
+
+                        const glm::vec3& pixelColor = blockColors[lane];
+                        float* const pixel = &accumulation[(static_cast<size_t>(y) * width + x) * 4];
+
+                        pixel[0] = (accumulate ? pixel[0] : 0.0f) + pixelColor.r;
+                        pixel[1] = (accumulate ? pixel[1] : 0.0f) + pixelColor.g;
+                        pixel[2] = (accumulate ? pixel[2] : 0.0f) + pixelColor.b;
+                        pixel[3] = 0.0f;
+                    }
+                }
+            }
+        });
+    }
+
+    void PathTracer::TraceBlock(const Resources::UniformBufferObject& camera, uint32_t blockX, uint32_t blockY, uint32_t width, uint32_t height, glm::vec3* colors) const
+    {
+        using namespace PathTracerUtilities;
+
+        // Initialise separate random seeds for the pixel and the rays, exactly like the ray generation shader.
+        // - pixel: we want the same random seed for each pixel to get a homogeneous anti-aliasing.
+        // - ray: we want a noisy random seed, different for each pixel.
+        uint32_t pixelRandomSeeds[RayPacket::Size];
+        uint32_t rayRandomSeeds[RayPacket::Size];
+        uint32_t activeMask = 0;
+
+        for (uint32_t lane = 0; lane != RayPacket::Size; ++lane)
+        {
+            const uint32_t x = blockX + lane % RayPacket::BlockWidth;
+            const uint32_t y = blockY + lane / RayPacket::BlockWidth;
+
+            colors[lane] = glm::vec3(0.0f);
+
+            if (x < width && y < height)
+            {
+                pixelRandomSeeds[lane] = camera.m_RandomSeed;
+                rayRandomSeeds[lane] = Random::InitRandomSeed(Random::InitRandomSeed(x, y), camera.m_TotalSamplesCount);
+                activeMask |= 1u << lane;
+            }
+        }
+
+        // Every pixel draws from its own seeds in the same order as on the GPU, regardless of how the rays of the block are interleaved.
+        for (uint32_t s = 0; s < camera.m_SampleCount; ++s)
+        {
+            RayPacket packet;
+
+            for (uint32_t mask = activeMask; mask != 0; mask &= mask - 1)
+            {
+                const uint32_t lane = FindFirstSetBit(mask);
+                packet.SetRay(lane, GenerateCameraRay(camera, blockX + lane % RayPacket::BlockWidth, blockY + lane / RayPacket::BlockWidth, width, height, pixelRandomSeeds[lane], rayRandomSeeds[lane]));
+            }
+
+            // The camera rays of a block are coherent enough to share a traversal.
+            if (m_PacketTraverser)
+            {
+                m_PacketTraverser->Intersect(packet, MinimumDistance, MaximumDistance);
+            }
+
+            for (uint32_t mask = activeMask; mask != 0; mask &= mask - 1)
+            {
+                const uint32_t lane = FindFirstSetBit(mask);
+                const Ray ray = packet.GetRay(lane);
+
+                Hit hit = {};
+                const bool isHit = m_PacketTraverser ? packet.IsHit(lane) : Intersect(ray, MinimumDistance, MaximumDistance, hit);
+
+                if (m_PacketTraverser)
+                {
+                    hit = packet.GetHit(lane);
+                }
+
+                colors[lane] += TracePath(camera, ray, isHit, hit, rayRandomSeeds[lane]);
+            }
+        }
+    }
+
+    glm::vec3 PathTracer::TracePath(const Resources::UniformBufferObject& camera, Ray ray, bool isHit, Hit hit, uint32_t& seed) const
+    {
+        glm::vec3 rayColor(1.0f);
+
+        // Ray scatters are handled in this loop, light emitting materials never scatter.
+        for (uint32_t b = 0; b <= camera.m_BounceCount; ++b)
+        {
+            // If we've exceeded the ray bounce limit without hitting a light source, no light is gathered.
+            if (b == camera.m_BounceCount)
+            {
+                rayColor = glm::vec3(0.0f);
+                break;
+            }
+
+            // The closest hit of the camera ray is passed in.
+            if (b != 0)
+            {
+                isHit = Intersect(ray, PathTracerUtilities::MinimumDistance, PathTracerUtilities::MaximumDistance, hit);
+            }
+
+            const RayPayload payload = Shade(camera, ray, isHit, hit, seed);
+            const float t = payload.m_ColorAndDistance.w;
+            const bool isScattered = payload.m_ScatterDirection.w > 0;
+
+            rayColor *= glm::vec3(payload.m_ColorAndDistance);
+
+            // Trace missed, or end of trace.
+            if (t < 0 || !isScattered)
+            {
+                break;
+            }
+
+            ray.m_Origin = ray.m_Origin + t * ray.m_Direction;
+            ray.m_Direction = glm::vec3(payload.m_ScatterDirection);
+        }
+
+        return rayColor;
+    }
+
+    Ray PathTracer::GenerateCameraRay(const Resources::UniformBufferObject& camera, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t& pixelRandomSeed, uint32_t& rayRandomSeed)
+    {
+        const float jitterX = Random::RandomFloat(pixelRandomSeed);
+        const float jitterY = Random::RandomFloat(pixelRandomSeed);
+        const glm::vec2 pixel(x + jitterX, y + jitterY);
+        const glm::vec2 uv = (pixel / glm::vec2(width, height)) * 2.0f - 1.0f;
+
+        const glm::vec2 offset = camera.m_Aperture / 2 * Random::RandomInUnitDisk(rayRandomSeed);
+        const glm::vec4 target = camera.m_ProjectionInverse * glm::vec4(uv.x, uv.y, 1, 1);
+
+        Ray ray = {};
+        ray.m_Origin = camera.m_ModelViewInverse * glm::vec4(offset, 0, 1);
+        ray.m_Direction = camera.m_ModelViewInverse * glm::vec4(glm::normalize(glm::vec3(target) * camera.m_FocusDistance - glm::vec3(offset, 0)), 0);
+
+        return ray;
+    }
+
+    bool PathTracer::Intersect(const Ray& ray, float tMin, float tMax, Hit& hit) const
+    {
+        return m_BVH8 ? m_BVH8->Intersect(ray, tMin, tMax, hit) : m_BVH4->Intersect(ray, tMin, tMax, hit);
+    }
+
+    PathTracer::RayPayload PathTracer::Shade(const Resources::UniformBufferObject& camera, const Ray& ray, bool isHit, const Hit& hit, uint32_t& seed) const
+    {
+        if (!isHit)
+        {
+            // Miss shader.
+            const float t = 0.5f * (glm::normalize(ray.m_Direction).y + 1);
+            const glm::vec3 skyColor = camera.m_HasSky ? glm::mix(glm::vec3(1.0f), glm::vec3(0.5f, 0.7f, 1.0f), t) : glm::vec3(0.0f);
+
+            return { glm::vec4(skyColor, -1), glm::vec4(0.0f) };
+        }
+
+        // Closest hit shaders.
+        const Surface surface = m_Geometry->GetSurface(ray, hit);
+        return Scatter(m_Geometry->GetMaterials()[surface.m_MaterialIndex], ray.m_Direction, surface, hit.m_Distance, seed);
+    }
+
+    PathTracer::RayPayload PathTracer::Scatter(const Resources::Material& material, const glm::vec3& direction, const Surface& surface, float t, uint32_t& seed) const
+    {
+        using MaterialType = Resources::Material::Material_Type;
+
+        const glm::vec3 normDirection = glm::normalize(direction);
+        const glm::vec3& normal = surface.m_Normal;
+        const glm::vec4 diffuse = material.m_Diffuse;
+
+        switch (material.m_MaterialType)
+        {
+            case MaterialType::Material_Type_Lambertian:
+            {
+                const bool isScattered = glm::dot(normDirection, normal) < 0;
+                const glm::vec4 texColor = SampleTexture(material.m_DiffuseTextureID, surface.m_TexCoord);
+                const glm::vec3 scatter = normal + Random::RandomInUnitSphere(seed);
+
+                return { glm::vec4(glm::vec3(diffuse) * glm::vec3(texColor), t), glm::vec4(scatter, isScattered ? 1 : 0) };
+            }
+
+            case MaterialType::Material_Type_Metallic:
+            {
+                const glm::vec3 reflected = glm::reflect(normDirection, normal);
+                const bool isScattered = glm::dot(reflected, normal) > 0;
+                const glm::vec4 texColor = SampleTexture(material.m_DiffuseTextureID, surface.m_TexCoord);
+                const glm::vec3 scatter = reflected + material.m_Fuzziness * Random::RandomInUnitSphere(seed);
+
+                return { glm::vec4(glm::vec3(diffuse) * glm::vec3(texColor), t), glm::vec4(scatter, isScattered ? 1 : 0) };
+            }
+
+            case MaterialType::Material_Type_Dieletric:
+            {
+                const float cosTheta = glm::dot(normDirection, normal);
+                const glm::vec3 outwardNormal = cosTheta > 0 ? -normal : normal;
+                const float niOverNt = cosTheta > 0 ? material.m_RefractionIndex : 1 / material.m_RefractionIndex;
+                const float cosine = cosTheta > 0 ? material.m_RefractionIndex * cosTheta : -cosTheta;
+
+                const glm::vec3 refracted = glm::refract(normDirection, outwardNormal, niOverNt);
+                const float reflectProbability = refracted != glm::vec3(0.0f) ? PathTracerUtilities::Schlick(cosine, material.m_RefractionIndex) : 1;
+                const glm::vec4 texColor = SampleTexture(material.m_DiffuseTextureID, surface.m_TexCoord);
+
+                return Random::RandomFloat(seed) < reflectProbability
+                    ? RayPayload{ glm::vec4(glm::vec3(texColor), t), glm::vec4(glm::reflect(normDirection, normal), 1) }
+                    : RayPayload{ glm::vec4(glm::vec3(texColor), t), glm::vec4(refracted, 1) };
+            }
+
+            case MaterialType::Material_Type_DiffuseLight:
+                return { glm::vec4(glm::vec3(diffuse), t), glm::vec4(1, 0, 0, 0) };
+
+            default:
+                // The shaders have no isotropic scattering either, and leave the payload undefined. Absorb the ray instead.
+                return { glm::vec4(0.0f, 0.0f, 0.0f, t), glm::vec4(0.0f) };
+        }
+    }
+
+    glm::vec4 PathTracer::SampleTexture(int32_t textureIndex, const glm::vec2& texCoord) const
+    {
+        if (textureIndex < 0)
+        {
+            return glm::vec4(1.0f);
+        }
+
+        // Bilinear filtering with clamp to edge addressing, the default sampler configuration of the scene textures.
+        const Resources::Texture& texture = m_Geometry->GetTextures()[textureIndex];
+        const int width = texture.GetWidth();
+        const int height = texture.GetHeight();
+        const unsigned char* const pixels = texture.GetPixels(); // Always loaded as RGBA.
+
+        const glm::vec2 position = texCoord * glm::vec2(width, height) - 0.5f;
+        const glm::vec2 base = glm::floor(position);
+        const glm::vec2 weight = position - base;
+
+        const int x0 = glm::clamp(static_cast<int>(base.x), 0, width - 1);
+        const int y0 = glm::clamp(static_cast<int>(base.y), 0, height - 1);
+        const int x1 = glm::clamp(static_cast<int>(base.x) + 1, 0, width - 1);
+        const int y1 = glm::clamp(static_cast<int>(base.y) + 1, 0, height - 1);
+
+        const auto texel = [&](int x, int y)
+        {
+            const unsigned char* const data = pixels + (static_cast<size_t>(y) * width + x) * 4;
+            return glm::vec4(data[0], data[1], data[2], data[3]) / 255.0f;
+        };
+
+        return glm::mix(glm::mix(texel(x0, y0), texel(x1, y0), weight.x), glm::mix(texel(x0, y1), texel(x1, y1), weight.x), weight.y);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+#include "SceneGeometry.h"
+#include <memory>
+#include <vector>
+
+namespace Parallel
+{
+    class TaskPool;
+}
+
+namespace Resources
+{
+    class UniformBufferObject;
+}
+
+namespace CPU
+{
+    class BVH;
+    class PacketTraverser;
+
+    template<uint32_t Width>
+    class WideBVH;
+
+    // Reference path tracer that runs entirely on the host. It follows RayTracing.rgen, the hit and miss shaders and Scatter.glsl step by step, and draws
+    // from the same random sequences, so for the same uniforms its images converge to the GPU ones. Tiles of the image are traced on a work-stealing pool.
+    class PathTracer final
+    {
+    public:
+        // The models and textures are referenced, not copied, and have to outlive the tracer.
+        PathTracer(const std::vector<Resources::Model>& models, const std::vector<Resources::Texture>& textures);
+        explicit PathTracer(const Resources::Scene& scene);
+        ~PathTracer();
+
+        // Traces camera.m_SampleCount samples for every pixel and adds them to the RGBA accumulation image, or replaces its content when they are the first samples.
+        // As on the GPU, the image holds the sum of all samples and has to be divided by camera.m_TotalSamplesCount.
+        void Render(const Resources::UniformBufferObject& camera, uint32_t width, uint32_t height, std::vector<float>& accumulation) const;
+
+        // The lens sample of RayTracing.rgen for the next sample of the pixel. Advances both random seeds.
+        static Ray GenerateCameraRay(const Resources::UniformBufferObject& camera, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t& pixelRandomSeed, uint32_t& rayRandomSeed);
+
+    private:
+        struct RayPayload
+        {
+            glm::vec4 m_ColorAndDistance;
+            glm::vec4 m_ScatterDirection; // xyz, w is 1 if the ray continues.
+        };
+
+        // Traces the pixels of a block of RayPacket::BlockWidth squared pixels, clipped to the image, and writes their colors in packet lane order.
+        void TraceBlock(const Resources::UniformBufferObject& camera, uint32_t blockX, uint32_t blockY, uint32_t width, uint32_t height, glm::vec3* colors) const;
+        glm::vec3 TracePath(const Resources::UniformBufferObject& camera, Ray ray, bool isHit, Hit hit, uint32_t& seed) const;
+        bool Intersect(const Ray& ray, float tMin, float tMax, Hit& hit) const;
+        RayPayload Shade(const Resources::UniformBufferObject& camera, const Ray& ray, bool isHit, const Hit& hit, uint32_t& seed) const; // The miss or closest hit shader.
+        RayPayload Scatter(const Resources::Material& material, const glm::vec3& direction, const Surface& surface, float t, uint32_t& seed) const;
+        glm::vec4 SampleTexture(int32_t textureIndex, const glm::vec2& texCoord) const;
+
+    private:
+        static const uint32_t TileSize = 16; // A multiple of RayPacket::BlockWidth.
+
+        std::unique_ptr<SceneGeometry> m_Geometry;
+        std::unique_ptr<BVH> m_BVH; // Only kept when camera rays are traced as packets.
+        std::unique_ptr<PacketTraverser> m_PacketTraverser;
+        std::unique_ptr<WideBVH<4>> m_BVH4; // Only one of the two is built, depending on the widest vector instructions of the processor.
+        std::unique_ptr<WideBVH<8>> m_BVH8;
+        std::unique_ptr<Parallel::TaskPool> m_TaskPool;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+#include "Math/Math.h"
+#include <cstdint>
+
+// Host versions of the generators in Random.glsl. They have to stay bit exact with the shaders, so that the CPU renderer draws the same sample sequences as the GPU.
+namespace CPU::Random
+{
+    // Tiny Encryption Algorithm, hashes two values into a seed.
+    inline uint32_t InitRandomSeed(uint32_t value0, uint32_t value1)
+    {
+        uint32_t v0 = value0, v1 = value1, s0 = 0;
+
+        for (uint32_t n = 0; n < 16; n++)
+        {
+            s0 += 0x9e3779b9;
+            v0 += ((v1 << 4) + 0xa341316c) ^ (v1 + s0) ^ ((v1 >> 5) + 0xc8013ea4);
+            v1 += ((v0 << 4) + 0xad90777d) ^ (v0 + s0) ^ ((v0 >> 5) + 0x7e95761e);
+        }
+
+        return v0;
+    }
+
+    // LCG values from Numerical Recipes.
+    inline uint32_t RandomInt(uint32_t& seed)
+    {
+        return (seed = 1664525 * seed + 1013904223);
+    }
+
+    inline float RandomFloat(uint32_t& seed)
+    {
+        return float(RandomInt(seed) & 0x00FFFFFF) / float(0x01000000);
+    }
+
+    // Components are drawn one after the other, GLSL evaluates constructor arguments in order while C++ does not.
+    inline glm::vec2 RandomInUnitDisk(uint32_t& seed)
+    {
+        for (;;)
+        {
+            const float x = RandomFloat(seed);
+            const float y = RandomFloat(seed);
+            const glm::vec2 p = 2.0f * glm::vec2(x, y) - 1.0f;
+
+            if (glm::dot(p, p) < 1)
+            {
+                return p;
+            }
+        }
+    }
+
+    inline glm::vec3 RandomInUnitSphere(uint32_t& seed)
+    {
+        for (;;)
+        {
+            const float x = RandomFloat(seed);
+            const float y = RandomFloat(seed);
+            const float z = RandomFloat(seed);
+            const glm::vec3 p = 2.0f * glm::vec3(x, y, z) - 1.0f;
+
+            if (glm::dot(p, p) < 1)
+            {
+                return p;
+            }
+        }
+    }
+}
\ No newline at end of file
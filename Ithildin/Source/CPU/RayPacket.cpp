@@ -0,0 +1,452 @@
+#include "RayPacket.h"
+#include "BVH.h"
+#include "Core/ProcessorFeatures.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if PROCESSOR_X86
+#include <immintrin.h>
+#endif
+
+namespace CPU
+{
+    namespace RayPacketUtilities
+    {
+        const uint32_t LaneCount = 8; // Per AVX register.
+        const uint32_t RegisterCount = RayPacket::Size / LaneCount;
+
+        struct StackEntry
+        {
+            uint32_t m_Node;
+            uint32_t m_Mask;   // Rays that entered the node's bounds.
+            float m_Distance;  // Nearest entry distance among them.
+        };
+
+#if PROCESSOR_X86
+        // Interval bounds of the packet's origins and inverse directions. Only valid if all directions lie in the same octant, the space is then mirrored
+        // along the negative axes so that the bounds hold for positive directions.
+        struct Frustum
+        {
+            bool m_IsValid = false;
+            bool m_IsNegative[3] = {};
+            glm::vec3 m_OriginMinimum = glm::vec3(std::numeric_limits<float>::max());
+            glm::vec3 m_OriginMaximum = glm::vec3(std::numeric_limits<float>::lowest());
+            glm::vec3 m_InverseDirectionMinimum = glm::vec3(std::numeric_limits<float>::max());
+            glm::vec3 m_InverseDirectionMaximum = glm::vec3(std::numeric_limits<float>::lowest());
+        };
+
+        TARGET_AVX2 inline Frustum CreateFrustum(const RayPacket& packet)
+        {
+            Frustum frustum;
+            bool isFirstRay = true;
+
+            for (uint32_t lane = 0; lane != RayPacket::Size; ++lane)
+            {
+                if ((packet.m_ActiveMask & (1u << lane)) == 0)
+                {
+                    continue;
+                }
+
+                const Ray ray = packet.GetRay(lane);
+                const glm::vec3 inverseDirection = 1.0f / ray.m_Direction;
+
+                for (int axis = 0; axis != 3; ++axis)
+                {
+                    const bool isNegative = std::signbit(inverseDirection[axis]);
+
+                    if (isFirstRay)
+                    {
+                        frustum.m_IsNegative[axis] = isNegative;
+                    }
+                    else if (frustum.m_IsNegative[axis] != isNegative)
+                    {
+                        return Frustum();
+                    }
+
+                    const float origin = isNegative ? -ray.m_Origin[axis] : ray.m_Origin[axis];
+                    const float inverse = std::abs(inverseDirection[axis]);
+
+                    frustum.m_OriginMinimum[axis] = std::min(frustum.m_OriginMinimum[axis], origin);
+                    frustum.m_OriginMaximum[axis] = std::max(frustum.m_OriginMaximum[axis], origin);
+                    frustum.m_InverseDirectionMinimum[axis] = std::min(frustum.m_InverseDirectionMinimum[axis], inverse);
+                    frustum.m_InverseDirectionMaximum[axis] = std::max(frustum.m_InverseDirectionMaximum[axis], inverse);
+                }
+
+                isFirstRay = false;
+            }
+
+            frustum.m_IsValid = !isFirstRay;
+            return frustum;
+        }
+
+        // Whether no ray of the packet can enter the bounds within [tMin, tMax]. Compares the latest possible entry against the earliest possible exit
+        // of any ray, so it never culls a node that one of the rays hits. Infinities and NaNs from axis aligned rays only ever weaken the test.
+        TARGET_AVX2 inline bool IsCulled(const Frustum& frustum, const BVH::Node& node, float tMin, float tMax)
+        {
+            float entry = tMin;
+            float exit = tMax;
+
+            for (int axis = 0; axis != 3; ++axis)
+            {
+                const bool isNegative = frustum.m_IsNegative[axis];
+                const float minimum = isNegative ? -node.m_BoundsMaximum[axis] : node.m_BoundsMinimum[axis];
+                const float maximum = isNegative ? -node.m_BoundsMinimum[axis] : node.m_BoundsMaximum[axis];
+
+                const float entryOffset = minimum - frustum.m_OriginMaximum[axis];
+                const float exitOffset = maximum - frustum.m_OriginMinimum[axis];
+
+                entry = std::max(entry, entryOffset * (entryOffset >= 0.0f ? frustum.m_InverseDirectionMinimum[axis] : frustum.m_InverseDirectionMaximum[axis]));
+                exit = std::min(exit, exitOffset * (exitOffset >= 0.0f ? frustum.m_InverseDirectionMaximum[axis] : frustum.m_InverseDirectionMinimum[axis]));
+            }
+
+            return entry > exit;
+        }
+
+        // Packet rays loaded into registers once per traversal.
+        struct Lanes
+        {
+            __m256 m_OriginX[RegisterCount], m_OriginY[RegisterCount], m_OriginZ[RegisterCount];
+            __m256 m_DirectionX[RegisterCount], m_DirectionY[RegisterCount], m_DirectionZ[RegisterCount];
+            __m256 m_InverseDirectionX[RegisterCount], m_InverseDirectionY[RegisterCount], m_InverseDirectionZ[RegisterCount];
+            __m256 m_TMin;
+        };
+
+        TARGET_AVX2 inline float HorizontalMinimum(__m256 values)
+        {
+            __m128 minimum = _mm_min_ps(_mm256_castps256_ps128(values), _mm256_extractf128_ps(values, 1));
+            minimum = _mm_min_ps(minimum, _mm_movehl_ps(minimum, minimum));
+            minimum = _mm_min_ss(minimum, _mm_shuffle_ps(minimum, minimum, 1));
+            return _mm_cvtss_f32(minimum);
+        }
+
+        TARGET_AVX2 inline float HorizontalMaximum(__m256 values)
+        {
+            __m128 maximum = _mm_max_ps(_mm256_castps256_ps128(values), _mm256_extractf128_ps(values, 1));
+            maximum = _mm_max_ps(maximum, _mm_movehl_ps(maximum, maximum));
+            maximum = _mm_max_ss(maximum, _mm_shuffle_ps(maximum, maximum, 1));
+            return _mm_cvtss_f32(maximum);
+        }
+
+        // Slab test of every ray against the bounds, clipped to its closest hit so far. Returns the mask of rays entering them, and the nearest entry.
+        TARGET_AVX2 inline uint32_t IntersectBounds(const BVH::Node& node, const Lanes& lanes, const RayPacket& packet, float& distance)
+        {
+            const __m256 minimumX = _mm256_set1_ps(node.m_BoundsMinimum.x);
+            const __m256 minimumY = _mm256_set1_ps(node.m_BoundsMinimum.y);
+            const __m256 minimumZ = _mm256_set1_ps(node.m_BoundsMinimum.z);
+            const __m256 maximumX = _mm256_set1_ps(node.m_BoundsMaximum.x);
+            const __m256 maximumY = _mm256_set1_ps(node.m_BoundsMaximum.y);
+            const __m256 maximumZ = _mm256_set1_ps(node.m_BoundsMaximum.z);
+
+            uint32_t mask = 0;
+            __m256 nearest = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+
+            for (uint32_t r = 0; r != RegisterCount; ++r)
+            {
+                const __m256 t0X = _mm256_mul_ps(_mm256_sub_ps(minimumX, lanes.m_OriginX[r]), lanes.m_InverseDirectionX[r]);
+                const __m256 t0Y = _mm256_mul_ps(_mm256_sub_ps(minimumY, lanes.m_OriginY[r]), lanes.m_InverseDirectionY[r]);
+                const __m256 t0Z = _mm256_mul_ps(_mm256_sub_ps(minimumZ, lanes.m_OriginZ[r]), lanes.m_InverseDirectionZ[r]);
+                const __m256 t1X = _mm256_mul_ps(_mm256_sub_ps(maximumX, lanes.m_OriginX[r]), lanes.m_InverseDirectionX[r]);
+                const __m256 t1Y = _mm256_mul_ps(_mm256_sub_ps(maximumY, lanes.m_OriginY[r]), lanes.m_InverseDirectionY[r]);
+                const __m256 t1Z = _mm256_mul_ps(_mm256_sub_ps(maximumZ, lanes.m_OriginZ[r]), lanes.m_InverseDirectionZ[r]);
+
+                const __m256 entry = _mm256_max_ps(_mm256_min_ps(t0X, t1X), _mm256_max_ps(_mm256_min_ps(t0Y, t1Y), _mm256_max_ps(_mm256_min_ps(t0Z, t1Z), lanes.m_TMin)));
+                const __m256 exit = _mm256_min_ps(_mm256_max_ps(t0X, t1X), _mm256_min_ps(_mm256_max_ps(t0Y, t1Y), _mm256_min_ps(_mm256_max_ps(t0Z, t1Z), _mm256_load_ps(packet.m_Distance + r * LaneCount))));
+                const __m256 isHit = _mm256_cmp_ps(entry, exit, _CMP_LE_OQ);
+
+                mask |= static_cast<uint32_t>(_mm256_movemask_ps(isHit)) << (r * LaneCount);
+                nearest = _mm256_min_ps(nearest, _mm256_blendv_ps(nearest, entry, isHit));
+            }
+
+            distance = HorizontalMinimum(nearest);
+            return mask;
+        }
+
+        // Culls the node for the whole packet before testing each ray. Everything called during the traversal is compiled for AVX2, mixing in legacy
+        // SSE code while the upper halves of the registers are in use would stall on every transition.
+        TARGET_AVX2 inline uint32_t IntersectNode(const BVH::Node& node, const Frustum& frustum, const Lanes& lanes, const RayPacket& packet, float tMin, float farthestDistance, float& distance)
+        {
+            if (frustum.m_IsValid && IsCulled(frustum, node, tMin, farthestDistance))
+            {
+                return 0;
+            }
+
+            return IntersectBounds(node, lanes, packet, distance);
+        }
+
+        TARGET_AVX2 inline float GetFarthestDistance(const RayPacket& packet)
+        {
+            __m256 farthest = _mm256_load_ps(packet.m_Distance);
+
+            for (uint32_t r = 1; r != RegisterCount; ++r)
+            {
+                farthest = _mm256_max_ps(farthest, _mm256_load_ps(packet.m_Distance + r * LaneCount));
+            }
+
+            return HorizontalMaximum(farthest);
+        }
+
+        // Moller-Trumbore for 8 rays at a time, with the same operations in the same order as SceneGeometry::Intersect() so the results match it exactly.
+        TARGET_AVX2 FORCE_INLINE void IntersectTriangle(const SceneGeometry::Triangle& triangle, uint32_t primitiveIndex, const Lanes& lanes, uint32_t mask, RayPacket& packet)
+        {
+            const __m256 vertex0X = _mm256_set1_ps(triangle.m_Vertex0.x);
+            const __m256 vertex0Y = _mm256_set1_ps(triangle.m_Vertex0.y);
+            const __m256 vertex0Z = _mm256_set1_ps(triangle.m_Vertex0.z);
+            const __m256 edge1X = _mm256_set1_ps(triangle.m_Edge1.x);
+            const __m256 edge1Y = _mm256_set1_ps(triangle.m_Edge1.y);
+            const __m256 edge1Z = _mm256_set1_ps(triangle.m_Edge1.z);
+            const __m256 edge2X = _mm256_set1_ps(triangle.m_Edge2.x);
+            const __m256 edge2Y = _mm256_set1_ps(triangle.m_Edge2.y);
+            const __m256 edge2Z = _mm256_set1_ps(triangle.m_Edge2.z);
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+
+            for (uint32_t r = 0; r != RegisterCount; ++r)
+            {
+                const uint32_t registerMask = (mask >> (r * LaneCount)) & 0xFF;
+
+                if (registerMask == 0)
+                {
+                    continue;
+                }
+
+                const __m256 isActive = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(registerMask)), laneBits), laneBits));
+                const __m256& directionX = lanes.m_DirectionX[r];
+                const __m256& directionY = lanes.m_DirectionY[r];
+                const __m256& directionZ = lanes.m_DirectionZ[r];
+
+                const __m256 pX = _mm256_sub_ps(_mm256_mul_ps(directionY, edge2Z), _mm256_mul_ps(edge2Y, directionZ));
+                const __m256 pY = _mm256_sub_ps(_mm256_mul_ps(directionZ, edge2X), _mm256_mul_ps(edge2Z, directionX));
+                const __m256 pZ = _mm256_sub_ps(_mm256_mul_ps(directionX, edge2Y), _mm256_mul_ps(edge2X, directionY));
+                const __m256 determinant = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(edge1X, pX), _mm256_mul_ps(edge1Y, pY)), _mm256_mul_ps(edge1Z, pZ));
+                const __m256 inverseDeterminant = _mm256_div_ps(one, determinant);
+
+                const __m256 sX = _mm256_sub_ps(lanes.m_OriginX[r], vertex0X);
+                const __m256 sY = _mm256_sub_ps(lanes.m_OriginY[r], vertex0Y);
+                const __m256 sZ = _mm256_sub_ps(lanes.m_OriginZ[r], vertex0Z);
+                const __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sX, pX), _mm256_mul_ps(sY, pY)), _mm256_mul_ps(sZ, pZ)), inverseDeterminant);
+
+                const __m256 qX = _mm256_sub_ps(_mm256_mul_ps(sY, edge1Z), _mm256_mul_ps(edge1Y, sZ));
+                const __m256 qY = _mm256_sub_ps(_mm256_mul_ps(sZ, edge1X), _mm256_mul_ps(edge1Z, sX));
+                const __m256 qZ = _mm256_sub_ps(_mm256_mul_ps(sX, edge1Y), _mm256_mul_ps(edge1X, sY));
+                const __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(directionX, qX), _mm256_mul_ps(directionY, qY)), _mm256_mul_ps(directionZ, qZ)), inverseDeterminant);
+                const __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(edge2X, qX), _mm256_mul_ps(edge2Y, qY)), _mm256_mul_ps(edge2Z, qZ)), inverseDeterminant);
+
+                float* const distance = packet.m_Distance + r * LaneCount;
+                const __m256 closestDistance = _mm256_load_ps(distance);
+
+                // Ordered comparisons with the bounds of Math::IntersectTriangle(), so a NaN fails them the same way.
+                __m256 isHit = _mm256_and_ps(isActive, _mm256_cmp_ps(determinant, zero, _CMP_NEQ_UQ));
+                isHit = _mm256_and_ps(isHit, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, one, _CMP_LE_OQ)));
+                isHit = _mm256_and_ps(isHit, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+                isHit = _mm256_and_ps(isHit, _mm256_and_ps(_mm256_cmp_ps(t, lanes.m_TMin, _CMP_GE_OQ), _mm256_cmp_ps(t, closestDistance, _CMP_LT_OQ)));
+
+                if (_mm256_movemask_ps(isHit) == 0)
+                {
+                    continue;
+                }
+
+                uint32_t* const primitive = packet.m_PrimitiveIndex + r * LaneCount;
+                float* const barycentricX = packet.m_BarycentricX + r * LaneCount;
+                float* const barycentricY = packet.m_BarycentricY + r * LaneCount;
+
+                _mm256_store_ps(distance, _mm256_blendv_ps(closestDistance, t, isHit));
+                _mm256_store_ps(barycentricX, _mm256_blendv_ps(_mm256_load_ps(barycentricX), u, isHit));
+                _mm256_store_ps(barycentricY, _mm256_blendv_ps(_mm256_load_ps(barycentricY), v, isHit));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(primitive), _mm256_castps_si256(_mm256_blendv_ps(
+                    _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<const __m256i*>(primitive))), _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(primitiveIndex))), isHit)));
+            }
+        }
+
+        TARGET_AVX2 void Traverse(const BVH& bvh, const SceneGeometry& geometry, RayPacket& packet, float tMin)
+        {
+            const std::vector<BVH::Node>& nodes = bvh.GetNodes();
+            const std::vector<uint32_t>& primitiveIndices = bvh.GetPrimitiveIndices();
+            const std::vector<SceneGeometry::Primitive>& primitives = geometry.GetPrimitives();
+            const std::vector<SceneGeometry::Triangle>& triangles = geometry.GetTriangles();
+
+            Lanes lanes;
+            lanes.m_TMin = _mm256_set1_ps(tMin);
+
+            for (uint32_t r = 0; r != RegisterCount; ++r)
+            {
+                lanes.m_OriginX[r] = _mm256_load_ps(packet.m_OriginX + r * LaneCount);
+                lanes.m_OriginY[r] = _mm256_load_ps(packet.m_OriginY + r * LaneCount);
+                lanes.m_OriginZ[r] = _mm256_load_ps(packet.m_OriginZ + r * LaneCount);
+                lanes.m_DirectionX[r] = _mm256_load_ps(packet.m_DirectionX + r * LaneCount);
+                lanes.m_DirectionY[r] = _mm256_load_ps(packet.m_DirectionY + r * LaneCount);
+                lanes.m_DirectionZ[r] = _mm256_load_ps(packet.m_DirectionZ + r * LaneCount);
+                lanes.m_InverseDirectionX[r] = _mm256_div_ps(_mm256_set1_ps(1.0f), lanes.m_DirectionX[r]);
+                lanes.m_InverseDirectionY[r] = _mm256_div_ps(_mm256_set1_ps(1.0f), lanes.m_DirectionY[r]);
+                lanes.m_InverseDirectionZ[r] = _mm256_div_ps(_mm256_set1_ps(1.0f), lanes.m_DirectionZ[r]);
+            }
+
+            const Frustum frustum = CreateFrustum(packet);
+            float farthestDistance = GetFarthestDistance(packet); // No ray can hit anything beyond this. Shrinks as closest hits are found.
+
+            StackEntry stack[BVH::MaxDepth];
+            uint32_t stackSize = 0;
+            StackEntry current = { 0, 0, 0.0f };
+
+            if ((current.m_Mask = IntersectNode(nodes[0], frustum, lanes, packet, tMin, farthestDistance, current.m_Distance)) == 0)
+            {
+                return;
+            }
+
+            for (;;)
+            {
+                const BVH::Node& node = nodes[current.m_Node];
+
+                if (node.IsLeaf())
+                {
+                    for (uint32_t i = node.m_Offset; i != node.m_Offset + node.m_PrimitiveCount; ++i)
+                    {
+                        const uint32_t primitiveIndex = primitiveIndices[i];
+                        const SceneGeometry::Primitive& primitive = primitives[primitiveIndex];
+
+                        if (primitive.m_Type == SceneGeometry::PrimitiveType::Triangle)
+                        {
+                            IntersectTriangle(triangles[primitive.m_DataIndex], primitiveIndex, lanes, current.m_Mask, packet);
+                            continue;
+                        }
+
+                        // Spheres are intersected one ray at a time, in their own object space.
+                        for (uint32_t mask = current.m_Mask; mask != 0; mask &= mask - 1)
+                        {
+                            const uint32_t lane = FindFirstSetBit(mask);
+                            Hit hit = packet.GetHit(lane);
+
+                            if (geometry.Intersect(primitiveIndex, packet.GetRay(lane), tMin, hit))
+                            {
+                                packet.m_Distance[lane] = hit.m_Distance;
+                                packet.m_PrimitiveIndex[lane] = hit.m_PrimitiveIndex;
+                                packet.m_BarycentricX[lane] = hit.m_Barycentrics.x;
+                                packet.m_BarycentricY[lane] = hit.m_Barycentrics.y;
+                            }
+                        }
+                    }
+
+                    farthestDistance = GetFarthestDistance(packet);
+                }
+                else
+                {
+                    StackEntry left = { node.m_Offset, 0, 0.0f };
+                    StackEntry right = { node.m_Offset + 1, 0, 0.0f };
+                    left.m_Mask = IntersectNode(nodes[left.m_Node], frustum, lanes, packet, tMin, farthestDistance, left.m_Distance);
+                    right.m_Mask = IntersectNode(nodes[right.m_Node], frustum, lanes, packet, tMin, farthestDistance, right.m_Distance);
+
+                    if (left.m_Mask != 0 && right.m_Mask != 0)
+                    {
+                        const bool isLeftNearer = left.m_Distance <= right.m_Distance;
+                        stack[stackSize++] = isLeftNearer ? right : left;
+                        current = isLeftNearer ? left : right;
+                        continue;
+                    }
+
+                    if (left.m_Mask != 0 || right.m_Mask != 0)
+                    {
+                        current = left.m_Mask != 0 ? left : right;
+                        continue;
+                    }
+                }
+
+                // Closer hits may have been found since a node was pushed, so its rays are tested again before it is visited.
+                for (;;)
+                {
+                    if (stackSize == 0)
+                    {
+                        return;
+                    }
+
+                    current = stack[--stackSize];
+
+                    if (current.m_Distance <= farthestDistance && (current.m_Mask = IntersectNode(nodes[current.m_Node], frustum, lanes, packet, tMin, farthestDistance, current.m_Distance)) != 0)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+#endif
+    }
+
+    void RayPacket::SetRay(uint32_t lane, const Ray& ray)
+    {
+        m_OriginX[lane] = ray.m_Origin.x;
+        m_OriginY[lane] = ray.m_Origin.y;
+        m_OriginZ[lane] = ray.m_Origin.z;
+        m_DirectionX[lane] = ray.m_Direction.x;
+        m_DirectionY[lane] = ray.m_Direction.y;
+        m_DirectionZ[lane] = ray.m_Direction.z;
+        m_ActiveMask |= 1u << lane;
+    }
+
+    Ray RayPacket::GetRay(uint32_t lane) const
+    {
+        return { glm::vec3(m_OriginX[lane], m_OriginY[lane], m_OriginZ[lane]), glm::vec3(m_DirectionX[lane], m_DirectionY[lane], m_DirectionZ[lane]) };
+    }
+
+    Hit RayPacket::GetHit(uint32_t lane) const
+    {
+        return { m_Distance[lane], m_PrimitiveIndex[lane], glm::vec2(m_BarycentricX[lane], m_BarycentricY[lane]) };
+    }
+
+    PacketTraverser::PacketTraverser(const BVH& bvh) : m_BVH(bvh), m_Geometry(bvh.GetGeometry())
+    {
+    }
+
+    bool PacketTraverser::IsSupported()
+    {
+        return PROCESSOR_X86 && ProcessorFeatures::Get().m_HasAVX2;
+    }
+
+    void PacketTraverser::Intersect(RayPacket& packet, float tMin, float tMax) const
+    {
+        // Lanes without a ray get a harmless one that can never hit, as their closest hit lies before tMin.
+        const uint32_t activeMask = packet.m_ActiveMask;
+
+        for (uint32_t lane = 0; lane != RayPacket::Size; ++lane)
+        {
+            const bool isActive = (activeMask & (1u << lane)) != 0;
+
+            if (!isActive)
+            {
+                packet.SetRay(lane, { glm::vec3(0.0f), glm::vec3(1.0f) });
+            }
+
+            packet.m_Distance[lane] = isActive ? tMax : -std::numeric_limits<float>::infinity();
+            packet.m_PrimitiveIndex[lane] = RayPacket::InvalidPrimitive;
+            packet.m_BarycentricX[lane] = 0.0f;
+            packet.m_BarycentricY[lane] = 0.0f;
+        }
+
+        packet.m_ActiveMask = activeMask;
+
+        if (m_BVH.GetNodes().empty() || packet.m_ActiveMask == 0)
+        {
+            return;
+        }
+
+#if PROCESSOR_X86
+        if (IsSupported())
+        {
+            RayPacketUtilities::Traverse(m_BVH, m_Geometry, packet, tMin);
+            return;
+        }
+#endif
+
+        for (uint32_t lane = 0; lane != RayPacket::Size; ++lane)
+        {
+            Hit hit = {};
+
+            if ((packet.m_ActiveMask & (1u << lane)) != 0 && m_BVH.Intersect(packet.GetRay(lane), tMin, tMax, hit))
+            {
+                packet.m_Distance[lane] = hit.m_Distance;
+                packet.m_PrimitiveIndex[lane] = hit.m_PrimitiveIndex;
+                packet.m_BarycentricX[lane] = hit.m_Barycentrics.x;
+                packet.m_BarycentricY[lane] = hit.m_Barycentrics.y;
+            }
+        }
+    }
+}
\ No newline at end of file
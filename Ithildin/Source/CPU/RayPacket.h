@@ -0,0 +1,55 @@
+#pragma once
+#include "SceneGeometry.h"
+#include <cstdint>
+
+namespace CPU
+{
+    class BVH;
+
+    // Rays traced together, stored as a structure of arrays so that 8 of them fill an AVX2 register. Lanes without a ray are left out of the active mask.
+    struct alignas(32) RayPacket
+    {
+        static const uint32_t Size = 16;
+        static const uint32_t BlockWidth = 4;  // Camera rays are packed in blocks of 4x4 pixels.
+        static const uint32_t InvalidPrimitive = ~0u;
+
+        float m_OriginX[Size];
+        float m_OriginY[Size];
+        float m_OriginZ[Size];
+        float m_DirectionX[Size];
+        float m_DirectionY[Size];
+        float m_DirectionZ[Size];
+
+        // Closest hits, InvalidPrimitive where a ray missed.
+        float m_Distance[Size];
+        uint32_t m_PrimitiveIndex[Size];
+        float m_BarycentricX[Size];
+        float m_BarycentricY[Size];
+
+        uint32_t m_ActiveMask = 0;
+
+        void SetRay(uint32_t lane, const Ray& ray);
+        Ray GetRay(uint32_t lane) const;
+
+        bool IsHit(uint32_t lane) const { return m_PrimitiveIndex[lane] != InvalidPrimitive; }
+        Hit GetHit(uint32_t lane) const;
+    };
+
+    // Traces packets of coherent rays through a binary BVH with AVX2. Every node is first tested against the interval bounds of the packet's frustum, which
+    // culls it for all rays at once, and only then against the individual rays. Leaf triangles are intersected with 8 rays per instruction.
+    class PacketTraverser final
+    {
+    public:
+        // The BVH is referenced and has to outlive the traverser.
+        explicit PacketTraverser(const BVH& bvh);
+
+        static bool IsSupported();
+
+        // Finds the closest hits of all active rays within [tMin, tMax).
+        void Intersect(RayPacket& packet, float tMin, float tMax) const;
+
+    private:
+        const BVH& m_BVH;
+        const SceneGeometry& m_Geometry;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "RayStream.h"
+#include <algorithm>
+#include <limits>
+
+namespace CPU
+{
+    namespace RayStreamUtilities
+    {
+        const uint32_t MortonBits = 9; // Per axis. Together with the octant, the key fits into 30 bits.
+
+        // Inserts two 0 bits before each of the lowest 10 bits.
+        uint32_t SpreadBits(uint32_t value)
+        {
+            value = (value | (value << 16)) & 0x030000FF;
+            value = (value | (value << 8)) & 0x0300F00F;
+            value = (value | (value << 4)) & 0x030C30C3;
+            value = (value | (value << 2)) & 0x09249249;
+            return value;
+        }
+
+        uint32_t GetOctant(const glm::vec3& direction)
+        {
+            return (direction.x < 0.0f ? 1u : 0u) | (direction.y < 0.0f ? 2u : 0u) | (direction.z < 0.0f ? 4u : 0u);
+        }
+    }
+
+    std::vector<uint32_t> RayStream::Sort(const std::vector<Ray>& rays)
+    {
+        using namespace RayStreamUtilities;
+
+        glm::vec3 minimum(std::numeric_limits<float>::max());
+        glm::vec3 maximum(std::numeric_limits<float>::lowest());
+
+        for (const Ray& ray : rays)
+        {
+            minimum = glm::min(minimum, ray.m_Origin);
+            maximum = glm::max(maximum, ray.m_Origin);
+        }
+
+        const glm::vec3 extent = maximum - minimum;
+        const float cellCount = static_cast<float>(1u << MortonBits);
+        const glm::vec3 scale(
+            extent.x > 0.0f ? cellCount / extent.x : 0.0f,
+            extent.y > 0.0f ? cellCount / extent.y : 0.0f,
+            extent.z > 0.0f ? cellCount / extent.z : 0.0f);
+
+        // The key goes into the upper half and the ray index into the lower one, so one sort of plain integers orders both.
+        std::vector<uint64_t> keys(rays.size());
+
+        for (size_t i = 0; i != rays.size(); ++i)
+        {
+            const glm::vec3 cell = glm::min((rays[i].m_Origin - minimum) * scale, glm::vec3(cellCount - 1.0f));
+            const uint32_t morton = SpreadBits(static_cast<uint32_t>(cell.x)) | (SpreadBits(static_cast<uint32_t>(cell.y)) << 1) | (SpreadBits(static_cast<uint32_t>(cell.z)) << 2);
+            const uint32_t key = (GetOctant(rays[i].m_Direction) << (3 * MortonBits)) | morton;
+
+            keys[i] = (static_cast<uint64_t>(key) << 32) | i;
+        }
+
+        std::sort(keys.begin(), keys.end());
+
+        std::vector<uint32_t> order(rays.size());
+
+        for (size_t i = 0; i != keys.size(); ++i)
+        {
+            order[i] = static_cast<uint32_t>(keys[i]);
+        }
+
+        return order;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+#include "SceneGeometry.h"
+#include <cstdint>
+#include <vector>
+
+namespace CPU
+{
+    // Reorders incoherent rays, such as the bounces of a path tracer, into a stream in which neighbouring rays are similar enough to be traced as packets.
+    // Rays are grouped by the octant of their direction first, so the rays of a packet cross the slabs of a box in the same order, then ordered along a
+    // Morton curve through the bounds of their origins.
+    class RayStream final
+    {
+    public:
+        // Returns the indices of the rays in stream order.
+        static std::vector<uint32_t> Sort(const std::vector<Ray>& rays);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "SceneGeometry.h"
+#include "Resources/Model.h"
+#include "Resources/Scene.h"
+#include "Resources/Sphere.h"
+#include "Core/Parallel.h"
+#include "Math/Intersection.h"
+#include <cmath>
+#include <limits>
+
+namespace CPU
+{
+    namespace SceneGeometryUtilities
+    {
+        // Same mapping as GetSphereTexCoord() in the procedural hit shader.
+        glm::vec2 GetSphereTexCoord(const glm::vec3& point)
+        {
+            const float phi = std::atan2(point.x, point.z);
+            const float theta = std::asin(point.y);
+            const float pi = 3.1415926535897932384626433832795f;
+
+            return glm::vec2((phi + pi) / (2 * pi), 1 - (theta + pi / 2) / pi);
+        }
+    }
+
+    SceneGeometry::SceneGeometry(const Resources::Scene& scene) : SceneGeometry(scene.GetModels(), scene.GetTextures())
+    {
+    }
+
+    SceneGeometry::SceneGeometry(const std::vector<Resources::Model>& models, const std::vector<Resources::Texture>& textures) : m_Models(models), m_Textures(textures)
+    {
+        // Materials and instances are laid out exactly like Resources::Scene does, so material indices mean the same on both sides.
+        size_t triangleCount = 0;
+
+        for (const Resources::Model& model : m_Models)
+        {
+            const uint32_t materialOffset = static_cast<uint32_t>(m_Materials.size());
+            m_Materials.insert(m_Materials.end(), model.GetMaterials().begin(), model.GetMaterials().end());
+
+            for (const Resources::ModelInstance& modelInstance : model.GetInstances())
+            {
+                Instance instance = {};
+                instance.m_ObjectToWorld = modelInstance.m_Transform;
+                instance.m_WorldToObject = glm::inverse(modelInstance.m_Transform);
+                instance.m_NormalTransform = glm::transpose(glm::mat3(instance.m_WorldToObject));
+                instance.m_ModelIndex = static_cast<uint32_t>(&model - m_Models.data());
+                instance.m_MaterialOffset = materialOffset;
+                instance.m_MaterialIndex = -1;
+
+                if (modelInstance.m_Material)
+                {
+                    instance.m_MaterialIndex = static_cast<int32_t>(m_Materials.size());
+                    m_Materials.push_back(*modelInstance.m_Material);
+                }
+
+                m_Instances.push_back(instance);
+                triangleCount += model.GetProcedural() ? 0 : model.GetNumberOfIndices() / 3;
+            }
+        }
+
+        // Flatten the instances into world space primitives.
+        m_Primitives.resize(triangleCount);
+        m_Triangles.resize(triangleCount);
+
+        uint32_t triangleOffset = 0;
+
+        for (uint32_t instanceIndex = 0; instanceIndex != m_Instances.size(); ++instanceIndex)
+        {
+            const Instance& instance = m_Instances[instanceIndex];
+            const Resources::Model& model = m_Models[instance.m_ModelIndex];
+            const Resources::Sphere* const sphere = dynamic_cast<const Resources::Sphere*>(model.GetProcedural());
+
+            if (sphere != nullptr)
+            {
+                m_Primitives.push_back({ PrimitiveType::Sphere, instanceIndex, 0, static_cast<uint32_t>(m_Spheres.size()) });
+                m_Spheres.push_back({ sphere->m_Center, sphere->m_Radius });
+                continue;
+            }
+
+            // Instanced meshes can add up to millions of triangles, so they are transformed on all cores.
+            const std::vector<Resources::Vertex>& vertices = model.GetVertices();
+            const std::vector<uint32_t>& indices = model.GetIndices();
+            const uint32_t modelTriangleCount = model.GetNumberOfIndices() / 3;
+
+            Parallel::ForEachRange(modelTriangleCount, 16 * 1024, [&](size_t begin, size_t end, uint32_t)
+            {
+                for (size_t i = begin; i != end; ++i)
+                {
+                    const glm::vec3 p0 = instance.m_ObjectToWorld * glm::vec4(vertices[indices[i * 3 + 0]].m_Position, 1.0f);
+                    const glm::vec3 p1 = instance.m_ObjectToWorld * glm::vec4(vertices[indices[i * 3 + 1]].m_Position, 1.0f);
+                    const glm::vec3 p2 = instance.m_ObjectToWorld * glm::vec4(vertices[indices[i * 3 + 2]].m_Position, 1.0f);
+
+                    m_Triangles[triangleOffset + i] = { p0, p1 - p0, p2 - p0 };
+                    m_Primitives[triangleOffset + i] = { PrimitiveType::Triangle, instanceIndex, static_cast<uint32_t>(i), static_cast<uint32_t>(triangleOffset + i) };
+                }
+            });
+
+            triangleOffset += modelTriangleCount;
+        }
+    }
+
+    std::pair<glm::vec3, glm::vec3> SceneGeometry::GetBoundingBox(uint32_t primitiveIndex) const
+    {
+        const Primitive& primitive = m_Primitives[primitiveIndex];
+
+        if (primitive.m_Type == PrimitiveType::Triangle)
+        {
+            const Triangle& triangle = m_Triangles[primitive.m_DataIndex];
+            const glm::vec3 p1 = triangle.m_Vertex0 + triangle.m_Edge1;
+            const glm::vec3 p2 = triangle.m_Vertex0 + triangle.m_Edge2;
+
+            return std::make_pair(glm::min(triangle.m_Vertex0, glm::min(p1, p2)), glm::max(triangle.m_Vertex0, glm::max(p1, p2)));
+        }
+
+        // Bound the transformed object space box of the sphere.
+        const Sphere& sphere = m_Spheres[primitive.m_DataIndex];
+        const glm::mat4& transform = m_Instances[primitive.m_InstanceIndex].m_ObjectToWorld;
+
+        glm::vec3 minimum(std::numeric_limits<float>::max());
+        glm::vec3 maximum(std::numeric_limits<float>::lowest());
+
+        for (uint32_t corner = 0; corner != 8; ++corner)
+        {
+            const glm::vec3 offset((corner & 1) ? sphere.m_Radius : -sphere.m_Radius, (corner & 2) ? sphere.m_Radius : -sphere.m_Radius, (corner & 4) ? sphere.m_Radius : -sphere.m_Radius);
+            const glm::vec3 point = transform * glm::vec4(sphere.m_Center + offset, 1.0f);
+
+            minimum = glm::min(minimum, point);
+            maximum = glm::max(maximum, point);
+        }
+
+        return std::make_pair(minimum, maximum);
+    }
+
+    bool SceneGeometry::Intersect(uint32_t primitiveIndex, const Ray& ray, float tMin, Hit& hit) const
+    {
+        const Primitive& primitive = m_Primitives[primitiveIndex];
+
+        if (primitive.m_Type == PrimitiveType::Triangle)
+        {
+            // Without backface culling as the triangle geometry is opaque from both sides.
+            const Triangle& triangle = m_Triangles[primitive.m_DataIndex];
+
+            if (!Math::IntersectTriangle(ray.m_Origin, ray.m_Direction, triangle.m_Vertex0, triangle.m_Edge1, triangle.m_Edge2, tMin, hit.m_Distance, hit.m_Distance, hit.m_Barycentrics))
+            {
+                return false;
+            }
+
+            hit.m_PrimitiveIndex = primitiveIndex;
+            return true;
+        }
+
+        // Same quadratic as the procedural intersection shader, in object space. The distance is the same in both spaces as the direction is not renormalized.
+        const Sphere& sphere = m_Spheres[primitive.m_DataIndex];
+        const glm::mat4& worldToObject = m_Instances[primitive.m_InstanceIndex].m_WorldToObject;
+        const glm::vec3 origin = worldToObject * glm::vec4(ray.m_Origin, 1.0f);
+        const glm::vec3 direction = glm::mat3(worldToObject) * ray.m_Direction;
+
+        float distance;
+
+        if (!Math::IntersectSphere(origin, direction, sphere.m_Center, sphere.m_Radius, tMin, hit.m_Distance, distance))
+        {
+            return false;
+        }
+
+        hit = { distance, primitiveIndex, glm::vec2(0.0f) };
+        return true;
+    }
+
+    Surface SceneGeometry::GetSurface(const Ray& ray, const Hit& hit) const
+    {
+        const Primitive& primitive = m_Primitives[hit.m_PrimitiveIndex];
+        const Instance& instance = m_Instances[primitive.m_InstanceIndex];
+        const Resources::Model& model = m_Models[instance.m_ModelIndex];
+        const std::vector<Resources::Vertex>& vertices = model.GetVertices();
+        const std::vector<uint32_t>& indices = model.GetIndices();
+
+        Surface surface = {};
+
+        if (primitive.m_Type == PrimitiveType::Triangle)
+        {
+            const Resources::Vertex& v0 = vertices[indices[primitive.m_TriangleIndex * 3 + 0]];
+            const Resources::Vertex& v1 = vertices[indices[primitive.m_TriangleIndex * 3 + 1]];
+            const Resources::Vertex& v2 = vertices[indices[primitive.m_TriangleIndex * 3 + 2]];
+            const glm::vec3 barycentrics(1.0f - hit.m_Barycentrics.x - hit.m_Barycentrics.y, hit.m_Barycentrics.x, hit.m_Barycentrics.y);
+
+            const glm::vec3 objectNormal = v0.m_Normal * barycentrics.x + v1.m_Normal * barycentrics.y + v2.m_Normal * barycentrics.z;
+            surface.m_Normal = glm::normalize(instance.m_NormalTransform * objectNormal);
+            surface.m_TexCoord = v0.m_TexCoords * barycentrics.x + v1.m_TexCoords * barycentrics.y + v2.m_TexCoords * barycentrics.z;
+            surface.m_MaterialIndex = instance.m_MaterialIndex >= 0 ? static_cast<uint32_t>(instance.m_MaterialIndex) : v0.m_MaterialIndex + instance.m_MaterialOffset;
+
+            return surface;
+        }
+
+        const Sphere& sphere = m_Spheres[primitive.m_DataIndex];
+        const glm::vec3 origin = instance.m_WorldToObject * glm::vec4(ray.m_Origin, 1.0f);
+        const glm::vec3 direction = glm::mat3(instance.m_WorldToObject) * ray.m_Direction;
+        const glm::vec3 objectNormal = (origin + hit.m_Distance * direction - sphere.m_Center) / sphere.m_Radius;
+
+        surface.m_Normal = glm::normalize(instance.m_NormalTransform * objectNormal);
+        surface.m_TexCoord = SceneGeometryUtilities::GetSphereTexCoord(objectNormal);
+        surface.m_MaterialIndex = instance.m_MaterialIndex >= 0 ? static_cast<uint32_t>(instance.m_MaterialIndex) : vertices[indices[0]].m_MaterialIndex + instance.m_MaterialOffset;
+
+        return surface;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+#include "Resources/Material.h"
+#include "Math/Math.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Resources
+{
+    class Model;
+    class Scene;
+    class Texture;
+}
+
+namespace CPU
+{
+    struct Ray
+    {
+        glm::vec3 m_Origin;
+        glm::vec3 m_Direction; // Not normalized. Distances are measured in multiples of its length, like traceRayEXT() does.
+    };
+
+    struct Hit
+    {
+        float m_Distance;
+        uint32_t m_PrimitiveIndex;
+        glm::vec2 m_Barycentrics; // Weights of the second and third triangle vertices, the hit attributes of the triangle hit shader.
+    };
+
+    // Shading inputs of a hit, as computed by the closest hit shaders.
+    struct Surface
+    {
+        glm::vec3 m_Normal; // World space, normalized.
+        glm::vec2 m_TexCoord;
+        uint32_t m_MaterialIndex;
+    };
+
+    // World space copy of a scene's geometry for tracing on the host. Every model instance is flattened into its own triangles, while procedural spheres keep
+    // their instance transform and are intersected in object space like the intersection shader does. Dynamic instances are captured at their initial placement.
+    class SceneGeometry final
+    {
+    public:
+        enum class PrimitiveType : uint32_t
+        {
+            Triangle,
+            Sphere
+        };
+
+        struct Primitive
+        {
+            PrimitiveType m_Type;
+            uint32_t m_InstanceIndex;
+            uint32_t m_TriangleIndex; // Index of the triangle within its model, unused for spheres.
+            uint32_t m_DataIndex;     // Into the triangle or the sphere array.
+        };
+
+        // Precomputed for Moller-Trumbore.
+        struct Triangle
+        {
+            glm::vec3 m_Vertex0;
+            glm::vec3 m_Edge1;
+            glm::vec3 m_Edge2;
+        };
+
+        struct Sphere
+        {
+            glm::vec3 m_Center; // Object space.
+            float m_Radius;
+        };
+
+        struct Instance
+        {
+            glm::mat4 m_ObjectToWorld;
+            glm::mat4 m_WorldToObject;
+            glm::mat3 m_NormalTransform; // Inverse transpose of the object to world transform.
+            uint32_t m_ModelIndex;
+            uint32_t m_MaterialOffset;   // Of the model's materials in the scene material array.
+            int32_t m_MaterialIndex;     // Overrides the vertex materials when not negative.
+        };
+
+        // The models and textures are referenced, not copied, and have to outlive the geometry.
+        SceneGeometry(const std::vector<Resources::Model>& models, const std::vector<Resources::Texture>& textures);
+        explicit SceneGeometry(const Resources::Scene& scene);
+
+        const std::vector<Resources::Model>& GetModels() const { return m_Models; }
+        const std::vector<Resources::Texture>& GetTextures() const { return m_Textures; }
+        const std::vector<Resources::Material>& GetMaterials() const { return m_Materials; } // Laid out like the scene's material buffer.
+        const std::vector<Instance>& GetInstances() const { return m_Instances; }
+        const std::vector<Primitive>& GetPrimitives() const { return m_Primitives; }
+        const std::vector<Triangle>& GetTriangles() const { return m_Triangles; }
+        uint32_t GetNumberOfPrimitives() const { return static_cast<uint32_t>(m_Primitives.size()); }
+
+        std::pair<glm::vec3, glm::vec3> GetBoundingBox(uint32_t primitiveIndex) const;
+
+        // Replaces the hit if the primitive is intersected within [tMin, hit.m_Distance).
+        bool Intersect(uint32_t primitiveIndex, const Ray& ray, float tMin, Hit& hit) const;
+
+        Surface GetSurface(const Ray& ray, const Hit& hit) const;
+
+    private:
+        const std::vector<Resources::Model>& m_Models;
+        const std::vector<Resources::Texture>& m_Textures;
+
+        std::vector<Resources::Material> m_Materials;
+        std::vector<Instance> m_Instances;
+        std::vector<Primitive> m_Primitives;
+        std::vector<Triangle> m_Triangles;
+        std::vector<Sphere> m_Spheres;
+    };
+}
\ No newline at end of file
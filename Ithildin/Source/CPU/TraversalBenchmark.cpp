@@ -0,0 +1,249 @@
+#include "TraversalBenchmark.h"
+#include "PathTracer.h"
+#include "Random.h"
+#include "RayPacket.h"
+#include "RayStream.h"
+#include "WideBVH.h"
+#include "Core/TaskPool.h"
+#include "Resources/Model.h"
+#include "Resources/Texture.h"
+#include "Resources/UniformBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <numeric>
+
+namespace CPU
+{
+    namespace TraversalBenchmarkUtilities
+    {
+        const uint32_t Repetitions = 3;
+        const uint32_t ChunkSize = 4096; // Rays per task.
+        const uint32_t InvalidRay = ~0u;
+
+        // The distances the path tracer traces with.
+        const float MinimumDistance = 0.001f;
+        const float MaximumDistance = 10000.0f;
+
+        struct Trace
+        {
+            std::vector<Hit> m_Hits;
+            std::vector<uint8_t> m_IsHit;
+        };
+
+        // Returns the fastest of the repetitions in seconds.
+        template<typename TFunction>
+        double Measure(const TFunction& function)
+        {
+            double bestTime = std::numeric_limits<double>::max();
+
+            for (uint32_t repetition = 0; repetition != Repetitions; ++repetition)
+            {
+                const std::chrono::high_resolution_clock::time_point timer = std::chrono::high_resolution_clock::now();
+                function();
+                bestTime = std::min(bestTime, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - timer).count());
+            }
+
+            return bestTime;
+        }
+
+        // Traces the rays one at a time, spread across the pool.
+        template<typename THierarchy>
+        void TraceRays(Parallel::TaskPool& taskPool, const THierarchy& hierarchy, const std::vector<Ray>& rays, Trace& trace)
+        {
+            const uint32_t rayCount = static_cast<uint32_t>(rays.size());
+            const uint32_t chunkCount = (rayCount + ChunkSize - 1) / ChunkSize;
+
+            trace.m_Hits.resize(rays.size());
+            trace.m_IsHit.resize(rays.size());
+
+            taskPool.ForEach(chunkCount, [&](uint32_t chunk)
+            {
+                const uint32_t end = std::min(rayCount, (chunk + 1) * ChunkSize);
+
+                for (uint32_t i = chunk * ChunkSize; i != end; ++i)
+                {
+                    trace.m_IsHit[i] = hierarchy.Intersect(rays[i], MinimumDistance, MaximumDistance, trace.m_Hits[i]) ? 1 : 0;
+                }
+            });
+        }
+
+        // Traces the rays as packets of RayPacket::Size consecutive entries of the order. Entries of InvalidRay leave their lane empty.
+        void TracePackets(Parallel::TaskPool& taskPool, const PacketTraverser& traverser, const std::vector<Ray>& rays, const std::vector<uint32_t>& order, Trace& trace)
+        {
+            const uint32_t packetCount = static_cast<uint32_t>((order.size() + RayPacket::Size - 1) / RayPacket::Size);
+            const uint32_t packetsPerChunk = ChunkSize / RayPacket::Size;
+            const uint32_t chunkCount = (packetCount + packetsPerChunk - 1) / packetsPerChunk;
+
+            trace.m_Hits.resize(rays.size());
+            trace.m_IsHit.resize(rays.size());
+
+            taskPool.ForEach(chunkCount, [&](uint32_t chunk)
+            {
+                const uint32_t end = std::min(packetCount, (chunk + 1) * packetsPerChunk);
+
+                for (uint32_t packetIndex = chunk * packetsPerChunk; packetIndex != end; ++packetIndex)
+                {
+                    const size_t begin = static_cast<size_t>(packetIndex) * RayPacket::Size;
+                    const uint32_t laneCount = static_cast<uint32_t>(std::min<size_t>(RayPacket::Size, order.size() - begin));
+                    RayPacket packet;
+
+                    for (uint32_t lane = 0; lane != laneCount; ++lane)
+                    {
+                        if (order[begin + lane] != InvalidRay)
+                        {
+                            packet.SetRay(lane, rays[order[begin + lane]]);
+                        }
+                    }
+
+                    traverser.Intersect(packet, MinimumDistance, MaximumDistance);
+
+                    for (uint32_t lane = 0; lane != laneCount; ++lane)
+                    {
+                        const uint32_t rayIndex = order[begin + lane];
+
+                        if (rayIndex != InvalidRay)
+                        {
+                            trace.m_Hits[rayIndex] = packet.GetHit(lane);
+                            trace.m_IsHit[rayIndex] = packet.IsHit(lane) ? 1 : 0;
+                        }
+                    }
+                }
+            });
+        }
+
+        // Primitives with equally distant hits may be reported in any order, so only the distances are compared.
+        uint64_t CountMismatches(const Trace& trace, const Trace& reference)
+        {
+            uint64_t mismatchCount = 0;
+
+            for (size_t i = 0; i != trace.m_Hits.size(); ++i)
+            {
+                if (trace.m_IsHit[i] != reference.m_IsHit[i] || (trace.m_IsHit[i] && trace.m_Hits[i].m_Distance != reference.m_Hits[i].m_Distance))
+                {
+                    mismatchCount++;
+                }
+            }
+
+            return mismatchCount;
+        }
+    }
+
+    std::vector<TraversalBenchmark::Result> TraversalBenchmark::Run(const std::vector<Resources::Model>& models, const std::vector<Resources::Texture>& textures, const Resources::UniformBufferObject& camera, uint32_t width, uint32_t height)
+    {
+        using namespace TraversalBenchmarkUtilities;
+
+        Parallel::TaskPool taskPool;
+        const SceneGeometry geometry(models, textures);
+        const BVH bvh(geometry, taskPool);
+        const BVH4 bvh4(bvh);
+        const BVH8 bvh8(bvh);
+        const PacketTraverser packetTraverser(bvh);
+        const std::string packetInstructions = PacketTraverser::IsSupported() ? " (AVX2)" : " (scalar)";
+
+        std::vector<Result> results;
+
+        const auto addResult = [&](const std::string& hierarchy, const std::string& rayType, size_t rayCount, double time, uint64_t mismatchCount)
+        {
+            Result result = {};
+            result.m_Hierarchy = hierarchy;
+            result.m_RayType = rayType;
+            result.m_RayCount = rayCount;
+            result.m_Time = time;
+            result.m_RayRate = rayCount / (time * 1000000);
+            result.m_MismatchCount = mismatchCount;
+            results.push_back(result);
+        };
+
+        // Traces one batch of rays through every hierarchy, one ray at a time. The binary BVH goes first and provides the reference hits.
+        const auto measureRays = [&](const std::string& rayType, const std::vector<Ray>& rays, Trace& reference)
+        {
+            addResult("BVH2 (scalar)", rayType, rays.size(), Measure([&]() { TraceRays(taskPool, bvh, rays, reference); }), 0);
+
+            Trace trace;
+            const double bvh4Time = Measure([&]() { TraceRays(taskPool, bvh4, rays, trace); });
+            addResult(bvh4.IsVectorized() ? "BVH4 (SSE)" : "BVH4 (scalar)", rayType, rays.size(), bvh4Time, CountMismatches(trace, reference));
+
+            const double bvh8Time = Measure([&]() { TraceRays(taskPool, bvh8, rays, trace); });
+            addResult(bvh8.IsVectorized() ? "BVH8 (AVX2)" : "BVH8 (scalar)", rayType, rays.size(), bvh8Time, CountMismatches(trace, reference));
+        };
+
+        // Camera rays with the same lens and pixel jitter as the first sample of a render.
+        std::vector<Ray> primaryRays(static_cast<size_t>(width) * height);
+
+        taskPool.ForEach(height, [&](uint32_t y)
+        {
+            for (uint32_t x = 0; x != width; ++x)
+            {
+                uint32_t pixelRandomSeed = camera.m_RandomSeed;
+                uint32_t rayRandomSeed = Random::InitRandomSeed(Random::InitRandomSeed(x, y), camera.m_TotalSamplesCount);
+
+                primaryRays[static_cast<size_t>(y) * width + x] = PathTracer::GenerateCameraRay(camera, x, y, width, height, pixelRandomSeed, rayRandomSeed);
+            }
+        });
+
+        Trace primaryTrace;
+        measureRays("Primary", primaryRays, primaryTrace);
+
+        // The same rays in packets of 4x4 pixels. Lanes outside the image stay empty.
+        {
+            const uint32_t blockCountX = (width + RayPacket::BlockWidth - 1) / RayPacket::BlockWidth;
+            const uint32_t blockCountY = (height + RayPacket::BlockWidth - 1) / RayPacket::BlockWidth;
+            std::vector<uint32_t> blockOrder(static_cast<size_t>(blockCountX) * blockCountY * RayPacket::Size, InvalidRay);
+
+            for (size_t i = 0; i != blockOrder.size(); ++i)
+            {
+                const uint32_t block = static_cast<uint32_t>(i / RayPacket::Size);
+                const uint32_t lane = static_cast<uint32_t>(i % RayPacket::Size);
+                const uint32_t x = (block % blockCountX) * RayPacket::BlockWidth + lane % RayPacket::BlockWidth;
+                const uint32_t y = (block / blockCountX) * RayPacket::BlockWidth + lane / RayPacket::BlockWidth;
+
+                if (x < width && y < height)
+                {
+                    blockOrder[i] = y * width + x;
+                }
+            }
+
+            Trace trace;
+            const double time = Measure([&]() { TracePackets(taskPool, packetTraverser, primaryRays, blockOrder, trace); });
+            addResult("BVH2 packets" + packetInstructions, "Primary", primaryRays.size(), time, CountMismatches(trace, primaryTrace));
+        }
+
+        // Lambertian bounces off the primary hits. They start all over the scene and point everywhere, which makes them much less coherent.
+        std::vector<Ray> secondaryRays;
+        secondaryRays.reserve(primaryRays.size());
+
+        for (size_t i = 0; i != primaryRays.size(); ++i)
+        {
+            if (primaryTrace.m_IsHit[i])
+            {
+                const Ray& ray = primaryRays[i];
+                const Hit& hit = primaryTrace.m_Hits[i];
+                uint32_t seed = Random::InitRandomSeed(static_cast<uint32_t>(i), camera.m_RandomSeed);
+
+                Ray secondaryRay = {};
+                secondaryRay.m_Origin = ray.m_Origin + hit.m_Distance * ray.m_Direction;
+                secondaryRay.m_Direction = geometry.GetSurface(ray, hit).m_Normal + Random::RandomInUnitSphere(seed);
+                secondaryRays.push_back(secondaryRay);
+            }
+        }
+
+        Trace secondaryTrace;
+        measureRays("Secondary", secondaryRays, secondaryTrace);
+
+        // Packets of consecutive secondary rays show what incoherence costs, sorting them into a stream first what can be won back. The sort is timed too.
+        {
+            std::vector<uint32_t> order(secondaryRays.size());
+            std::iota(order.begin(), order.end(), 0u);
+
+            Trace trace;
+            const double time = Measure([&]() { TracePackets(taskPool, packetTraverser, secondaryRays, order, trace); });
+            addResult("BVH2 packets" + packetInstructions, "Secondary", secondaryRays.size(), time, CountMismatches(trace, secondaryTrace));
+
+            const double sortedTime = Measure([&]() { TracePackets(taskPool, packetTraverser, secondaryRays, RayStream::Sort(secondaryRays), trace); });
+            addResult("BVH2 sorted stream" + packetInstructions, "Secondary", secondaryRays.size(), sortedTime, CountMismatches(trace, secondaryTrace));
+        }
+
+        return results;
+    }
+}
\ No newline at end of file
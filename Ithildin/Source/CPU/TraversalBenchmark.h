@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Resources
+{
+    class Model;
+    class Texture;
+    class UniformBufferObject;
+}
+
+namespace CPU
+{
+    // Measures how many closest hit queries per second the CPU hierarchies answer: the binary BVH with scalar traversal, its 4 and 8 wide collapses with SSE
+    // and AVX2 traversal, and the binary BVH traced with packets of rays, unsorted or sorted into a stream. All of them trace the same camera rays and diffusely
+    // scattered secondary rays, and their hits are checked against the scalar binary BVH.
+    class TraversalBenchmark final
+    {
+    public:
+        struct Result
+        {
+            std::string m_Hierarchy;       // And the way it is traced, including the instruction set. For example "BVH8 (AVX2)" or "BVH2 packets (AVX2)".
+            std::string m_RayType;         // "Primary" or "Secondary".
+            uint64_t m_RayCount = 0;
+            double m_Time = 0.0;           // Seconds, the best of several repetitions.
+            double m_RayRate = 0.0;        // Millions of rays per second.
+            uint64_t m_MismatchCount = 0;  // Rays whose closest hit differs from the binary BVH's.
+        };
+
+        // One primary ray per pixel, and one secondary ray for each of them that hits the scene.
+        static std::vector<Result> Run(const std::vector<Resources::Model>& models, const std::vector<Resources::Texture>& textures, const Resources::UniformBufferObject& camera, uint32_t width, uint32_t height);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,358 @@
+#include "WideBVH.h"
+#include "Core/ProcessorFeatures.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#if PROCESSOR_X86
+#include <immintrin.h>
+#endif
+
+namespace CPU
+{
+    namespace WideBVHUtilities
+    {
+        // Inner nodes get at most Width - 1 siblings pushed per level, and the collapsed tree is never deeper than the binary one.
+        template<uint32_t Width>
+        constexpr uint32_t StackSize = BVH::MaxDepth * (Width - 1);
+
+        struct StackEntry
+        {
+            uint32_t m_Child;
+            uint32_t m_PrimitiveCount; // 0 for inner nodes.
+            float m_Distance;          // Where the ray enters the child's bounds.
+        };
+
+        float GetSurfaceArea(const BVH::Node& node)
+        {
+            const glm::vec3 extent = node.m_BoundsMaximum - node.m_BoundsMinimum;
+            return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+        }
+
+        // Slab test against all children, one lane at a time. Returns the mask of children entered within [tMin, tMax) and writes their entry distances.
+        template<uint32_t Width>
+        struct IntersectChildrenScalar
+        {
+            glm::vec3 m_Origin;
+            glm::vec3 m_InverseDirection;
+
+            uint32_t operator()(const typename WideBVH<Width>::Node& node, float tMin, float tMax, float* distances) const
+            {
+                uint32_t mask = 0;
+
+                for (uint32_t i = 0; i != Width; ++i)
+                {
+                    const glm::vec3 t0 = (glm::vec3(node.m_BoundsMinimumX[i], node.m_BoundsMinimumY[i], node.m_BoundsMinimumZ[i]) - m_Origin) * m_InverseDirection;
+                    const glm::vec3 t1 = (glm::vec3(node.m_BoundsMaximumX[i], node.m_BoundsMaximumY[i], node.m_BoundsMaximumZ[i]) - m_Origin) * m_InverseDirection;
+                    const glm::vec3 tNear = glm::min(t0, t1);
+                    const glm::vec3 tFar = glm::max(t0, t1);
+
+                    distances[i] = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, tMin));
+                    const float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+
+                    mask |= (distances[i] <= exit ? 1u : 0u) << i;
+                }
+
+                return mask;
+            }
+        };
+
+#if PROCESSOR_SSE2
+        // The same slab test on 4 children per instruction. SSE2 is the x64 baseline and needs no target attribute.
+        struct IntersectChildrenSSE
+        {
+            __m128 m_OriginX, m_OriginY, m_OriginZ;
+            __m128 m_InverseDirectionX, m_InverseDirectionY, m_InverseDirectionZ;
+
+            IntersectChildrenSSE(const glm::vec3& origin, const glm::vec3& inverseDirection) :
+                m_OriginX(_mm_set1_ps(origin.x)), m_OriginY(_mm_set1_ps(origin.y)), m_OriginZ(_mm_set1_ps(origin.z)),
+                m_InverseDirectionX(_mm_set1_ps(inverseDirection.x)), m_InverseDirectionY(_mm_set1_ps(inverseDirection.y)), m_InverseDirectionZ(_mm_set1_ps(inverseDirection.z))
+            {
+            }
+
+            uint32_t operator()(const WideBVH<4>::Node& node, float tMin, float tMax, float* distances) const
+            {
+                const __m128 t0X = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.m_BoundsMinimumX), m_OriginX), m_InverseDirectionX);
+                const __m128 t0Y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.m_BoundsMinimumY), m_OriginY), m_InverseDirectionY);
+                const __m128 t0Z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.m_BoundsMinimumZ), m_OriginZ), m_InverseDirectionZ);
+                const __m128 t1X = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.m_BoundsMaximumX), m_OriginX), m_InverseDirectionX);
+                const __m128 t1Y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.m_BoundsMaximumY), m_OriginY), m_InverseDirectionY);
+                const __m128 t1Z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.m_BoundsMaximumZ), m_OriginZ), m_InverseDirectionZ);
+
+                const __m128 entry = _mm_max_ps(_mm_min_ps(t0X, t1X), _mm_max_ps(_mm_min_ps(t0Y, t1Y), _mm_max_ps(_mm_min_ps(t0Z, t1Z), _mm_set1_ps(tMin))));
+                const __m128 exit = _mm_min_ps(_mm_max_ps(t0X, t1X), _mm_min_ps(_mm_max_ps(t0Y, t1Y), _mm_min_ps(_mm_max_ps(t0Z, t1Z), _mm_set1_ps(tMax))));
+
+                _mm_storeu_ps(distances, entry);
+                return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(entry, exit)));
+            }
+        };
+#endif
+
+#if PROCESSOR_X86
+        // 8 children per instruction. Only constructed and called from AVX2 targeted code.
+        struct IntersectChildrenAVX2
+        {
+            __m256 m_OriginX, m_OriginY, m_OriginZ;
+            __m256 m_InverseDirectionX, m_InverseDirectionY, m_InverseDirectionZ;
+
+            TARGET_AVX2 IntersectChildrenAVX2(const glm::vec3& origin, const glm::vec3& inverseDirection) :
+                m_OriginX(_mm256_set1_ps(origin.x)), m_OriginY(_mm256_set1_ps(origin.y)), m_OriginZ(_mm256_set1_ps(origin.z)),
+                m_InverseDirectionX(_mm256_set1_ps(inverseDirection.x)), m_InverseDirectionY(_mm256_set1_ps(inverseDirection.y)), m_InverseDirectionZ(_mm256_set1_ps(inverseDirection.z))
+            {
+            }
+
+            TARGET_AVX2 uint32_t operator()(const WideBVH<8>::Node& node, float tMin, float tMax, float* distances) const
+            {
+                const __m256 t0X = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.m_BoundsMinimumX), m_OriginX), m_InverseDirectionX);
+                const __m256 t0Y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.m_BoundsMinimumY), m_OriginY), m_InverseDirectionY);
+                const __m256 t0Z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.m_BoundsMinimumZ), m_OriginZ), m_InverseDirectionZ);
+                const __m256 t1X = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.m_BoundsMaximumX), m_OriginX), m_InverseDirectionX);
+                const __m256 t1Y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.m_BoundsMaximumY), m_OriginY), m_InverseDirectionY);
+                const __m256 t1Z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.m_BoundsMaximumZ), m_OriginZ), m_InverseDirectionZ);
+
+                const __m256 entry = _mm256_max_ps(_mm256_min_ps(t0X, t1X), _mm256_max_ps(_mm256_min_ps(t0Y, t1Y), _mm256_max_ps(_mm256_min_ps(t0Z, t1Z), _mm256_set1_ps(tMin))));
+                const __m256 exit = _mm256_min_ps(_mm256_max_ps(t0X, t1X), _mm256_min_ps(_mm256_max_ps(t0Y, t1Y), _mm256_min_ps(_mm256_max_ps(t0Z, t1Z), _mm256_set1_ps(tMax))));
+
+                _mm256_storeu_ps(distances, entry);
+                return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(entry, exit, _CMP_LE_OQ)));
+            }
+        };
+#endif
+    }
+
+    template<uint32_t Width>
+    WideBVH<Width>::WideBVH(const BVH& bvh) : m_Geometry(bvh.GetGeometry()), m_PrimitiveIndices(bvh.GetPrimitiveIndices())
+    {
+        const std::chrono::high_resolution_clock::time_point timer = std::chrono::high_resolution_clock::now();
+        const std::vector<BVH::Node>& binaryNodes = bvh.GetNodes();
+
+#if PROCESSOR_SSE2
+        m_IsVectorized = Width == 4 || (Width == 8 && ProcessorFeatures::Get().m_HasAVX2);
+#else
+        m_IsVectorized = false;
+#endif
+
+        if (binaryNodes.empty())
+        {
+            return;
+        }
+
+        // Every wide node replaces at least one binary inner node, so this is an upper bound.
+        m_Nodes.reserve(binaryNodes.size() / 2 + 1);
+        m_Nodes.emplace_back();
+
+        Collapse(binaryNodes, 0, 0, 1);
+
+        uint32_t childCount = 0;
+
+        for (const Node& node : m_Nodes)
+        {
+            childCount += static_cast<uint32_t>(std::count_if(node.m_BoundsMinimumX, node.m_BoundsMinimumX + Width, [](float minimum) { return minimum != std::numeric_limits<float>::infinity(); }));
+        }
+
+        m_Statistics.m_BuildTime = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+        m_Statistics.m_NodeCount = static_cast<uint32_t>(m_Nodes.size());
+        m_Statistics.m_AverageChildCount = static_cast<float>(childCount) / m_Nodes.size();
+    }
+
+    template<uint32_t Width>
+    void WideBVH<Width>::Collapse(const std::vector<BVH::Node>& binaryNodes, uint32_t binaryIndex, uint32_t nodeIndex, uint32_t depth)
+    {
+        const BVH::Node& binaryNode = binaryNodes[binaryIndex];
+        uint32_t children[Width];
+        uint32_t childCount = 0;
+
+        if (binaryNode.IsLeaf())
+        {
+            children[childCount++] = binaryIndex; // Only happens for a root leaf.
+        }
+        else
+        {
+            children[childCount++] = binaryNode.m_Offset;
+            children[childCount++] = binaryNode.m_Offset + 1;
+        }
+
+        // Pull up the grandchildren of the largest inner children until the node is full. Large boxes are entered by the most rays, opening them up
+        // saves the most visits.
+        while (childCount < Width)
+        {
+            uint32_t largestChild = Width;
+            float largestArea = -1.0f;
+
+            for (uint32_t i = 0; i != childCount; ++i)
+            {
+                const BVH::Node& child = binaryNodes[children[i]];
+                const float area = WideBVHUtilities::GetSurfaceArea(child);
+
+                if (!child.IsLeaf() && area > largestArea)
+                {
+                    largestChild = i;
+                    largestArea = area;
+                }
+            }
+
+            if (largestChild == Width)
+            {
+                break;
+            }
+
+            const uint32_t offset = binaryNodes[children[largestChild]].m_Offset;
+            children[largestChild] = offset;
+            children[childCount++] = offset + 1;
+        }
+
+        Node node;
+        std::fill_n(node.m_BoundsMinimumX, Width, std::numeric_limits<float>::infinity());
+        std::fill_n(node.m_BoundsMinimumY, Width, std::numeric_limits<float>::infinity());
+        std::fill_n(node.m_BoundsMinimumZ, Width, std::numeric_limits<float>::infinity());
+        std::fill_n(node.m_BoundsMaximumX, Width, std::numeric_limits<float>::infinity());
+        std::fill_n(node.m_BoundsMaximumY, Width, std::numeric_limits<float>::infinity());
+        std::fill_n(node.m_BoundsMaximumZ, Width, std::numeric_limits<float>::infinity());
+        std::fill_n(node.m_Children, Width, 0u);
+        std::fill_n(node.m_PrimitiveCounts, Width, 0u);
+
+        for (uint32_t i = 0; i != childCount; ++i)
+        {
+            const BVH::Node& child = binaryNodes[children[i]];
+
+            node.m_BoundsMinimumX[i] = child.m_BoundsMinimum.x;
+            node.m_BoundsMinimumY[i] = child.m_BoundsMinimum.y;
+            node.m_BoundsMinimumZ[i] = child.m_BoundsMinimum.z;
+            node.m_BoundsMaximumX[i] = child.m_BoundsMaximum.x;
+            node.m_BoundsMaximumY[i] = child.m_BoundsMaximum.y;
+            node.m_BoundsMaximumZ[i] = child.m_BoundsMaximum.z;
+
+            if (child.IsLeaf())
+            {
+                node.m_Children[i] = child.m_Offset;
+                node.m_PrimitiveCounts[i] = child.m_PrimitiveCount;
+                m_Statistics.m_LeafCount++;
+                m_Statistics.m_MaxDepth = std::max(m_Statistics.m_MaxDepth, depth);
+            }
+        }
+
+        m_Nodes[nodeIndex] = node;
+
+        for (uint32_t i = 0; i != childCount; ++i)
+        {
+            if (!binaryNodes[children[i]].IsLeaf())
+            {
+                const uint32_t childIndex = static_cast<uint32_t>(m_Nodes.size());
+
+                m_Nodes.emplace_back();
+                m_Nodes[nodeIndex].m_Children[i] = childIndex;
+                Collapse(binaryNodes, children[i], childIndex, depth + 1);
+            }
+        }
+    }
+
+    // Shared by all instruction sets. It is force inlined into each of the targeted callers, so the child tests get inlined into it in turn.
+    template<uint32_t Width>
+    template<typename TIntersectChildren>
+    FORCE_INLINE bool WideBVH<Width>::Traverse(const Ray& ray, float tMin, float tMax, Hit& hit, const TIntersectChildren& intersectChildren) const
+    {
+        using WideBVHUtilities::StackEntry;
+
+        if (m_Nodes.empty())
+        {
+            return false;
+        }
+
+        hit.m_Distance = tMax;
+        bool isHit = false;
+
+        StackEntry stack[WideBVHUtilities::StackSize<Width>];
+        uint32_t stackSize = 0;
+        StackEntry current = { 0, 0, tMin };
+
+        for (;;)
+        {
+            if (current.m_PrimitiveCount != 0)
+            {
+                for (uint32_t i = current.m_Child; i != current.m_Child + current.m_PrimitiveCount; ++i)
+                {
+                    isHit |= m_Geometry.Intersect(m_PrimitiveIndices[i], ray, tMin, hit);
+                }
+            }
+            else
+            {
+                const Node& node = m_Nodes[current.m_Child];
+                float distances[Width];
+                uint32_t mask = intersectChildren(node, tMin, hit.m_Distance, distances);
+
+                if (mask != 0)
+                {
+                    // Order the entered children by distance, farthest first, then descend into the nearest one and leave the others on the stack.
+                    StackEntry entries[Width];
+                    uint32_t entryCount = 0;
+
+                    while (mask != 0)
+                    {
+                        const uint32_t i = FindFirstSetBit(mask);
+                        mask &= mask - 1;
+
+                        StackEntry entry = { node.m_Children[i], node.m_PrimitiveCounts[i], distances[i] };
+                        uint32_t position = entryCount++;
+
+                        for (; position != 0 && entries[position - 1].m_Distance < entry.m_Distance; --position)
+                        {
+                            entries[position] = entries[position - 1];
+                        }
+
+                        entries[position] = entry;
+                    }
+
+                    for (uint32_t i = 0; i + 1 < entryCount; ++i)
+                    {
+                        stack[stackSize++] = entries[i];
+                    }
+
+                    current = entries[entryCount - 1];
+                    continue;
+                }
+            }
+
+            // Children entered beyond the closest hit found since they were pushed cannot contain a closer one.
+            do
+            {
+                if (stackSize == 0)
+                {
+                    return isHit;
+                }
+
+                current = stack[--stackSize];
+            }
+            while (current.m_Distance > hit.m_Distance);
+        }
+    }
+
+    template<uint32_t Width>
+    bool WideBVH<Width>::IntersectScalar(const Ray& ray, float tMin, float tMax, Hit& hit) const
+    {
+        const WideBVHUtilities::IntersectChildrenScalar<Width> intersectChildren = { ray.m_Origin, 1.0f / ray.m_Direction };
+        return Traverse(ray, tMin, tMax, hit, intersectChildren);
+    }
+
+    template<>
+    bool WideBVH<4>::IntersectVectorized(const Ray& ray, float tMin, float tMax, Hit& hit) const
+    {
+#if PROCESSOR_SSE2
+        return Traverse(ray, tMin, tMax, hit, WideBVHUtilities::IntersectChildrenSSE(ray.m_Origin, 1.0f / ray.m_Direction));
+#else
+        return IntersectScalar(ray, tMin, tMax, hit);
+#endif
+    }
+
+    template<>
+    TARGET_AVX2 bool WideBVH<8>::IntersectVectorized(const Ray& ray, float tMin, float tMax, Hit& hit) const
+    {
+#if PROCESSOR_X86
+        return Traverse(ray, tMin, tMax, hit, WideBVHUtilities::IntersectChildrenAVX2(ray.m_Origin, 1.0f / ray.m_Direction));
+#else
+        return IntersectScalar(ray, tMin, tMax, hit);
+#endif
+    }
+
+    template class WideBVH<4>;
+    template class WideBVH<8>;
+}
\ No newline at end of file
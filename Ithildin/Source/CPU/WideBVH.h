@@ -0,0 +1,76 @@
+#pragma once
+#include "BVH.h"
+#include "Core/ProcessorFeatures.h"
+#include <cstdint>
+#include <vector>
+
+namespace CPU
+{
+    // Hierarchy with up to Width children per node, collapsed from a binary BVH. The child bounds are stored as a structure of arrays so one ray is tested
+    // against all of them with a single set of SIMD instructions: SSE for 4 wide nodes, AVX2 for 8 wide ones if the processor has it, scalar code otherwise.
+    template<uint32_t Width>
+    class WideBVH final
+    {
+    public:
+        // One node per 2 (4 wide) or 4 (8 wide) cache lines. Unused child slots are packed at the end and have bounds no ray can enter.
+        struct alignas(64) Node
+        {
+            float m_BoundsMinimumX[Width];
+            float m_BoundsMinimumY[Width];
+            float m_BoundsMinimumZ[Width];
+            float m_BoundsMaximumX[Width];
+            float m_BoundsMaximumY[Width];
+            float m_BoundsMaximumZ[Width];
+            uint32_t m_Children[Width];        // Inner children: node index. Leaves: first entry of their primitive range.
+            uint32_t m_PrimitiveCounts[Width]; // 0 for inner children.
+        };
+
+        struct Statistics
+        {
+            float m_BuildTime = 0.0f; // Seconds, excluding the binary build.
+            uint32_t m_NodeCount = 0;
+            uint32_t m_LeafCount = 0;
+            uint32_t m_MaxDepth = 0;
+            float m_AverageChildCount = 0.0f;
+        };
+
+        // Leaves are taken over from the binary tree unchanged. The binary BVH may be released afterwards, but its geometry has to outlive this one.
+        explicit WideBVH(const BVH& bvh);
+
+        const std::vector<Node>& GetNodes() const { return m_Nodes; }
+        const Statistics& GetStatistics() const { return m_Statistics; }
+        bool IsVectorized() const { return m_IsVectorized; } // Whether the SIMD traversal is used on this processor.
+
+        // Finds the closest hit within [tMin, tMax).
+        bool Intersect(const Ray& ray, float tMin, float tMax, Hit& hit) const
+        {
+            return m_IsVectorized ? IntersectVectorized(ray, tMin, tMax, hit) : IntersectScalar(ray, tMin, tMax, hit);
+        }
+
+    private:
+        void Collapse(const std::vector<BVH::Node>& binaryNodes, uint32_t binaryIndex, uint32_t nodeIndex, uint32_t depth);
+
+        bool IntersectScalar(const Ray& ray, float tMin, float tMax, Hit& hit) const;
+        bool IntersectVectorized(const Ray& ray, float tMin, float tMax, Hit& hit) const;
+
+        template<typename TIntersectChildren>
+        bool Traverse(const Ray& ray, float tMin, float tMax, Hit& hit, const TIntersectChildren& intersectChildren) const;
+
+    private:
+        const SceneGeometry& m_Geometry;
+        std::vector<Node> m_Nodes;
+        std::vector<uint32_t> m_PrimitiveIndices;
+        Statistics m_Statistics;
+        bool m_IsVectorized = false;
+    };
+
+    // SSE for 4 wide nodes, AVX2 for 8 wide ones.
+    template<> bool WideBVH<4>::IntersectVectorized(const Ray& ray, float tMin, float tMax, Hit& hit) const;
+    template<> TARGET_AVX2 bool WideBVH<8>::IntersectVectorized(const Ray& ray, float tMin, float tMax, Hit& hit) const;
+
+    typedef WideBVH<4> BVH4;
+    typedef WideBVH<8> BVH8;
+
+    extern template class WideBVH<4>;
+    extern template class WideBVH<8>;
+}
\ No newline at end of file
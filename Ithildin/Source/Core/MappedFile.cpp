@@ -0,0 +1,99 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filePath)
+{
+    m_FileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if (m_FileHandle == INVALID_HANDLE_VALUE)
+    {
+        m_FileHandle = nullptr;
+        return;
+    }
+
+    LARGE_INTEGER fileSize = {};
+
+    if (!GetFileSizeEx(m_FileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        return;
+    }
+
+    m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (m_MappingHandle == nullptr)
+    {
+        return;
+    }
+
+    m_Data = static_cast<const uint8_t*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+    m_Size = m_Data != nullptr ? static_cast<size_t>(fileSize.QuadPart) : 0;
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_Data != nullptr)
+    {
+        UnmapViewOfFile(m_Data);
+        m_Data = nullptr;
+    }
+
+    if (m_MappingHandle != nullptr)
+    {
+        CloseHandle(m_MappingHandle);
+        m_MappingHandle = nullptr;
+    }
+
+    if (m_FileHandle != nullptr)
+    {
+        CloseHandle(m_FileHandle);
+        m_FileHandle = nullptr;
+    }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filePath)
+{
+    const int file = open(filePath.c_str(), O_RDONLY);
+
+    if (file < 0)
+    {
+        return;
+    }
+
+    struct stat fileStatus = {};
+
+    if (fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0)
+    {
+        void* data = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+        if (data != MAP_FAILED)
+        {
+            m_Data = static_cast<const uint8_t*>(data);
+            m_Size = static_cast<size_t>(fileStatus.st_size);
+        }
+    }
+
+    close(file); // The mapping keeps its own reference to the file.
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_Data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(m_Data), m_Size);
+        m_Data = nullptr;
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace Parallel
+{
+    inline uint32_t GetWorkerCount()
+    {
+        return std::max(1u, std::thread::hardware_concurrency()); // Can return 0 if the value is not well defined.
+    }
+
+    // Invokes function(workerIndex) once for each worker. The calling thread runs worker 0 itself.
+    template<typename TFunction>
+    void ForEachWorker(uint32_t workerCount, const TFunction& function)
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(workerCount > 0 ? workerCount - 1 : 0);
+
+        for (uint32_t i = 1; i < workerCount; ++i)
+        {
+            workers.emplace_back([&function, i]() { function(i); });
+        }
+
+        if (workerCount > 0)
+        {
+            function(0u);
+        }
+
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    // Splits [0, count) into contiguous ranges of at least minimumRangeSize elements and invokes function(begin, end, rangeIndex) for each range on its own worker.
+    template<typename TFunction>
+    void ForEachRange(size_t count, size_t minimumRangeSize, const TFunction& function)
+    {
+        const size_t maximumRanges = std::max<size_t>(1, count / std::max<size_t>(1, minimumRangeSize));
+        const uint32_t rangeCount = static_cast<uint32_t>(std::min<size_t>(GetWorkerCount(), maximumRanges));
+
+        ForEachWorker(rangeCount, [&](uint32_t rangeIndex)
+        {
+            const size_t begin = count * rangeIndex / rangeCount;
+            const size_t end = count * (rangeIndex + 1) / rangeCount;
+
+            function(begin, end, rangeIndex);
+        });
+    }
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "ProcessorFeatures.h"
+#include <cstdint>
+
+#if PROCESSOR_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace ProcessorFeaturesUtilities
+{
+#if PROCESSOR_X86
+    void QueryCPUID(uint32_t leaf, uint32_t subleaf, uint32_t registers[4])
+    {
+#ifdef _MSC_VER
+        int values[4];
+        __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+
+        for (int i = 0; i != 4; ++i)
+        {
+            registers[i] = static_cast<uint32_t>(values[i]);
+        }
+#else
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    }
+
+    // Which register states the operating system saves on context switches.
+    uint64_t QueryEnabledStates()
+    {
+#ifdef _MSC_VER
+        return _xgetbv(0);
+#else
+        uint32_t low, high;
+        __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+    }
+
+    ProcessorFeatures QueryFeatures()
+    {
+        ProcessorFeatures features = {};
+        uint32_t registers[4] = {}; // EAX, EBX, ECX, EDX.
+
+        QueryCPUID(0, 0, registers);
+        const uint32_t maximumLeaf = registers[0];
+
+        if (maximumLeaf < 1)
+        {
+            return features;
+        }
+
+        QueryCPUID(1, 0, registers);
+        features.m_HasSSE41 = (registers[2] & (1u << 19)) != 0;
+
+        const bool hasOSXSAVE = (registers[2] & (1u << 27)) != 0;
+        const bool hasAVXInstructions = (registers[2] & (1u << 28)) != 0;
+        const bool hasFMAInstructions = (registers[2] & (1u << 12)) != 0;
+        const bool hasAVXState = hasOSXSAVE && (QueryEnabledStates() & 0x6) == 0x6; // XMM and YMM registers.
+
+        features.m_HasAVX = hasAVXInstructions && hasAVXState;
+        features.m_HasFMA = hasFMAInstructions && hasAVXState;
+
+        if (maximumLeaf >= 7)
+        {
+            QueryCPUID(7, 0, registers);
+            features.m_HasAVX2 = features.m_HasAVX && (registers[1] & (1u << 5)) != 0;
+        }
+
+        return features;
+    }
+#else
+    ProcessorFeatures QueryFeatures()
+    {
+        return ProcessorFeatures();
+    }
+#endif
+}
+
+const ProcessorFeatures& ProcessorFeatures::Get()
+{
+    static const ProcessorFeatures features = ProcessorFeaturesUtilities::QueryFeatures();
+    return features;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PROCESSOR_X86 1
+#else
+#define PROCESSOR_X86 0
+#endif
+
+// SSE2 is part of every x64 processor, so 4 wide code does not need a runtime check.
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PROCESSOR_SSE2 1
+#else
+#define PROCESSOR_SSE2 0
+#endif
+
+// Functions using instructions beyond the build's baseline are marked with these and must only be called once ProcessorFeatures confirms support.
+// MSVC accepts any intrinsic without them, GCC and Clang need to be told per function.
+#if PROCESSOR_X86 && !defined(_MSC_VER)
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_SSE41
+#define TARGET_AVX2
+#endif
+
+// Generic code shared by several instruction sets has to be inlined into the targeted function, GCC does not inline targeted helpers into it otherwise.
+#ifdef _MSC_VER
+#define FORCE_INLINE __forceinline
+#else
+#define FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
+// Index of the lowest set bit, for walking the lane masks of vector comparisons. The mask must not be 0.
+FORCE_INLINE uint32_t FindFirstSetBit(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+}
+
+// Instruction set extensions of the host processor, queried once through CPUID. Code paths are picked at runtime, so one binary runs everywhere.
+struct ProcessorFeatures final
+{
+    bool m_HasSSE41 = false;
+    bool m_HasAVX = false;  // Also requires the operating system to preserve the 256 bit registers.
+    bool m_HasAVX2 = false;
+    bool m_HasFMA = false;
+
+    static const ProcessorFeatures& Get();
+};
\ No newline at end of file
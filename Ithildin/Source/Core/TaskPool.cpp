@@ -0,0 +1,173 @@
+#include "TaskPool.h"
+#include <utility>
+
+namespace Parallel
+{
+    namespace TaskPoolUtilities
+    {
+        // Identifies the pool and queue of the worker running on this thread, if any.
+        thread_local const TaskPool* CurrentPool = nullptr;
+        thread_local uint32_t CurrentQueueIndex = 0;
+    }
+
+    TaskPool::TaskPool(uint32_t workerCount)
+    {
+        workerCount = std::max(1u, workerCount);
+
+        for (uint32_t i = 0; i != workerCount + 1; ++i)
+        {
+            m_Queues.emplace_back(new TaskQueue());
+        }
+
+        m_Workers.reserve(workerCount);
+
+        for (uint32_t i = 0; i != workerCount; ++i)
+        {
+            m_Workers.emplace_back(&TaskPool::RunWorker, this, i);
+        }
+    }
+
+    TaskPool::~TaskPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_WakeMutex);
+            m_IsStopping = true;
+        }
+
+        m_WakeCondition.notify_all();
+
+        for (std::thread& worker : m_Workers)
+        {
+            worker.join();
+        }
+    }
+
+    void TaskPool::Run(TaskGroup& group, std::function<void()> task)
+    {
+        group.m_PendingTasks.fetch_add(1, std::memory_order_relaxed);
+
+        m_QueuedTasks.fetch_add(1, std::memory_order_release); // Counted first, so the count never drops below the number of queued tasks.
+
+        TaskQueue& queue = *m_Queues[GetQueueIndex()];
+        {
+            std::lock_guard<std::mutex> lock(queue.m_Mutex);
+            queue.m_Tasks.push_back({ std::move(task), &group });
+        }
+
+        // Taking the lock orders this notification after any worker that is about to sleep has checked for queued tasks.
+        {
+            std::lock_guard<std::mutex> lock(m_WakeMutex);
+        }
+
+        m_WakeCondition.notify_one();
+    }
+
+    void TaskPool::Wait(TaskGroup& group)
+    {
+        const uint32_t queueIndex = GetQueueIndex();
+
+        while (group.m_PendingTasks.load(std::memory_order_acquire) != 0)
+        {
+            if (!TryRunTask(queueIndex))
+            {
+                std::this_thread::yield(); // The remaining tasks are running on other threads.
+            }
+        }
+
+        if (group.m_Exception)
+        {
+            std::rethrow_exception(std::exchange(group.m_Exception, nullptr));
+        }
+    }
+
+    uint32_t TaskPool::GetQueueIndex() const
+    {
+        return TaskPoolUtilities::CurrentPool == this ? TaskPoolUtilities::CurrentQueueIndex : static_cast<uint32_t>(m_Workers.size());
+    }
+
+    bool TaskPool::TryRunTask(uint32_t queueIndex)
+    {
+        if (m_QueuedTasks.load(std::memory_order_acquire) == 0)
+        {
+            return false;
+        }
+
+        Task task = {};
+        bool hasTask = false;
+
+        // Newest task of our own queue first, it most likely works on data that is still in cache.
+        {
+            TaskQueue& queue = *m_Queues[queueIndex];
+            std::lock_guard<std::mutex> lock(queue.m_Mutex);
+
+            if (!queue.m_Tasks.empty())
+            {
+                task = std::move(queue.m_Tasks.back());
+                queue.m_Tasks.pop_back();
+                hasTask = true;
+            }
+        }
+
+        // Otherwise steal the oldest task of another queue, which tends to be the largest piece of work left.
+        const uint32_t queueCount = static_cast<uint32_t>(m_Queues.size());
+
+        for (uint32_t i = 1; i != queueCount && !hasTask; ++i)
+        {
+            TaskQueue& queue = *m_Queues[(queueIndex + i) % queueCount];
+            std::lock_guard<std::mutex> lock(queue.m_Mutex);
+
+            if (!queue.m_Tasks.empty())
+            {
+                task = std::move(queue.m_Tasks.front());
+                queue.m_Tasks.pop_front();
+                hasTask = true;
+            }
+        }
+
+        if (!hasTask)
+        {
+            return false;
+        }
+
+        m_QueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+
+        try
+        {
+            task.m_Function();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(task.m_Group->m_ExceptionMutex);
+
+            if (!task.m_Group->m_Exception)
+            {
+                task.m_Group->m_Exception = std::current_exception();
+            }
+        }
+
+        task.m_Group->m_PendingTasks.fetch_sub(1, std::memory_order_release);
+        return true;
+    }
+
+    void TaskPool::RunWorker(uint32_t workerIndex)
+    {
+        TaskPoolUtilities::CurrentPool = this;
+        TaskPoolUtilities::CurrentQueueIndex = workerIndex;
+
+        for (;;)
+        {
+            if (TryRunTask(workerIndex))
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_WakeMutex);
+            m_WakeCondition.wait(lock, [this]() { return m_IsStopping || m_QueuedTasks.load(std::memory_order_acquire) != 0; });
+
+            if (m_IsStopping)
+            {
+                return;
+            }
+        }
+    }
+}
\ No newline at end of file
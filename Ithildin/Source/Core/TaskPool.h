@@ -0,0 +1,89 @@
+#pragma once
+#include "Parallel.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Parallel
+{
+    // Persistent worker threads with one task queue each. Workers run their own newest tasks first and steal the oldest tasks of others once they run dry,
+    // so recursively spawned work stays local while independent work spreads across the pool.
+    class TaskPool final
+    {
+    public:
+        // Tracks a set of tasks so they can be waited on together. The first exception thrown by any of them is rethrown by Wait().
+        class TaskGroup final
+        {
+        public:
+            TaskGroup() = default;
+            TaskGroup(const TaskGroup&) = delete;
+            TaskGroup& operator=(const TaskGroup&) = delete;
+
+        private:
+            friend class TaskPool;
+
+            std::atomic<uint32_t> m_PendingTasks = 0;
+            std::mutex m_ExceptionMutex;
+            std::exception_ptr m_Exception;
+        };
+
+        explicit TaskPool(uint32_t workerCount = Parallel::GetWorkerCount());
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+        ~TaskPool();
+
+        uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+
+        // Tasks queued from a worker go to its own queue, tasks queued from any other thread to a shared one.
+        void Run(TaskGroup& group, std::function<void()> task);
+
+        // Runs queued tasks on the calling thread until every task of the group has completed. Safe to call from within a task.
+        void Wait(TaskGroup& group);
+
+        // Invokes function(index) for every index in [0, count) and waits for all of them.
+        template<typename TFunction>
+        void ForEach(uint32_t count, const TFunction& function)
+        {
+            TaskGroup group;
+
+            for (uint32_t i = 0; i != count; ++i)
+            {
+                Run(group, [&function, i]() { function(i); });
+            }
+
+            Wait(group);
+        }
+
+    private:
+        struct Task
+        {
+            std::function<void()> m_Function;
+            TaskGroup* m_Group;
+        };
+
+        struct TaskQueue
+        {
+            std::mutex m_Mutex;
+            std::deque<Task> m_Tasks;
+        };
+
+        uint32_t GetQueueIndex() const;
+        bool TryRunTask(uint32_t queueIndex);
+        void RunWorker(uint32_t workerIndex);
+
+    private:
+        std::vector<std::unique_ptr<TaskQueue>> m_Queues; // One per worker, followed by the shared queue for other threads.
+        std::vector<std::thread> m_Workers;
+
+        std::atomic<uint32_t> m_QueuedTasks = 0;
+        std::mutex m_WakeMutex;
+        std::condition_variable m_WakeCondition;
+        bool m_IsStopping = false;
+    };
+}
\ No newline at end of file
@@ -13,5 +13,6 @@ namespace Vulkan
         bool m_IsCursorDisabled;
         bool m_IsFullscreen;
         bool m_IsResizable;
+        bool m_IsHeadless = false; // Render offscreen at Width x Height without creating a window, surface or swapchain.
     }; 
 }
\ No newline at end of file
@@ -189,6 +189,8 @@ void Editor::DrawSettings()
         ImGui::SliderScalar("Samples", ImGuiDataType_U32, &GetSettings().m_NumberOfSamples, &min, &max);
         min = 1, max = 32;
         ImGui::SliderScalar("Bounces", ImGuiDataType_U32, &GetSettings().m_NumberOfBounces, &min, &max);
+        ImGui::Checkbox("Batch Static Geometry", &GetSettings().m_BatchStaticGeometry);
+        ImGui::Checkbox("Compact Acceleration Structures", &GetSettings().m_CompactAccelerationStructures);
         ImGui::NewLine();
 
         ImGui::Text("Camera");
@@ -202,6 +204,7 @@ void Editor::DrawSettings()
         ImGui::Separator();
         ImGui::Checkbox("Show Heatmap", &GetSettings().m_ShowHeatmap);
         ImGui::SliderFloat("Scaling", &GetSettings().m_HeatmapScale, 0.10f, 10.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+        ImGui::Checkbox("Compare Uniform Map/Unmap", &GetSettings().m_CompareUniformUpdates);
         ImGui::NewLine();
     }
 
@@ -237,6 +240,31 @@ void Editor::DrawOverlay(const Statistics& statistics)
         ImGui::Text("Frame Rate: %.1f FPS", statistics.m_FrameRate);
         ImGui::Text("Primary Ray Rate: %.2f Gr/s", statistics.m_RayRate);
         ImGui::Text("Accumulated Samples:  %u", statistics.m_TotalSamples);
+        ImGui::Text("Uniform Update: %.2f us", statistics.m_UniformUpdateTime);
+
+        if (GetSettings().m_CompareUniformUpdates)
+        {
+            ImGui::Text("Uniform Update (Map/Unmap): %.2f us", statistics.m_MapUnmapUniformUpdateTime);
+        }
+
+        const float megabyte = 1024.0f * 1024.0f;
+
+        if (statistics.m_CompactedBottomLevelSize != 0)
+        {
+            ImGui::Text("BLAS Memory: %.2f MB -> %.2f MB", statistics.m_BottomLevelSize / megabyte, statistics.m_CompactedBottomLevelSize / megabyte);
+        }
+        else
+        {
+            ImGui::Text("BLAS Memory: %.2f MB", statistics.m_BottomLevelSize / megabyte);
+        }
+
+        ImGui::Text("Device Memory: %.2f / %.2f MB", statistics.m_DeviceMemoryUsed / megabyte, statistics.m_DeviceMemoryReserved / megabyte);
+        ImGui::Text("Allocations: %u in %u blocks", statistics.m_DeviceMemoryAllocations, statistics.m_DeviceMemoryBlocks);
+
+        if (statistics.m_IsLoadingScene)
+        {
+            ImGui::Text("Loading Scene...");
+        }
     }
 
     ImGui::End();
@@ -20,6 +20,15 @@ struct Statistics
     float m_FrameRate;
     float m_RayRate;
     uint32_t m_TotalSamples;
+    float m_UniformUpdateTime;           // Microseconds of CPU time spent writing the frame's uniforms.
+    float m_MapUnmapUniformUpdateTime;   // The same for the Map/Unmap write, while comparing the two.
+    uint64_t m_BottomLevelSize;          // Bytes, as built.
+    uint64_t m_CompactedBottomLevelSize; // Bytes, 0 if compaction is disabled.
+    uint64_t m_DeviceMemoryUsed;         // Bytes bound to buffers and images.
+    uint64_t m_DeviceMemoryReserved;     // Bytes allocated from the driver in memory blocks.
+    uint32_t m_DeviceMemoryAllocations;
+    uint32_t m_DeviceMemoryBlocks;
+    bool m_IsLoadingScene;               // A newly selected scene is being imported in the background.
 };
 
 class Editor final
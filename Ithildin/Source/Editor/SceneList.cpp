@@ -2,6 +2,7 @@
 #include "Resources/Material.h"
 #include "Resources/Model.h"
 #include "Resources/Texture.h"
+#include <cmath>
 #include <functional>
 #include <random>
 
@@ -34,6 +35,17 @@ SceneAssets SceneList::CubeAndSpheres(CameraInitialState& cameraState)
 	models.push_back(Resources::Model::CreateSphere(glm::vec3(-1, 0, 0), 0.5, Resources::Material::Dielectric(1.5f), true));
 	models.push_back(Resources::Model::CreateSphere(glm::vec3(0, 1, 0), 0.5, Resources::Material::Lambertian(glm::vec3(1.0f), 0), true));
 
+	// The textured sphere spins about its center and bobs up and down, it keeps its own top level instance so only that instance is refit.
+	models.back().SetDynamic(true);
+
+	cameraState.m_Animations.push_back({ 3, 0, [](double time)
+	{
+		const glm::vec3 center(0, 1, 0);
+		const glm::mat4 spin = glm::rotate(glm::mat4(1), static_cast<float>(time * 0.5), glm::vec3(0, 1, 0));
+
+		return glm::translate(glm::mat4(1), center + glm::vec3(0, 0.25f * static_cast<float>(std::sin(time)), 0)) * spin * glm::translate(glm::mat4(1), -center);
+	}});
+
 	textures.push_back(Resources::Texture::LoadTexture("../Assets/Textures/land_ocean_ice_cloud_2048.png", Vulkan::SamplerConfiguration()));
 
 	return std::forward_as_tuple(std::move(models), std::move(textures));
@@ -242,40 +254,28 @@ SceneAssets SceneList::LucyInOneWeekend(CameraInitialState& cameraState)
 	}
 
 	auto lucy0 = Resources::Model::LoadModel("../Assets/Models/lucy.obj");
-	auto lucy1 = lucy0;
-	auto lucy2 = lucy0;
 
 	const auto i = glm::mat4(1);
 	const float scaleFactor = 0.0035f;
 
-	lucy0.SetTransform(
-		glm::rotate(
-			glm::scale(
-				glm::translate(i, glm::vec3(0, -0.08f, 0)),
-				glm::vec3(scaleFactor)),
-			glm::radians(90.0f), glm::vec3(0, 1, 0)));
-
-	lucy1.SetTransform(
-		glm::rotate(
-			glm::scale(
-				glm::translate(i, glm::vec3(-4, -0.08f, 0)),
-				glm::vec3(scaleFactor)),
-			glm::radians(90.0f), glm::vec3(0, 1, 0)));
-
-	lucy2.SetTransform(
-		glm::rotate(
+	// The three statues share a single copy of the geometry and differ only by their transform and material.
+	const auto lucyTransform = [&](const float x)
+	{
+		return glm::rotate(
 			glm::scale(
-				glm::translate(i, glm::vec3(4, -0.08f, 0)),
+				glm::translate(i, glm::vec3(x, -0.08f, 0)),
 				glm::vec3(scaleFactor)),
-			glm::radians(90.0f), glm::vec3(0, 1, 0)));
+			glm::radians(90.0f), glm::vec3(0, 1, 0));
+	};
 
-	lucy0.SetMaterial(Resources::Material::Dielectric(1.5f));
-	lucy1.SetMaterial(Resources::Material::Lambertian(glm::vec3(0.4f, 0.2f, 0.1f)));
-	lucy2.SetMaterial(Resources::Material::Metallic(glm::vec3(0.7f, 0.6f, 0.5f), 0.05f));
+	lucy0.SetInstances(
+	{
+		{ lucyTransform(0), Resources::Material::Dielectric(1.5f) },
+		{ lucyTransform(-4), Resources::Material::Lambertian(glm::vec3(0.4f, 0.2f, 0.1f)) },
+		{ lucyTransform(4), Resources::Material::Metallic(glm::vec3(0.7f, 0.6f, 0.5f), 0.05f) }
+	});
 
 	models.push_back(std::move(lucy0));
-	models.push_back(std::move(lucy1));
-	models.push_back(std::move(lucy2));
 
 	return std::forward_as_tuple(std::move(models), std::vector<Resources::Texture>());
 }
@@ -16,6 +16,14 @@ typedef std::tuple<std::vector<Resources::Model>, std::vector<Resources::Texture
 class SceneList final
 {
 public:
+    // Moves one instance of a dynamic model while the scene is shown.
+    struct InstanceAnimation
+    {
+        uint32_t m_ModelIndex;
+        uint32_t m_InstanceIndex;
+        std::function<glm::mat4(double time)> m_Transform; // Transform of the instance at the given time, in seconds.
+    };
+
     struct CameraInitialState
     {
         glm::mat4 m_ModelView;
@@ -25,6 +33,7 @@ public:
         float m_ControlSpeed;
         bool m_GammaCorrection;
         bool m_HasSky;
+        std::vector<InstanceAnimation> m_Animations;
     };
 
     static SceneAssets CubeAndSpheres(CameraInitialState& cameraState);
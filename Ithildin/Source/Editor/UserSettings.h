@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <string>
 
 struct UserSettings final
 {
@@ -8,7 +9,9 @@ struct UserSettings final
 
     // Benchmark
     bool m_BenchmarkNextScenes = {};
-    uint32_t m_BenchmarkMaxTime = {};
+    uint32_t m_BenchmarkMaxTime = {};    // Measured seconds per scene, after the warm-up.
+    uint32_t m_BenchmarkWarmUpTime = {}; // Seconds rendered before measuring starts, lets clocks and caches settle.
+    std::string m_BenchmarkOutputPath;   // .csv or .json, results are not written if empty.
 
     // Renderer
     bool m_IsRaytracingEnabled;
@@ -16,6 +19,8 @@ struct UserSettings final
     uint32_t m_NumberOfSamples;
     uint32_t m_NumberOfBounces;
     uint32_t m_MaxNumberOfSamples;
+    bool m_BatchStaticGeometry;
+    bool m_CompactAccelerationStructures;
 
     // Scene
     int m_SceneIndex;
@@ -28,6 +33,7 @@ struct UserSettings final
     // Profiler
     bool m_ShowHeatmap;
     float m_HeatmapScale;
+    bool m_CompareUniformUpdates; // Times the old Map/Unmap uniform write next to the persistently mapped one.
 
     // UI
     bool m_ShowSettings;
@@ -45,4 +51,10 @@ struct UserSettings final
                m_Aperture                 != previousSettings.m_Aperture                 ||
                m_FocusDistance            != previousSettings.m_FocusDistance;
     }
+
+    bool RequireAccelerationStructureRebuild(const UserSettings& previousSettings) const
+    {
+        return m_BatchStaticGeometry           != previousSettings.m_BatchStaticGeometry ||
+               m_CompactAccelerationStructures != previousSettings.m_CompactAccelerationStructures;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "BenchmarkExporter.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace Exporters
+{
+    namespace BenchmarkUtilities
+    {
+        std::ofstream OpenFile(const std::string& filePath)
+        {
+            std::ofstream file(filePath);
+
+            if (!file)
+            {
+                throw std::runtime_error("Failed to open '" + filePath + "' for writing.");
+            }
+
+            // Enough digits to tell apart small regressions, without printing float noise.
+            file.precision(6);
+            return file;
+        }
+
+        // Fields are always quoted, scene and device names may contain commas.
+        std::string QuoteCSV(const std::string& text)
+        {
+            std::string quoted = "\"";
+
+            for (const char character : text)
+            {
+                quoted += character == '"' ? "\"\"" : std::string(1, character);
+            }
+
+            return quoted + "\"";
+        }
+
+        std::string QuoteJSON(const std::string& text)
+        {
+            std::string quoted = "\"";
+
+            for (const char character : text)
+            {
+                switch (character)
+                {
+                    case '"': quoted += "\\\""; break;
+                    case '\\': quoted += "\\\\"; break;
+                    case '\n': quoted += "\\n"; break;
+                    case '\t': quoted += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(character) < 0x20)
+                        {
+                            char escaped[8];
+                            std::snprintf(escaped, sizeof(escaped), "\\u%04x", character);
+                            quoted += escaped;
+                        }
+                        else
+                        {
+                            quoted += character;
+                        }
+                        break;
+                }
+            }
+
+            return quoted + "\"";
+        }
+    }
+
+    void BenchmarkExporter::Export(const std::string& filePath, const std::vector<SceneResult>& results)
+    {
+        const size_t extensionOffset = filePath.find_last_of('.');
+        std::string extension = extensionOffset != std::string::npos ? filePath.substr(extensionOffset) : std::string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char character) { return static_cast<char>(std::tolower(character)); });
+
+        if (extension == ".csv")
+        {
+            ExportCSV(filePath, results);
+        }
+        else if (extension == ".json")
+        {
+            ExportJSON(filePath, results);
+        }
+        else
+        {
+            throw std::invalid_argument("Unsupported benchmark format '" + extension + "', expected .csv or .json.");
+        }
+    }
+
+    void BenchmarkExporter::ExportCSV(const std::string& filePath, const std::vector<SceneResult>& results)
+    {
+        std::ofstream file = BenchmarkUtilities::OpenFile(filePath);
+        file << "SceneIndex,SceneName,Device,Width,Height,SamplesPerFrame,Bounces,Frames,Time,FPS,MinFPS,MaxFPS,GigaRaysPerSecond\n";
+
+        for (const SceneResult& result : results)
+        {
+            file << result.m_SceneIndex << ','
+                 << BenchmarkUtilities::QuoteCSV(result.m_SceneName) << ','
+                 << BenchmarkUtilities::QuoteCSV(result.m_DeviceName) << ','
+                 << result.m_Width << ','
+                 << result.m_Height << ','
+                 << result.m_SamplesPerFrame << ','
+                 << result.m_NumberOfBounces << ','
+                 << result.m_TotalFrames << ','
+                 << result.m_TotalTime << ','
+                 << result.m_FrameRate << ','
+                 << result.m_MinimumFrameRate << ','
+                 << result.m_MaximumFrameRate << ','
+                 << result.m_RayRate << '\n';
+        }
+    }
+
+    void BenchmarkExporter::ExportJSON(const std::string& filePath, const std::vector<SceneResult>& results)
+    {
+        std::ofstream file = BenchmarkUtilities::OpenFile(filePath);
+        file << "{\n  \"scenes\": [";
+
+        for (size_t i = 0; i != results.size(); ++i)
+        {
+            const SceneResult& result = results[i];
+
+            file << (i == 0 ? "\n" : ",\n")
+                 << "    {\n"
+                 << "      \"sceneIndex\": " << result.m_SceneIndex << ",\n"
+                 << "      \"sceneName\": " << BenchmarkUtilities::QuoteJSON(result.m_SceneName) << ",\n"
+                 << "      \"device\": " << BenchmarkUtilities::QuoteJSON(result.m_DeviceName) << ",\n"
+                 << "      \"width\": " << result.m_Width << ",\n"
+                 << "      \"height\": " << result.m_Height << ",\n"
+                 << "      \"samplesPerFrame\": " << result.m_SamplesPerFrame << ",\n"
+                 << "      \"bounces\": " << result.m_NumberOfBounces << ",\n"
+                 << "      \"frames\": " << result.m_TotalFrames << ",\n"
+                 << "      \"time\": " << result.m_TotalTime << ",\n"
+                 << "      \"fps\": " << result.m_FrameRate << ",\n"
+                 << "      \"minFps\": " << result.m_MinimumFrameRate << ",\n"
+                 << "      \"maxFps\": " << result.m_MaximumFrameRate << ",\n"
+                 << "      \"gigaRaysPerSecond\": " << result.m_RayRate << "\n"
+                 << "    }";
+        }
+
+        file << (results.empty() ? "]\n}\n" : "\n  ]\n}\n");
+    }
+}
\ No newline at end of file
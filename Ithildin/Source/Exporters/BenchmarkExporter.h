@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Exporters
+{
+    // Writes benchmark results as one record per scene, so runs of different versions can be compared side by side.
+    class BenchmarkExporter final
+    {
+    public:
+        struct SceneResult
+        {
+            uint32_t m_SceneIndex = 0;
+            std::string m_SceneName;
+            std::string m_DeviceName;
+            uint32_t m_Width = 0;
+            uint32_t m_Height = 0;
+            uint32_t m_SamplesPerFrame = 0;
+            uint32_t m_NumberOfBounces = 0;
+
+            uint32_t m_TotalFrames = 0;
+            double m_TotalTime = 0;        // Measured seconds, warm-up excluded.
+            double m_FrameRate = 0;        // Average over the whole measurement.
+            double m_MinimumFrameRate = 0; // Slowest and fastest reporting period.
+            double m_MaximumFrameRate = 0;
+            double m_RayRate = 0;          // Giga rays per second.
+        };
+
+        // Picks the format from the file extension, either .csv or .json.
+        static void Export(const std::string& filePath, const std::vector<SceneResult>& results);
+
+        static void ExportCSV(const std::string& filePath, const std::vector<SceneResult>& results);
+        static void ExportJSON(const std::string& filePath, const std::vector<SceneResult>& results);
+    };
+}
\ No newline at end of file
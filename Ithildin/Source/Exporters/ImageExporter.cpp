@@ -0,0 +1,273 @@
+#include "ImageExporter.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace Exporters
+{
+    namespace ExportUtilities
+    {
+        // Both formats store multi-byte values in a fixed byte order, so they are appended byte by byte.
+        template<typename T>
+        void AppendLittleEndian(std::vector<uint8_t>& bytes, T value)
+        {
+            uint8_t valueBytes[sizeof(T)];
+            std::memcpy(valueBytes, &value, sizeof(T));
+
+            for (size_t i = 0; i != sizeof(T); ++i)
+            {
+                bytes.push_back(valueBytes[i]); // The targets we build for are little endian.
+            }
+        }
+
+        void AppendBigEndian(std::vector<uint8_t>& bytes, uint32_t value)
+        {
+            bytes.push_back(static_cast<uint8_t>(value >> 24));
+            bytes.push_back(static_cast<uint8_t>(value >> 16));
+            bytes.push_back(static_cast<uint8_t>(value >> 8));
+            bytes.push_back(static_cast<uint8_t>(value));
+        }
+
+        void AppendString(std::vector<uint8_t>& bytes, const char* text)
+        {
+            bytes.insert(bytes.end(), text, text + std::strlen(text) + 1); // Including the terminator.
+        }
+
+        uint32_t ComputeCRC32(const uint8_t* data, size_t size)
+        {
+            static const std::array<uint32_t, 256> table = []()
+            {
+                std::array<uint32_t, 256> crcTable = {};
+
+                for (uint32_t i = 0; i != 256; ++i)
+                {
+                    uint32_t crc = i;
+
+                    for (int bit = 0; bit != 8; ++bit)
+                    {
+                        crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+                    }
+
+                    crcTable[i] = crc;
+                }
+
+                return crcTable;
+            }();
+
+            uint32_t crc = 0xFFFFFFFFu;
+
+            for (size_t i = 0; i != size; ++i)
+            {
+                crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+            }
+
+            return crc ^ 0xFFFFFFFFu;
+        }
+
+        void AppendPNGChunk(std::vector<uint8_t>& file, const char* type, const std::vector<uint8_t>& data)
+        {
+            AppendBigEndian(file, static_cast<uint32_t>(data.size()));
+
+            const size_t typeOffset = file.size();
+            file.insert(file.end(), type, type + 4);
+            file.insert(file.end(), data.begin(), data.end());
+
+            AppendBigEndian(file, ComputeCRC32(file.data() + typeOffset, file.size() - typeOffset)); // Covers the type and the data.
+        }
+
+        void WriteFile(const std::string& filePath, const std::vector<uint8_t>& bytes)
+        {
+            std::ofstream file(filePath, std::ios::binary);
+
+            if (!file)
+            {
+                throw std::runtime_error("Failed to open '" + filePath + "' for writing.");
+            }
+
+            file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        }
+
+        void CheckPixelCount(const std::vector<float>& pixels, uint32_t width, uint32_t height)
+        {
+            if (pixels.size() != static_cast<size_t>(width) * height * 4)
+            {
+                throw std::invalid_argument("Pixel data does not match the image size.");
+            }
+        }
+    }
+
+    void ImageExporter::Export(const std::string& filePath, const std::vector<float>& pixels, uint32_t width, uint32_t height)
+    {
+        const size_t extensionOffset = filePath.find_last_of('.');
+        std::string extension = extensionOffset != std::string::npos ? filePath.substr(extensionOffset) : std::string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char character) { return static_cast<char>(std::tolower(character)); });
+
+        if (extension == ".png")
+        {
+            ExportPNG(filePath, pixels, width, height);
+        }
+        else if (extension == ".exr")
+        {
+            ExportEXR(filePath, pixels, width, height);
+        }
+        else
+        {
+            throw std::invalid_argument("Unsupported image format '" + extension + "', expected .png or .exr.");
+        }
+    }
+
+    void ImageExporter::ExportPNG(const std::string& filePath, const std::vector<float>& pixels, uint32_t width, uint32_t height)
+    {
+        ExportUtilities::CheckPixelCount(pixels, width, height);
+
+        // 8 bit RGB scanlines, each starting with filter type 0 (none). The same square root gamma as the ray generation shader is applied.
+        const size_t rowSize = 1 + static_cast<size_t>(width) * 3;
+        std::vector<uint8_t> scanlines(rowSize * height);
+
+        for (uint32_t y = 0; y != height; ++y)
+        {
+            uint8_t* row = scanlines.data() + y * rowSize;
+            row[0] = 0;
+
+            for (uint32_t x = 0; x != width; ++x)
+            {
+                const float* pixel = pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+
+                for (int channel = 0; channel != 3; ++channel)
+                {
+                    const float value = std::sqrt(std::clamp(pixel[channel], 0.0f, 1.0f));
+                    row[1 + x * 3 + channel] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+                }
+            }
+        }
+
+        // Wrap the scanlines in a zlib stream of uncompressed deflate blocks. Renders are written once, so size matters less than having no dependency.
+        std::vector<uint8_t> imageData = { 0x78, 0x01 };
+        const size_t maximumBlockSize = 65535;
+
+        for (size_t offset = 0; offset < scanlines.size() || offset == 0; offset += maximumBlockSize)
+        {
+            const uint16_t blockSize = static_cast<uint16_t>(std::min(maximumBlockSize, scanlines.size() - offset));
+            const bool isFinalBlock = offset + blockSize == scanlines.size();
+
+            imageData.push_back(isFinalBlock ? 1 : 0);
+            ExportUtilities::AppendLittleEndian<uint16_t>(imageData, blockSize);
+            ExportUtilities::AppendLittleEndian<uint16_t>(imageData, static_cast<uint16_t>(~blockSize));
+            imageData.insert(imageData.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+        }
+
+        uint32_t adlerA = 1;
+        uint32_t adlerB = 0;
+
+        for (const uint8_t byte : scanlines)
+        {
+            adlerA = (adlerA + byte) % 65521;
+            adlerB = (adlerB + adlerA) % 65521;
+        }
+
+        ExportUtilities::AppendBigEndian(imageData, (adlerB << 16) | adlerA);
+
+        std::vector<uint8_t> header;
+        ExportUtilities::AppendBigEndian(header, width);
+        ExportUtilities::AppendBigEndian(header, height);
+        header.insert(header.end(), { 8, 2, 0, 0, 0 }); // Bit depth, RGB color type, deflate, adaptive filtering, no interlacing.
+
+        std::vector<uint8_t> file = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        ExportUtilities::AppendPNGChunk(file, "IHDR", header);
+        ExportUtilities::AppendPNGChunk(file, "IDAT", imageData);
+        ExportUtilities::AppendPNGChunk(file, "IEND", {});
+
+        ExportUtilities::WriteFile(filePath, file);
+    }
+
+    void ImageExporter::ExportEXR(const std::string& filePath, const std::vector<float>& pixels, uint32_t width, uint32_t height)
+    {
+        ExportUtilities::CheckPixelCount(pixels, width, height);
+
+        using ExportUtilities::AppendLittleEndian;
+        using ExportUtilities::AppendString;
+
+        // Single part scanline image with uncompressed 32 bit float channels. Channels must be listed in alphabetical order.
+        const char* channelNames[] = { "B", "G", "R" };
+        const int channelOffsets[] = { 2, 1, 0 };
+
+        std::vector<uint8_t> file;
+        AppendLittleEndian<uint32_t>(file, 20000630); // Magic number.
+        AppendLittleEndian<uint32_t>(file, 2);        // Version 2, no flags.
+
+        std::vector<uint8_t> channels;
+
+        for (const char* channelName : channelNames)
+        {
+            AppendString(channels, channelName);
+            AppendLittleEndian<int32_t>(channels, 2);  // FLOAT pixel type.
+            AppendLittleEndian<uint32_t>(channels, 0); // Not perceptually linear, and 3 reserved bytes.
+            AppendLittleEndian<int32_t>(channels, 1);  // X sampling.
+            AppendLittleEndian<int32_t>(channels, 1);  // Y sampling.
+        }
+
+        channels.push_back(0);
+
+        std::vector<uint8_t> window;
+        AppendLittleEndian<int32_t>(window, 0);
+        AppendLittleEndian<int32_t>(window, 0);
+        AppendLittleEndian<int32_t>(window, static_cast<int32_t>(width) - 1);
+        AppendLittleEndian<int32_t>(window, static_cast<int32_t>(height) - 1);
+
+        const auto appendAttribute = [&file](const char* name, const char* type, const std::vector<uint8_t>& value)
+        {
+            AppendString(file, name);
+            AppendString(file, type);
+            AppendLittleEndian<int32_t>(file, static_cast<int32_t>(value.size()));
+            file.insert(file.end(), value.begin(), value.end());
+        };
+
+        std::vector<uint8_t> pixelAspectRatio, screenWindowCenter, screenWindowWidth;
+        AppendLittleEndian<float>(pixelAspectRatio, 1.0f);
+        AppendLittleEndian<float>(screenWindowCenter, 0.0f);
+        AppendLittleEndian<float>(screenWindowCenter, 0.0f);
+        AppendLittleEndian<float>(screenWindowWidth, 1.0f);
+
+        appendAttribute("channels", "chlist", channels);
+        appendAttribute("compression", "compression", { 0 }); // None.
+        appendAttribute("dataWindow", "box2i", window);
+        appendAttribute("displayWindow", "box2i", window);
+        appendAttribute("lineOrder", "lineOrder", { 0 });     // Increasing Y.
+        appendAttribute("pixelAspectRatio", "float", pixelAspectRatio);
+        appendAttribute("screenWindowCenter", "v2f", screenWindowCenter);
+        appendAttribute("screenWindowWidth", "float", screenWindowWidth);
+        file.push_back(0); // End of header.
+
+        // Offset table with one entry per scanline, followed by the scanlines themselves.
+        const size_t scanlineDataSize = static_cast<size_t>(width) * 3 * sizeof(float);
+        const size_t scanlineSize = 2 * sizeof(int32_t) + scanlineDataSize;
+        const size_t firstScanlineOffset = file.size() + static_cast<size_t>(height) * sizeof(uint64_t);
+
+        for (uint32_t y = 0; y != height; ++y)
+        {
+            AppendLittleEndian<uint64_t>(file, firstScanlineOffset + y * scanlineSize);
+        }
+
+        file.reserve(firstScanlineOffset + static_cast<size_t>(height) * scanlineSize);
+
+        for (uint32_t y = 0; y != height; ++y)
+        {
+            AppendLittleEndian<int32_t>(file, static_cast<int32_t>(y));
+            AppendLittleEndian<int32_t>(file, static_cast<int32_t>(scanlineDataSize));
+
+            for (const int channelOffset : channelOffsets)
+            {
+                for (uint32_t x = 0; x != width; ++x)
+                {
+                    AppendLittleEndian<float>(file, pixels[(static_cast<size_t>(y) * width + x) * 4 + channelOffset]);
+                }
+            }
+        }
+
+        ExportUtilities::WriteFile(filePath, file);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Exporters
+{
+    // Writes linear RGBA float images to disk without any external dependencies.
+    // PNG output is gamma corrected like the viewport and quantized to 8 bits per channel, EXR output keeps the full linear float values.
+    class ImageExporter final
+    {
+    public:
+        // Picks the format from the file extension, either .png or .exr.
+        static void Export(const std::string& filePath, const std::vector<float>& pixels, uint32_t width, uint32_t height);
+
+        static void ExportPNG(const std::string& filePath, const std::vector<float>& pixels, uint32_t width, uint32_t height);
+        static void ExportEXR(const std::string& filePath, const std::vector<float>& pixels, uint32_t width, uint32_t height);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,404 @@
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "ObjImporter.h"
+#include "Core/Parallel.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+namespace Importers
+{
+    namespace ObjUtilities
+    {
+        // Faces before the first "usemtl" of a chunk continue with whichever material the previous chunk ended on.
+        constexpr int32_t InheritedMaterial = -2;
+
+        // Components of a corner that were specified with negative (relative) indices and still need the offset of all previous chunks.
+        enum RelativeComponent : uint8_t
+        {
+            RelativeComponent_Position = 1 << 0,
+            RelativeComponent_TexCoord = 1 << 1,
+            RelativeComponent_Normal   = 1 << 2
+        };
+
+        struct Chunk
+        {
+            std::vector<float> m_Positions;
+            std::vector<float> m_Normals;
+            std::vector<float> m_TexCoords;
+            std::vector<ObjImporter::Index> m_Indices;
+            std::vector<int32_t> m_MaterialSlots; // Index into m_MaterialNames, or InheritedMaterial.
+            std::vector<std::pair<uint32_t, uint8_t>> m_RelativeCorners;
+            std::vector<std::string> m_MaterialNames;
+            std::vector<std::string> m_MaterialLibraries;
+        };
+
+        inline bool IsSpace(char character)
+        {
+            return character == ' ' || character == '\t';
+        }
+
+        inline bool IsKeyword(const char* line, const char* lineEnd, const char* keyword, size_t length)
+        {
+            return static_cast<size_t>(lineEnd - line) > length && std::strncmp(line, keyword, length) == 0 && IsSpace(line[length]);
+        }
+
+        inline const char* SkipSpaces(const char* p, const char* lineEnd)
+        {
+            while (p < lineEnd && IsSpace(*p))
+            {
+                ++p;
+            }
+
+            return p;
+        }
+
+        inline std::string ReadName(const char* p, const char* lineEnd)
+        {
+            p = SkipSpaces(p, lineEnd);
+
+            const char* end = lineEnd;
+            while (end > p && (IsSpace(end[-1]) || end[-1] == '\r'))
+            {
+                --end;
+            }
+
+            return std::string(p, end);
+        }
+
+        inline void ReadFloats(const char* p, const char* lineEnd, float* values, uint32_t count)
+        {
+            for (uint32_t i = 0; i != count; ++i)
+            {
+                char* end = nullptr;
+                const float value = std::strtof(p, &end);
+                const bool isValid = end != p && end <= lineEnd;
+
+                values[i] = isValid ? value : 0.0f;
+                p = isValid ? end : lineEnd;
+            }
+        }
+
+        inline const char* ReadInteger(const char* p, const char* lineEnd, int32_t& value)
+        {
+            bool isNegative = false;
+
+            if (p < lineEnd && (*p == '-' || *p == '+'))
+            {
+                isNegative = *p == '-';
+                ++p;
+            }
+
+            value = 0;
+            while (p < lineEnd && *p >= '0' && *p <= '9')
+            {
+                value = value * 10 + (*p - '0');
+                ++p;
+            }
+
+            value = isNegative ? -value : value;
+            return p;
+        }
+
+        // OBJ indices are one-based, or relative to the end of the attribute list when negative.
+        inline int32_t ResolveIndex(int32_t index, size_t localCount, uint8_t component, uint8_t& relativeComponents)
+        {
+            if (index > 0)
+            {
+                return index - 1;
+            }
+
+            if (index < 0)
+            {
+                relativeComponents |= component;
+                return static_cast<int32_t>(localCount) + index;
+            }
+
+            return -1;
+        }
+
+        void ParseFace(const char* p, const char* lineEnd, int32_t materialSlot, Chunk& chunk, std::vector<ObjImporter::Index>& polygon, std::vector<uint8_t>& polygonRelatives)
+        {
+            polygon.clear();
+            polygonRelatives.clear();
+
+            while (true)
+            {
+                p = SkipSpaces(p, lineEnd);
+
+                if (p >= lineEnd || *p == '\r' || *p == '#')
+                {
+                    break;
+                }
+
+                int32_t position = 0, texCoord = 0, normal = 0;
+                p = ReadInteger(p, lineEnd, position);
+
+                if (p < lineEnd && *p == '/')
+                {
+                    p = ReadInteger(p + 1, lineEnd, texCoord);
+
+                    if (p < lineEnd && *p == '/')
+                    {
+                        p = ReadInteger(p + 1, lineEnd, normal);
+                    }
+                }
+
+                // Skip anything we do not understand up to the next corner.
+                while (p < lineEnd && !IsSpace(*p) && *p != '\r')
+                {
+                    ++p;
+                }
+
+                uint8_t relativeComponents = 0;
+                ObjImporter::Index index = {};
+                index.m_Position = ResolveIndex(position, chunk.m_Positions.size() / 3, RelativeComponent_Position, relativeComponents);
+                index.m_TexCoord = ResolveIndex(texCoord, chunk.m_TexCoords.size() / 2, RelativeComponent_TexCoord, relativeComponents);
+                index.m_Normal = ResolveIndex(normal, chunk.m_Normals.size() / 3, RelativeComponent_Normal, relativeComponents);
+
+                polygon.push_back(index);
+                polygonRelatives.push_back(relativeComponents);
+            }
+
+            // Fan triangulation. Quads may be split along the other diagonal than tinyobj would pick, which makes no difference for planar polygons.
+            for (size_t i = 1; i + 1 < polygon.size(); ++i)
+            {
+                const size_t corners[3] = { 0, i, i + 1 };
+
+                for (const size_t corner : corners)
+                {
+                    if (polygonRelatives[corner] != 0)
+                    {
+                        chunk.m_RelativeCorners.emplace_back(static_cast<uint32_t>(chunk.m_Indices.size()), polygonRelatives[corner]);
+                    }
+
+                    chunk.m_Indices.push_back(polygon[corner]);
+                }
+
+                chunk.m_MaterialSlots.push_back(materialSlot);
+            }
+        }
+
+        void ParseChunk(const char* begin, const char* end, Chunk& chunk)
+        {
+            std::vector<ObjImporter::Index> polygon;
+            std::vector<uint8_t> polygonRelatives;
+            int32_t materialSlot = InheritedMaterial;
+
+            for (const char* line = begin; line < end;)
+            {
+                const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', end - line));
+                lineEnd = lineEnd ? lineEnd : end;
+
+                const char* p = SkipSpaces(line, lineEnd);
+
+                if (IsKeyword(p, lineEnd, "v", 1))
+                {
+                    float position[3];
+                    ReadFloats(p + 1, lineEnd, position, 3);
+                    chunk.m_Positions.insert(chunk.m_Positions.end(), position, position + 3);
+                }
+                else if (IsKeyword(p, lineEnd, "vn", 2))
+                {
+                    float normal[3];
+                    ReadFloats(p + 2, lineEnd, normal, 3);
+                    chunk.m_Normals.insert(chunk.m_Normals.end(), normal, normal + 3);
+                }
+                else if (IsKeyword(p, lineEnd, "vt", 2))
+                {
+                    float texCoord[2];
+                    ReadFloats(p + 2, lineEnd, texCoord, 2);
+                    chunk.m_TexCoords.insert(chunk.m_TexCoords.end(), texCoord, texCoord + 2);
+                }
+                else if (IsKeyword(p, lineEnd, "f", 1))
+                {
+                    ParseFace(p + 1, lineEnd, materialSlot, chunk, polygon, polygonRelatives);
+                }
+                else if (IsKeyword(p, lineEnd, "usemtl", 6))
+                {
+                    materialSlot = static_cast<int32_t>(chunk.m_MaterialNames.size());
+                    chunk.m_MaterialNames.push_back(ReadName(p + 6, lineEnd));
+                }
+                else if (IsKeyword(p, lineEnd, "mtllib", 6))
+                {
+                    chunk.m_MaterialLibraries.push_back(ReadName(p + 6, lineEnd));
+                }
+
+                line = lineEnd + 1;
+            }
+        }
+
+        float GetElapsedSeconds(std::chrono::high_resolution_clock::time_point& timer)
+        {
+            const std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+            const float elapsedTime = std::chrono::duration<float, std::chrono::seconds::period>(now - timer).count();
+            timer = now;
+
+            return elapsedTime;
+        }
+    }
+
+    ObjImporter::Result ObjImporter::Import(const std::string& filePath)
+    {
+        using namespace ObjUtilities;
+
+        Result result;
+        std::chrono::high_resolution_clock::time_point timer = std::chrono::high_resolution_clock::now();
+
+        // Read the whole file in one go. Parsing from memory is much faster than going through a stream line by line.
+        std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+
+        if (!file)
+        {
+            throw std::runtime_error("Failed to open model: " + filePath + "\n");
+        }
+
+        std::string text(static_cast<size_t>(file.tellg()), '\0');
+        file.seekg(0);
+        file.read(text.data(), text.size());
+        file.close();
+
+        result.m_ReadTime = GetElapsedSeconds(timer);
+
+        // Split the text into line aligned chunks, one per worker. Tiny files are not worth the thread start up.
+        const size_t minimumChunkSize = 1024 * 1024;
+        const uint32_t chunkCount = static_cast<uint32_t>(std::min<size_t>(Parallel::GetWorkerCount(), std::max<size_t>(1, text.size() / minimumChunkSize)));
+        std::vector<size_t> chunkBoundaries(chunkCount + 1, text.size());
+        chunkBoundaries[0] = 0;
+
+        for (uint32_t i = 1; i < chunkCount; ++i)
+        {
+            const size_t boundary = std::max(chunkBoundaries[i - 1], text.size() * i / chunkCount);
+            const size_t lineEnd = text.find('\n', boundary);
+
+            chunkBoundaries[i] = lineEnd == std::string::npos ? text.size() : lineEnd + 1;
+        }
+
+        std::vector<Chunk> chunks(chunkCount);
+
+        Parallel::ForEachWorker(chunkCount, [&](uint32_t i)
+        {
+            ParseChunk(text.data() + chunkBoundaries[i], text.data() + chunkBoundaries[i + 1], chunks[i]);
+        });
+
+        result.m_ParseTime = GetElapsedSeconds(timer);
+
+        // Materials are small, load them serially.
+        std::map<std::string, int> materialMap;
+        const std::filesystem::path materialBaseDirectory = std::filesystem::path(filePath).parent_path().empty() ? "." : std::filesystem::path(filePath).parent_path();
+        tinyobj::MaterialFileReader materialReader(materialBaseDirectory.string());
+
+        for (const Chunk& chunk : chunks)
+        {
+            for (const std::string& library : chunk.m_MaterialLibraries)
+            {
+                result.m_MaterialLibraries.push_back((materialBaseDirectory / library).string());
+
+                std::string error;
+                materialReader(library, &result.m_Materials, &materialMap, &result.m_Warning, &error);
+                result.m_Warning += error;
+            }
+        }
+
+        // Work out where each chunk lands in the merged arrays, and which material each chunk's faces resolve to.
+        struct ChunkOffsets
+        {
+            size_t m_Positions = 0;
+            size_t m_Normals = 0;
+            size_t m_TexCoords = 0;
+            size_t m_Indices = 0;
+            size_t m_Triangles = 0;
+            int32_t m_InheritedMaterialID = -1;
+            std::vector<int32_t> m_MaterialIDs;
+        };
+
+        std::vector<ChunkOffsets> offsets(chunkCount + 1);
+
+        for (uint32_t i = 0; i != chunkCount; ++i)
+        {
+            const Chunk& chunk = chunks[i];
+            ChunkOffsets& current = offsets[i];
+            ChunkOffsets& next = offsets[i + 1];
+
+            for (const std::string& name : chunk.m_MaterialNames)
+            {
+                const auto material = materialMap.find(name);
+
+                if (material == materialMap.end())
+                {
+                    result.m_Warning += "Material [ " + name + " ] not found in .mtl file.\n";
+                }
+
+                current.m_MaterialIDs.push_back(material != materialMap.end() ? material->second : -1);
+            }
+
+            next.m_Positions = current.m_Positions + chunk.m_Positions.size();
+            next.m_Normals = current.m_Normals + chunk.m_Normals.size();
+            next.m_TexCoords = current.m_TexCoords + chunk.m_TexCoords.size();
+            next.m_Indices = current.m_Indices + chunk.m_Indices.size();
+            next.m_Triangles = current.m_Triangles + chunk.m_MaterialSlots.size();
+            next.m_InheritedMaterialID = current.m_MaterialIDs.empty() ? current.m_InheritedMaterialID : current.m_MaterialIDs.back();
+        }
+
+        const ChunkOffsets& totals = offsets[chunkCount];
+
+        result.m_Positions.resize(totals.m_Positions);
+        result.m_Normals.resize(totals.m_Normals);
+        result.m_TexCoords.resize(totals.m_TexCoords);
+        result.m_Indices.resize(totals.m_Indices);
+        result.m_MaterialIDs.resize(totals.m_Triangles);
+
+        // Merge the chunks in parallel, fixing up relative indices and inherited materials on the way.
+        Parallel::ForEachWorker(chunkCount, [&](uint32_t i)
+        {
+            Chunk& chunk = chunks[i];
+            const ChunkOffsets& offset = offsets[i];
+
+            std::copy(chunk.m_Positions.begin(), chunk.m_Positions.end(), result.m_Positions.begin() + offset.m_Positions);
+            std::copy(chunk.m_Normals.begin(), chunk.m_Normals.end(), result.m_Normals.begin() + offset.m_Normals);
+            std::copy(chunk.m_TexCoords.begin(), chunk.m_TexCoords.end(), result.m_TexCoords.begin() + offset.m_TexCoords);
+
+            for (const std::pair<uint32_t, uint8_t>& relativeCorner : chunk.m_RelativeCorners)
+            {
+                Index& index = chunk.m_Indices[relativeCorner.first];
+
+                index.m_Position += relativeCorner.second & RelativeComponent_Position ? static_cast<int32_t>(offset.m_Positions / 3) : 0;
+                index.m_TexCoord += relativeCorner.second & RelativeComponent_TexCoord ? static_cast<int32_t>(offset.m_TexCoords / 2) : 0;
+                index.m_Normal += relativeCorner.second & RelativeComponent_Normal ? static_cast<int32_t>(offset.m_Normals / 3) : 0;
+            }
+
+            std::copy(chunk.m_Indices.begin(), chunk.m_Indices.end(), result.m_Indices.begin() + offset.m_Indices);
+
+            for (size_t triangle = 0; triangle != chunk.m_MaterialSlots.size(); ++triangle)
+            {
+                const int32_t slot = chunk.m_MaterialSlots[triangle];
+                result.m_MaterialIDs[offset.m_Triangles + triangle] = slot == InheritedMaterial ? offset.m_InheritedMaterialID : offset.m_MaterialIDs[slot];
+            }
+
+            chunk = Chunk(); // Release chunk memory as early as possible, big scans can be several gigabytes.
+        });
+
+        // Indices in absolute form may still point past the attribute arrays in broken files, catch those here rather than when reading vertices.
+        const int32_t positionCount = static_cast<int32_t>(result.m_Positions.size() / 3);
+        const int32_t texCoordCount = static_cast<int32_t>(result.m_TexCoords.size() / 2);
+        const int32_t normalCount = static_cast<int32_t>(result.m_Normals.size() / 3);
+
+        for (Index& index : result.m_Indices)
+        {
+            if (index.m_Position < 0 || index.m_Position >= positionCount)
+            {
+                throw std::runtime_error("Invalid vertex index in model: " + filePath + "\n");
+            }
+
+            index.m_TexCoord = index.m_TexCoord >= 0 && index.m_TexCoord < texCoordCount ? index.m_TexCoord : -1;
+            index.m_Normal = index.m_Normal >= 0 && index.m_Normal < normalCount ? index.m_Normal : -1;
+        }
+
+        result.m_MergeTime = GetElapsedSeconds(timer);
+
+        return result;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+#include "Internal/tiny_obj_loader.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Importers
+{
+    // Wavefront OBJ parser that splits the file text into line aligned chunks and parses them on all avaliable cores.
+    // Only the subset of the format used by our assets is understood: positions, normals, texture coordinates, polygonal faces and materials.
+    class ObjImporter final
+    {
+    public:
+        // Zero-based attribute indices of a single face corner. -1 if the attribute was not specified.
+        struct Index
+        {
+            int32_t m_Position;
+            int32_t m_TexCoord;
+            int32_t m_Normal;
+        };
+
+        struct Result
+        {
+            std::vector<float> m_Positions; // 3 per vertex.
+            std::vector<float> m_Normals;   // 3 per normal.
+            std::vector<float> m_TexCoords; // 2 per texture coordinate.
+            std::vector<Index> m_Indices;   // 3 per triangle. Polygons are fan triangulated.
+            std::vector<int32_t> m_MaterialIDs; // 1 per triangle. -1 if none was assigned.
+            std::vector<tinyobj::material_t> m_Materials;
+            std::vector<std::string> m_MaterialLibraries; // Paths of the .mtl files the OBJ references, whether they were found or not.
+            std::string m_Warning;
+
+            float m_ReadTime = 0.0f;
+            float m_ParseTime = 0.0f;
+            float m_MergeTime = 0.0f;
+        };
+
+        static Result Import(const std::string& filePath);
+    };
+}
\ No newline at end of file
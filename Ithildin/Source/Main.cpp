@@ -2,6 +2,21 @@
 #include "Raytracer.h"
 #include "Vulkan/VulkanUtilities.h"
 #include "Editor/UserSettings.h"
+#include "CPU/PathTracer.h"
+#include "CPU/TraversalBenchmark.h"
+#include "Exporters/ImageExporter.h"
+#include "Importers/ObjImporter.h"
+#include "Math/IntersectionTest.h"
+#include "Resources/Model.h"
+#include "Resources/NormalGeneratorTest.h"
+#include "Resources/Texture.h"
+#include "Resources/UniformBuffer.h"
+#include "Resources/VertexWelder.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
 
 void SetVulkanDevice(Vulkan::Application& application);
 
@@ -14,6 +29,7 @@ namespace LaunchUtilities
         userSettings.m_IsBenchmarkingEnabled = false;
         userSettings.m_BenchmarkNextScenes = false;
         userSettings.m_BenchmarkMaxTime = 60;
+        userSettings.m_BenchmarkWarmUpTime = 5;
 
         userSettings.m_SceneIndex = 1;
 
@@ -22,21 +38,322 @@ namespace LaunchUtilities
         userSettings.m_NumberOfSamples = 8;
         userSettings.m_NumberOfBounces = 16;
         userSettings.m_MaxNumberOfSamples = 64 * 1024;
+        userSettings.m_BatchStaticGeometry = true;
+        userSettings.m_CompactAccelerationStructures = true;
 
         userSettings.m_ShowSettings = !userSettings.m_IsBenchmarkingEnabled;
         userSettings.m_ShowOverlay = true;
 
         userSettings.m_ShowHeatmap = false;
         userSettings.m_HeatmapScale = 1.5f;
+        userSettings.m_CompareUniformUpdates = false;
 
         return userSettings;
     }
+
+    struct HeadlessSettings
+    {
+        bool m_IsEnabled = false;
+        uint32_t m_SampleCount = 1024;
+        std::string m_OutputPath = "Render.png";
+        bool m_UseCPU = false; // Traces on the host, no Vulkan device is created.
+        bool m_BenchmarkTraversal = false; // Measures the CPU ray traversal instead of rendering.
+        bool m_TestIntersections = false;  // Checks the SIMD intersection kernels against the scalar tests instead of rendering.
+        bool m_BenchmarkWeld = false;      // Compares the vertex weld tables instead of rendering.
+        bool m_TestNormals = false;        // Checks the parallel normal generator against a serial one instead of rendering.
+    };
+
+    // Usage: Ithildin --cpu-benchmark [--width <pixels>] [--height <pixels>]
+    //        Ithildin --intersection-test
+    //        Ithildin --weld-benchmark
+    //        Ithildin --normals-test
+    //        Ithildin --headless [--cpu] [--samples <count>] [--output <file.png|file.exr>] [--width <pixels>] [--height <pixels>] [--scene <index>]
+    //        Ithildin --benchmark [--benchmark-all-scenes] [--benchmark-time <seconds>] [--benchmark-warm-up <seconds>] [--benchmark-output <file.csv|file.json>] [--width <pixels>] [--height <pixels>] [--scene <index>]
+    HeadlessSettings ParseCommandLine(int argc, char* argv[], Vulkan::WindowSettings& windowSettings, UserSettings& userSettings)
+    {
+        HeadlessSettings headlessSettings = {};
+        bool hasSceneIndex = false;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (argument == "--headless")
+            {
+                headlessSettings.m_IsEnabled = true;
+            }
+            else if (argument == "--cpu")
+            {
+                headlessSettings.m_IsEnabled = true;
+                headlessSettings.m_UseCPU = true;
+            }
+            else if (argument == "--cpu-benchmark")
+            {
+                headlessSettings.m_IsEnabled = true;
+                headlessSettings.m_UseCPU = true;
+                headlessSettings.m_BenchmarkTraversal = true;
+            }
+            else if (argument == "--intersection-test")
+            {
+                headlessSettings.m_IsEnabled = true;
+                headlessSettings.m_UseCPU = true;
+                headlessSettings.m_TestIntersections = true;
+            }
+            else if (argument == "--weld-benchmark")
+            {
+                headlessSettings.m_IsEnabled = true;
+                headlessSettings.m_UseCPU = true;
+                headlessSettings.m_BenchmarkWeld = true;
+            }
+            else if (argument == "--normals-test")
+            {
+                headlessSettings.m_IsEnabled = true;
+                headlessSettings.m_UseCPU = true;
+                headlessSettings.m_TestNormals = true;
+            }
+            else if (argument == "--samples" && hasValue)
+            {
+                headlessSettings.m_SampleCount = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+            }
+            else if (argument == "--output" && hasValue)
+            {
+                headlessSettings.m_OutputPath = argv[++i];
+            }
+            else if (argument == "--width" && hasValue)
+            {
+                windowSettings.m_Width = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (argument == "--height" && hasValue)
+            {
+                windowSettings.m_Height = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (argument == "--scene" && hasValue)
+            {
+                userSettings.m_SceneIndex = std::stoi(argv[++i]);
+                hasSceneIndex = true;
+            }
+            else if (argument == "--benchmark")
+            {
+                userSettings.m_IsBenchmarkingEnabled = true;
+            }
+            else if (argument == "--benchmark-all-scenes")
+            {
+                userSettings.m_IsBenchmarkingEnabled = true;
+                userSettings.m_BenchmarkNextScenes = true;
+            }
+            else if (argument == "--benchmark-time" && hasValue)
+            {
+                userSettings.m_BenchmarkMaxTime = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (argument == "--benchmark-warm-up" && hasValue)
+            {
+                userSettings.m_BenchmarkWarmUpTime = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (argument == "--benchmark-output" && hasValue)
+            {
+                userSettings.m_BenchmarkOutputPath = argv[++i];
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown or incomplete command line argument: " + argument);
+            }
+        }
+
+        if (headlessSettings.m_IsEnabled && userSettings.m_IsBenchmarkingEnabled)
+        {
+            throw std::invalid_argument("Benchmarks measure the interactive renderer and cannot run headless.");
+        }
+
+        if (userSettings.m_SceneIndex < 0 || userSettings.m_SceneIndex >= static_cast<int>(SceneList::s_AllScenes.size()))
+        {
+            throw std::invalid_argument("Scene index " + std::to_string(userSettings.m_SceneIndex) + " is out of range, there are " + std::to_string(SceneList::s_AllScenes.size()) + " scenes.");
+        }
+
+        if (windowSettings.m_Width == 0 || windowSettings.m_Height == 0)
+        {
+            throw std::invalid_argument("Width and height must not be zero.");
+        }
+
+        // Iterating over all scenes starts from the first one, unless told otherwise.
+        if (userSettings.m_BenchmarkNextScenes && !hasSceneIndex)
+        {
+            userSettings.m_SceneIndex = 0;
+        }
+
+        userSettings.m_ShowSettings = !userSettings.m_IsBenchmarkingEnabled;
+        windowSettings.m_IsHeadless = headlessSettings.m_IsEnabled;
+        return headlessSettings;
+    }
+
+    // Renders the scene with the CPU path tracer, in the same batches of samples as the GPU renders its frames, so both draw the same random sequences.
+    void RenderOnCPU(UserSettings userSettings, const Vulkan::WindowSettings& windowSettings, const HeadlessSettings& headlessSettings)
+    {
+        SceneList::CameraInitialState cameraState = {};
+        const SceneAssets assets = SceneList::s_AllScenes[userSettings.m_SceneIndex].second(cameraState);
+        const auto& [models, textures] = assets;
+
+        userSettings.m_FieldOfView = cameraState.m_FieldOfView;
+        userSettings.m_Aperture = cameraState.m_Aperture;
+        userSettings.m_FocusDistance = cameraState.m_FocusDistance;
+        userSettings.m_ShowHeatmap = false; // Needs the shader clock.
+
+        const CPU::PathTracer pathTracer(models, textures);
+        const VkExtent2D extent = { windowSettings.m_Width, windowSettings.m_Height };
+        std::vector<float> pixels(static_cast<size_t>(extent.width) * extent.height * 4);
+
+        const std::chrono::high_resolution_clock::time_point renderStart = std::chrono::high_resolution_clock::now();
+        uint32_t totalNumberOfSamples = 0;
+
+        while (totalNumberOfSamples < headlessSettings.m_SampleCount)
+        {
+            const uint32_t numberOfSamples = std::min(userSettings.m_NumberOfSamples, headlessSettings.m_SampleCount - totalNumberOfSamples);
+            totalNumberOfSamples += numberOfSamples;
+
+            pathTracer.Render(Raytracer::CreateUniformBufferObject(userSettings, cameraState.m_ModelView, extent, totalNumberOfSamples, numberOfSamples), extent.width, extent.height, pixels);
+            std::cout << "\rTraced " << totalNumberOfSamples << " / " << headlessSettings.m_SampleCount << " samples." << std::flush;
+        }
+
+        const double renderTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - renderStart).count();
+        const float sampleWeight = 1.0f / static_cast<float>(totalNumberOfSamples);
+
+        for (size_t i = 0; i < pixels.size(); i += 4)
+        {
+            pixels[i + 0] *= sampleWeight;
+            pixels[i + 1] *= sampleWeight;
+            pixels[i + 2] *= sampleWeight;
+            pixels[i + 3] = 1.0f;
+        }
+
+        Exporters::ImageExporter::Export(headlessSettings.m_OutputPath, pixels, extent.width, extent.height);
+
+        const double rayRate = double(extent.width) * extent.height * totalNumberOfSamples / (renderTime * 1000000);
+        std::cout << "\nRendered " << totalNumberOfSamples << " samples at " << extent.width << "x" << extent.height << " on the CPU in " << renderTime << " seconds (" << rayRate << " Mr/s).\n";
+        std::cout << "Wrote '" << headlessSettings.m_OutputPath << "'.\n";
+    }
+
+    // Runs every SIMD intersection kernel the processor supports against the single triangle and sphere tests. Returns false if any result differs.
+    bool TestIntersections()
+    {
+        const uint32_t Seed = 42;
+        uint64_t totalMismatchCount = 0;
+
+        std::cout << "Intersection kernel test:\n";
+
+        for (const Math::IntersectionTest::Result& result : Math::IntersectionTest::Run(Seed))
+        {
+            std::cout << "- " << result.m_Case << ", " << result.m_Kernel << ": " << result.m_CheckCount << " checks, " << result.m_MismatchCount << " mismatches.\n";
+            totalMismatchCount += result.m_MismatchCount;
+        }
+
+        std::cout << (totalMismatchCount == 0 ? "Passed.\n" : "Failed.\n");
+        return totalMismatchCount == 0;
+    }
+
+    // Welds a small and a large mesh with the flat weld table and with the std::unordered_map it replaced. Returns false if their vertices or indices differ.
+    bool BenchmarkWeld()
+    {
+        const uint32_t RepetitionCount = 5;
+        const Resources::VertexWelder::Table Tables[] = { Resources::VertexWelder::Table::Flat, Resources::VertexWelder::Table::UnorderedMap };
+        bool isIdentical = true;
+
+        std::cout << "Vertex weld benchmark (best of " << RepetitionCount << "):\n";
+
+        for (const std::string filePath : { "../Assets/Models/cube_multi.obj", "../Assets/Models/lucy.obj" })
+        {
+            if (!std::filesystem::exists(filePath))
+            {
+                std::cout << "- " << filePath << ": not found, skipped.\n";
+                continue;
+            }
+
+            const Importers::ObjImporter::Result model = Importers::ObjImporter::Import(filePath);
+            std::vector<Resources::Vertex> vertices[2];
+            std::vector<uint32_t> indices[2];
+            double times[2] = {};
+
+            for (uint32_t table = 0; table != 2; ++table)
+            {
+                for (uint32_t repetition = 0; repetition != RepetitionCount; ++repetition)
+                {
+                    const std::chrono::high_resolution_clock::time_point weldStart = std::chrono::high_resolution_clock::now();
+                    Resources::VertexWelder::Weld(model, vertices[table], indices[table], Tables[table]);
+                    const double weldTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - weldStart).count();
+
+                    times[table] = repetition == 0 ? weldTime : std::min(times[table], weldTime);
+                }
+            }
+
+            // Compare bytes rather than with Vertex::operator==, which would not tell 0 from -0.
+            const bool isMatch = vertices[0].size() == vertices[1].size() && indices[0] == indices[1] &&
+                                 std::memcmp(vertices[0].data(), vertices[1].data(), vertices[0].size() * sizeof(Resources::Vertex)) == 0;
+            isIdentical = isIdentical && isMatch;
+
+            std::cout << "- " << filePath << " (" << indices[0].size() << " corners, " << vertices[0].size() << " unique vertices): flat table " << times[0] * 1000.0
+                      << " ms, unordered_map " << times[1] * 1000.0 << " ms, " << (isMatch ? "identical output.\n" : "different output.\n");
+        }
+
+        std::cout << (isIdentical ? "Passed.\n" : "Failed.\n");
+        return isIdentical;
+    }
+
+    // Generates normals for a few synthetic meshes with several worker counts and compares them with a serial generator. Returns false if any normal deviates beyond rounding.
+    bool TestNormals()
+    {
+        const uint32_t Seed = 42;
+        uint64_t totalMismatchCount = 0;
+
+        std::cout << "Normal generator test:\n";
+
+        for (const Resources::NormalGeneratorTest::Result& result : Resources::NormalGeneratorTest::Run(Seed))
+        {
+            std::cout << "- " << result.m_Case << ", " << result.m_Weighting << " weighting, " << result.m_WorkerCount << " workers: " << result.m_VertexCount << " vertices, max deviation "
+                      << result.m_MaxDeviation << ", " << result.m_MismatchCount << " mismatches.\n";
+            totalMismatchCount += result.m_MismatchCount;
+        }
+
+        std::cout << (totalMismatchCount == 0 ? "Passed.\n" : "Failed.\n");
+        return totalMismatchCount == 0;
+    }
+
+    // Compares the ray throughput of the CPU hierarchies on a scene of spheres and on one of dense triangle meshes, seen through their initial cameras.
+    void BenchmarkCPUTraversal(UserSettings userSettings, const Vulkan::WindowSettings& windowSettings)
+    {
+        for (const std::string sceneName : { "Ray Tracing In One Weekend", "Lucy In One Weekend" })
+        {
+            const auto scene = std::find_if(SceneList::s_AllScenes.begin(), SceneList::s_AllScenes.end(), [&](const auto& entry) { return entry.first == sceneName; });
+
+            if (scene == SceneList::s_AllScenes.end())
+            {
+                throw std::runtime_error("Cannot find the '" + sceneName + "' scene.");
+            }
+
+            SceneList::CameraInitialState cameraState = {};
+            const SceneAssets assets = scene->second(cameraState);
+            const auto& [models, textures] = assets;
+
+            userSettings.m_FieldOfView = cameraState.m_FieldOfView;
+            userSettings.m_Aperture = cameraState.m_Aperture;
+            userSettings.m_FocusDistance = cameraState.m_FocusDistance;
+
+            const VkExtent2D extent = { windowSettings.m_Width, windowSettings.m_Height };
+            const Resources::UniformBufferObject camera = Raytracer::CreateUniformBufferObject(userSettings, cameraState.m_ModelView, extent, 1, 1);
+
+            std::cout << "\nTraversal benchmark of '" << sceneName << "' at " << extent.width << "x" << extent.height << ":\n";
+
+            for (const CPU::TraversalBenchmark::Result& result : CPU::TraversalBenchmark::Run(models, textures, camera, extent.width, extent.height))
+            {
+                std::cout << "- " << result.m_RayType << " rays, " << result.m_Hierarchy << ": " << result.m_RayRate << " Mrays/s (" << result.m_RayCount << " rays in " << result.m_Time << " seconds, "
+                          << result.m_MismatchCount << " mismatches).\n";
+            }
+        }
+    }
 }
 
 
-int main(int argc, int argv[])
+int main(int argc, char* argv[])
 {
-    const Vulkan::WindowSettings windowSettings
+    Vulkan::WindowSettings windowSettings
     {
         "Ithildin - NVIDIA RTX Raytracing (x64 Vulkan) by Ryan Tan",   // Title
         1280,                                   // Width
@@ -54,11 +371,48 @@ int main(int argc, int argv[])
     /// Set Device
     /// Print Swapchain Information
     /// Run
-    const UserSettings userSettings = LaunchUtilities::CreateUserSettings();
+    UserSettings userSettings = LaunchUtilities::CreateUserSettings();
+    const LaunchUtilities::HeadlessSettings headlessSettings = LaunchUtilities::ParseCommandLine(argc, argv, windowSettings, userSettings);
+
+    if (headlessSettings.m_TestIntersections)
+    {
+        return LaunchUtilities::TestIntersections() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (headlessSettings.m_BenchmarkWeld)
+    {
+        return LaunchUtilities::BenchmarkWeld() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (headlessSettings.m_TestNormals)
+    {
+        return LaunchUtilities::TestNormals() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (headlessSettings.m_BenchmarkTraversal)
+    {
+        LaunchUtilities::BenchmarkCPUTraversal(userSettings, windowSettings);
+        return EXIT_SUCCESS;
+    }
+
+    if (headlessSettings.m_UseCPU)
+    {
+        LaunchUtilities::RenderOnCPU(userSettings, windowSettings, headlessSettings);
+        return EXIT_SUCCESS;
+    }
 
     Raytracer application(userSettings, windowSettings, VkPresentModeKHR::VK_PRESENT_MODE_IMMEDIATE_KHR); // We will present presents as soon as they're avaliable.
     SetVulkanDevice(application);
-    application.OnUpdate();
+
+    // Headless runs render a fixed number of samples to an image file instead of opening a window.
+    if (headlessSettings.m_IsEnabled)
+    {
+        application.RenderOffscreen(headlessSettings.m_SampleCount, headlessSettings.m_OutputPath);
+    }
+    else
+    {
+        application.OnUpdate();
+    }
 
     return EXIT_SUCCESS;
 }
@@ -116,4 +470,3 @@ void SetVulkanDevice(Vulkan::Application& application)
 
     application.SetPhysicalDevice(*result);
 }
-
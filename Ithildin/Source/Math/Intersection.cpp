@@ -0,0 +1,336 @@
+#include "Intersection.h"
+#include "Core/ProcessorFeatures.h"
+#include <algorithm>
+
+#if PROCESSOR_X86
+#include <immintrin.h>
+#endif
+
+namespace Math
+{
+    namespace IntersectionUtilities
+    {
+        // Lane results of a block test, reduced to the nearest hit afterwards.
+        template<uint32_t Width>
+        struct alignas(32) LaneHits
+        {
+            float m_Distances[Width];
+            float m_BarycentricsX[Width];
+            float m_BarycentricsY[Width];
+        };
+
+        // Every lane in the mask has been hit before hit.m_Distance. Taking them in order and keeping only closer ones is what testing the lanes one after the
+        // other does, so the lowest of equally near lanes wins.
+        template<uint32_t Width>
+        bool SelectNearest(uint32_t mask, const LaneHits<Width>& laneHits, BlockHit& hit)
+        {
+            bool isHit = false;
+
+            while (mask != 0)
+            {
+                const uint32_t i = FindFirstSetBit(mask);
+                mask &= mask - 1;
+
+                if (laneHits.m_Distances[i] < hit.m_Distance)
+                {
+                    hit = { laneHits.m_Distances[i], i, glm::vec2(laneHits.m_BarycentricsX[i], laneHits.m_BarycentricsY[i]) };
+                    isHit = true;
+                }
+            }
+
+            return isHit;
+        }
+
+        template<uint32_t Width>
+        bool IntersectTrianglesScalar(const TriangleBlock<Width>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, BlockHit& hit)
+        {
+            bool isHit = false;
+
+            for (uint32_t i = 0; i != Width; ++i)
+            {
+                const glm::vec3 vertex0(block.m_Vertex0X[i], block.m_Vertex0Y[i], block.m_Vertex0Z[i]);
+                const glm::vec3 edge1(block.m_Edge1X[i], block.m_Edge1Y[i], block.m_Edge1Z[i]);
+                const glm::vec3 edge2(block.m_Edge2X[i], block.m_Edge2Y[i], block.m_Edge2Z[i]);
+
+                if (IntersectTriangle(origin, direction, vertex0, edge1, edge2, tMin, hit.m_Distance, hit.m_Distance, hit.m_Barycentrics))
+                {
+                    hit.m_Lane = i;
+                    isHit = true;
+                }
+            }
+
+            return isHit;
+        }
+
+        template<uint32_t Width>
+        bool IntersectSpheresScalar(const SphereBlock<Width>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, BlockHit& hit)
+        {
+            bool isHit = false;
+
+            for (uint32_t i = 0; i != Width; ++i)
+            {
+                const glm::vec3 center(block.m_CenterX[i], block.m_CenterY[i], block.m_CenterZ[i]);
+
+                if (IntersectSphere(origin, direction, center, block.m_Radius[i], tMin, hit.m_Distance, hit.m_Distance))
+                {
+                    hit.m_Lane = i;
+                    hit.m_Barycentrics = glm::vec2(0.0f);
+                    isHit = true;
+                }
+            }
+
+            return isHit;
+        }
+
+#if PROCESSOR_X86
+        // The vector kernels repeat the scalar operations in the same order and without fused multiply-adds, so they round identically. Comparisons are
+        // ordered, a NaN fails them like it fails the scalar ones.
+
+        // Lanes [offset, offset + 4) of the block. Returns the mask of lanes hit within [tMin, tMax) and writes their results from lane 0 on.
+        template<uint32_t Width>
+        TARGET_SSE41 uint32_t IntersectTrianglesSSE41(const TriangleBlock<Width>& block, uint32_t offset, const glm::vec3& origin, const glm::vec3& direction,
+            float tMin, float tMax, float* distances, float* barycentricsX, float* barycentricsY)
+        {
+            const __m128 directionX = _mm_set1_ps(direction.x);
+            const __m128 directionY = _mm_set1_ps(direction.y);
+            const __m128 directionZ = _mm_set1_ps(direction.z);
+            const __m128 edge1X = _mm_load_ps(block.m_Edge1X + offset);
+            const __m128 edge1Y = _mm_load_ps(block.m_Edge1Y + offset);
+            const __m128 edge1Z = _mm_load_ps(block.m_Edge1Z + offset);
+            const __m128 edge2X = _mm_load_ps(block.m_Edge2X + offset);
+            const __m128 edge2Y = _mm_load_ps(block.m_Edge2Y + offset);
+            const __m128 edge2Z = _mm_load_ps(block.m_Edge2Z + offset);
+
+            const __m128 pX = _mm_sub_ps(_mm_mul_ps(directionY, edge2Z), _mm_mul_ps(edge2Y, directionZ));
+            const __m128 pY = _mm_sub_ps(_mm_mul_ps(directionZ, edge2X), _mm_mul_ps(edge2Z, directionX));
+            const __m128 pZ = _mm_sub_ps(_mm_mul_ps(directionX, edge2Y), _mm_mul_ps(edge2X, directionY));
+            const __m128 determinant = _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge1X, pX), _mm_mul_ps(edge1Y, pY)), _mm_mul_ps(edge1Z, pZ));
+            const __m128 inverseDeterminant = _mm_div_ps(_mm_set1_ps(1.0f), determinant);
+
+            const __m128 sX = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_load_ps(block.m_Vertex0X + offset));
+            const __m128 sY = _mm_sub_ps(_mm_set1_ps(origin.y), _mm_load_ps(block.m_Vertex0Y + offset));
+            const __m128 sZ = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_load_ps(block.m_Vertex0Z + offset));
+            const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sX, pX), _mm_mul_ps(sY, pY)), _mm_mul_ps(sZ, pZ)), inverseDeterminant);
+
+            const __m128 qX = _mm_sub_ps(_mm_mul_ps(sY, edge1Z), _mm_mul_ps(edge1Y, sZ));
+            const __m128 qY = _mm_sub_ps(_mm_mul_ps(sZ, edge1X), _mm_mul_ps(edge1Z, sX));
+            const __m128 qZ = _mm_sub_ps(_mm_mul_ps(sX, edge1Y), _mm_mul_ps(edge1X, sY));
+            const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, qX), _mm_mul_ps(directionY, qY)), _mm_mul_ps(directionZ, qZ)), inverseDeterminant);
+            const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(edge2X, qX), _mm_mul_ps(edge2Y, qY)), _mm_mul_ps(edge2Z, qZ)), inverseDeterminant);
+
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 one = _mm_set1_ps(1.0f);
+            __m128 isHit = _mm_cmpneq_ps(determinant, zero);
+            isHit = _mm_and_ps(isHit, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmple_ps(u, one)));
+            isHit = _mm_and_ps(isHit, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmple_ps(_mm_add_ps(u, v), one)));
+            isHit = _mm_and_ps(isHit, _mm_and_ps(_mm_cmpge_ps(t, _mm_set1_ps(tMin)), _mm_cmplt_ps(t, _mm_set1_ps(tMax))));
+
+            _mm_storeu_ps(distances, t);
+            _mm_storeu_ps(barycentricsX, u);
+            _mm_storeu_ps(barycentricsY, v);
+            return static_cast<uint32_t>(_mm_movemask_ps(isHit));
+        }
+
+        template<uint32_t Width>
+        TARGET_SSE41 uint32_t IntersectSpheresSSE41(const SphereBlock<Width>& block, uint32_t offset, const glm::vec3& origin, const glm::vec3& direction,
+            float tMin, float tMax, float* distances)
+        {
+            const __m128 directionX = _mm_set1_ps(direction.x);
+            const __m128 directionY = _mm_set1_ps(direction.y);
+            const __m128 directionZ = _mm_set1_ps(direction.z);
+            const __m128 ocX = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_load_ps(block.m_CenterX + offset));
+            const __m128 ocY = _mm_sub_ps(_mm_set1_ps(origin.y), _mm_load_ps(block.m_CenterY + offset));
+            const __m128 ocZ = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_load_ps(block.m_CenterZ + offset));
+            const __m128 radius = _mm_load_ps(block.m_Radius + offset);
+
+            const __m128 a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(directionX, directionX), _mm_mul_ps(directionY, directionY)), _mm_mul_ps(directionZ, directionZ));
+            const __m128 b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ocX, directionX), _mm_mul_ps(ocY, directionY)), _mm_mul_ps(ocZ, directionZ));
+            const __m128 c = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(ocX, ocX), _mm_mul_ps(ocY, ocY)), _mm_mul_ps(ocZ, ocZ)), _mm_mul_ps(radius, radius));
+            const __m128 discriminant = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+
+            const __m128 root = _mm_sqrt_ps(discriminant);
+            const __m128 negativeB = _mm_xor_ps(b, _mm_set1_ps(-0.0f));
+            const __m128 t1 = _mm_div_ps(_mm_sub_ps(negativeB, root), a);
+            const __m128 t2 = _mm_div_ps(_mm_add_ps(negativeB, root), a);
+
+            const __m128 minimum = _mm_set1_ps(tMin);
+            const __m128 maximum = _mm_set1_ps(tMax);
+            const __m128 isFirstInRange = _mm_and_ps(_mm_cmple_ps(minimum, t1), _mm_cmplt_ps(t1, maximum));
+            const __m128 isSecondInRange = _mm_and_ps(_mm_cmple_ps(minimum, t2), _mm_cmplt_ps(t2, maximum));
+            const __m128 isHit = _mm_andnot_ps(_mm_cmplt_ps(discriminant, _mm_setzero_ps()), _mm_or_ps(isFirstInRange, isSecondInRange));
+
+            _mm_storeu_ps(distances, _mm_blendv_ps(t2, t1, isFirstInRange));
+            return static_cast<uint32_t>(_mm_movemask_ps(isHit));
+        }
+
+        TARGET_AVX2 uint32_t IntersectTrianglesAVX2(const TriangleBlock<8>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax,
+            LaneHits<8>& laneHits)
+        {
+            const __m256 directionX = _mm256_set1_ps(direction.x);
+            const __m256 directionY = _mm256_set1_ps(direction.y);
+            const __m256 directionZ = _mm256_set1_ps(direction.z);
+            const __m256 edge1X = _mm256_load_ps(block.m_Edge1X);
+            const __m256 edge1Y = _mm256_load_ps(block.m_Edge1Y);
+            const __m256 edge1Z = _mm256_load_ps(block.m_Edge1Z);
+            const __m256 edge2X = _mm256_load_ps(block.m_Edge2X);
+            const __m256 edge2Y = _mm256_load_ps(block.m_Edge2Y);
+            const __m256 edge2Z = _mm256_load_ps(block.m_Edge2Z);
+
+            const __m256 pX = _mm256_sub_ps(_mm256_mul_ps(directionY, edge2Z), _mm256_mul_ps(edge2Y, directionZ));
+            const __m256 pY = _mm256_sub_ps(_mm256_mul_ps(directionZ, edge2X), _mm256_mul_ps(edge2Z, directionX));
+            const __m256 pZ = _mm256_sub_ps(_mm256_mul_ps(directionX, edge2Y), _mm256_mul_ps(edge2X, directionY));
+            const __m256 determinant = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(edge1X, pX), _mm256_mul_ps(edge1Y, pY)), _mm256_mul_ps(edge1Z, pZ));
+            const __m256 inverseDeterminant = _mm256_div_ps(_mm256_set1_ps(1.0f), determinant);
+
+            const __m256 sX = _mm256_sub_ps(_mm256_set1_ps(origin.x), _mm256_load_ps(block.m_Vertex0X));
+            const __m256 sY = _mm256_sub_ps(_mm256_set1_ps(origin.y), _mm256_load_ps(block.m_Vertex0Y));
+            const __m256 sZ = _mm256_sub_ps(_mm256_set1_ps(origin.z), _mm256_load_ps(block.m_Vertex0Z));
+            const __m256 u = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(sX, pX), _mm256_mul_ps(sY, pY)), _mm256_mul_ps(sZ, pZ)), inverseDeterminant);
+
+            const __m256 qX = _mm256_sub_ps(_mm256_mul_ps(sY, edge1Z), _mm256_mul_ps(edge1Y, sZ));
+            const __m256 qY = _mm256_sub_ps(_mm256_mul_ps(sZ, edge1X), _mm256_mul_ps(edge1Z, sX));
+            const __m256 qZ = _mm256_sub_ps(_mm256_mul_ps(sX, edge1Y), _mm256_mul_ps(edge1X, sY));
+            const __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(directionX, qX), _mm256_mul_ps(directionY, qY)), _mm256_mul_ps(directionZ, qZ)), inverseDeterminant);
+            const __m256 t = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(edge2X, qX), _mm256_mul_ps(edge2Y, qY)), _mm256_mul_ps(edge2Z, qZ)), inverseDeterminant);
+
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.0f);
+            __m256 isHit = _mm256_cmp_ps(determinant, zero, _CMP_NEQ_UQ);
+            isHit = _mm256_and_ps(isHit, _mm256_and_ps(_mm256_cmp_ps(u, zero, _CMP_GE_OQ), _mm256_cmp_ps(u, one, _CMP_LE_OQ)));
+            isHit = _mm256_and_ps(isHit, _mm256_and_ps(_mm256_cmp_ps(v, zero, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_add_ps(u, v), one, _CMP_LE_OQ)));
+            isHit = _mm256_and_ps(isHit, _mm256_and_ps(_mm256_cmp_ps(t, _mm256_set1_ps(tMin), _CMP_GE_OQ), _mm256_cmp_ps(t, _mm256_set1_ps(tMax), _CMP_LT_OQ)));
+
+            _mm256_store_ps(laneHits.m_Distances, t);
+            _mm256_store_ps(laneHits.m_BarycentricsX, u);
+            _mm256_store_ps(laneHits.m_BarycentricsY, v);
+            return static_cast<uint32_t>(_mm256_movemask_ps(isHit));
+        }
+
+        TARGET_AVX2 uint32_t IntersectSpheresAVX2(const SphereBlock<8>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax,
+            LaneHits<8>& laneHits)
+        {
+            const __m256 directionX = _mm256_set1_ps(direction.x);
+            const __m256 directionY = _mm256_set1_ps(direction.y);
+            const __m256 directionZ = _mm256_set1_ps(direction.z);
+            const __m256 ocX = _mm256_sub_ps(_mm256_set1_ps(origin.x), _mm256_load_ps(block.m_CenterX));
+            const __m256 ocY = _mm256_sub_ps(_mm256_set1_ps(origin.y), _mm256_load_ps(block.m_CenterY));
+            const __m256 ocZ = _mm256_sub_ps(_mm256_set1_ps(origin.z), _mm256_load_ps(block.m_CenterZ));
+            const __m256 radius = _mm256_load_ps(block.m_Radius);
+
+            const __m256 a = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(directionX, directionX), _mm256_mul_ps(directionY, directionY)), _mm256_mul_ps(directionZ, directionZ));
+            const __m256 b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocX, directionX), _mm256_mul_ps(ocY, directionY)), _mm256_mul_ps(ocZ, directionZ));
+            const __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ocX, ocX), _mm256_mul_ps(ocY, ocY)), _mm256_mul_ps(ocZ, ocZ)), _mm256_mul_ps(radius, radius));
+            const __m256 discriminant = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, c));
+
+            const __m256 root = _mm256_sqrt_ps(discriminant);
+            const __m256 negativeB = _mm256_xor_ps(b, _mm256_set1_ps(-0.0f));
+            const __m256 t1 = _mm256_div_ps(_mm256_sub_ps(negativeB, root), a);
+            const __m256 t2 = _mm256_div_ps(_mm256_add_ps(negativeB, root), a);
+
+            const __m256 minimum = _mm256_set1_ps(tMin);
+            const __m256 maximum = _mm256_set1_ps(tMax);
+            const __m256 isFirstInRange = _mm256_and_ps(_mm256_cmp_ps(minimum, t1, _CMP_LE_OQ), _mm256_cmp_ps(t1, maximum, _CMP_LT_OQ));
+            const __m256 isSecondInRange = _mm256_and_ps(_mm256_cmp_ps(minimum, t2, _CMP_LE_OQ), _mm256_cmp_ps(t2, maximum, _CMP_LT_OQ));
+            const __m256 isHit = _mm256_andnot_ps(_mm256_cmp_ps(discriminant, _mm256_setzero_ps(), _CMP_LT_OQ), _mm256_or_ps(isFirstInRange, isSecondInRange));
+
+            _mm256_store_ps(laneHits.m_Distances, _mm256_blendv_ps(t2, t1, isFirstInRange));
+            _mm256_store_ps(laneHits.m_BarycentricsX, _mm256_setzero_ps());
+            _mm256_store_ps(laneHits.m_BarycentricsY, _mm256_setzero_ps());
+            return static_cast<uint32_t>(_mm256_movemask_ps(isHit));
+        }
+
+        // 4 wide blocks take the SSE4.1 kernel for AVX2 too.
+        uint32_t IntersectTrianglesVectorized(const TriangleBlock<4>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax,
+            IntersectionKernel, LaneHits<4>& laneHits)
+        {
+            return IntersectTrianglesSSE41(block, 0, origin, direction, tMin, tMax, laneHits.m_Distances, laneHits.m_BarycentricsX, laneHits.m_BarycentricsY);
+        }
+
+        uint32_t IntersectTrianglesVectorized(const TriangleBlock<8>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax,
+            IntersectionKernel kernel, LaneHits<8>& laneHits)
+        {
+            if (kernel == IntersectionKernel::AVX2)
+            {
+                return IntersectTrianglesAVX2(block, origin, direction, tMin, tMax, laneHits);
+            }
+
+            const uint32_t lowerMask = IntersectTrianglesSSE41(block, 0, origin, direction, tMin, tMax, laneHits.m_Distances, laneHits.m_BarycentricsX, laneHits.m_BarycentricsY);
+            const uint32_t upperMask = IntersectTrianglesSSE41(block, 4, origin, direction, tMin, tMax, laneHits.m_Distances + 4, laneHits.m_BarycentricsX + 4, laneHits.m_BarycentricsY + 4);
+            return lowerMask | upperMask << 4;
+        }
+
+        uint32_t IntersectSpheresVectorized(const SphereBlock<4>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax,
+            IntersectionKernel, LaneHits<4>& laneHits)
+        {
+            std::fill_n(laneHits.m_BarycentricsX, 4, 0.0f);
+            std::fill_n(laneHits.m_BarycentricsY, 4, 0.0f);
+            return IntersectSpheresSSE41(block, 0, origin, direction, tMin, tMax, laneHits.m_Distances);
+        }
+
+        uint32_t IntersectSpheresVectorized(const SphereBlock<8>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax,
+            IntersectionKernel kernel, LaneHits<8>& laneHits)
+        {
+            if (kernel == IntersectionKernel::AVX2)
+            {
+                return IntersectSpheresAVX2(block, origin, direction, tMin, tMax, laneHits);
+            }
+
+            std::fill_n(laneHits.m_BarycentricsX, 8, 0.0f);
+            std::fill_n(laneHits.m_BarycentricsY, 8, 0.0f);
+            const uint32_t lowerMask = IntersectSpheresSSE41(block, 0, origin, direction, tMin, tMax, laneHits.m_Distances);
+            const uint32_t upperMask = IntersectSpheresSSE41(block, 4, origin, direction, tMin, tMax, laneHits.m_Distances + 4);
+            return lowerMask | upperMask << 4;
+        }
+#endif
+    }
+
+    IntersectionKernel GetIntersectionKernel()
+    {
+        static const IntersectionKernel kernel = []()
+        {
+            const ProcessorFeatures& features = ProcessorFeatures::Get();
+            return features.m_HasAVX2 ? IntersectionKernel::AVX2 : features.m_HasSSE41 ? IntersectionKernel::SSE41 : IntersectionKernel::Scalar;
+        }();
+
+        return kernel;
+    }
+
+    template<uint32_t Width>
+    bool IntersectTriangles(const TriangleBlock<Width>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, BlockHit& hit, IntersectionKernel kernel)
+    {
+        using namespace IntersectionUtilities;
+
+#if PROCESSOR_X86
+        if (kernel != IntersectionKernel::Scalar)
+        {
+            LaneHits<Width> laneHits;
+            const uint32_t mask = IntersectTrianglesVectorized(block, origin, direction, tMin, hit.m_Distance, kernel, laneHits);
+            return SelectNearest(mask, laneHits, hit);
+        }
+#endif
+
+        return IntersectTrianglesScalar(block, origin, direction, tMin, hit);
+    }
+
+    template<uint32_t Width>
+    bool IntersectSpheres(const SphereBlock<Width>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, BlockHit& hit, IntersectionKernel kernel)
+    {
+        using namespace IntersectionUtilities;
+
+#if PROCESSOR_X86
+        if (kernel != IntersectionKernel::Scalar)
+        {
+            LaneHits<Width> laneHits;
+            const uint32_t mask = IntersectSpheresVectorized(block, origin, direction, tMin, hit.m_Distance, kernel, laneHits);
+            return SelectNearest(mask, laneHits, hit);
+        }
+#endif
+
+        return IntersectSpheresScalar(block, origin, direction, tMin, hit);
+    }
+
+    template bool IntersectTriangles<4>(const TriangleBlock<4>&, const glm::vec3&, const glm::vec3&, float, BlockHit&, IntersectionKernel);
+    template bool IntersectTriangles<8>(const TriangleBlock<8>&, const glm::vec3&, const glm::vec3&, float, BlockHit&, IntersectionKernel);
+    template bool IntersectSpheres<4>(const SphereBlock<4>&, const glm::vec3&, const glm::vec3&, float, BlockHit&, IntersectionKernel);
+    template bool IntersectSpheres<8>(const SphereBlock<8>&, const glm::vec3&, const glm::vec3&, float, BlockHit&, IntersectionKernel);
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+#include "Math.h"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace Math
+{
+    // Ray intersection tests shared by the CPU renderer and tools. Rays are given by an origin and a direction that is not necessarily normalized,
+    // distances are measured in multiples of the direction's length like traceRayEXT() does.
+
+    // Moller-Trumbore, without backface culling. The triangle is given by its first vertex and the edges to the other two. Writes the distance and the
+    // weights of the second and third vertices if the triangle is hit within [tMin, tMax). The bounds are inclusive on all edges and a NaN fails them.
+    inline bool IntersectTriangle(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& vertex0, const glm::vec3& edge1, const glm::vec3& edge2,
+        float tMin, float tMax, float& distance, glm::vec2& barycentrics)
+    {
+        const glm::vec3 p = glm::cross(direction, edge2);
+        const float determinant = glm::dot(edge1, p);
+
+        if (determinant == 0.0f)
+        {
+            return false;
+        }
+
+        const float inverseDeterminant = 1.0f / determinant;
+        const glm::vec3 s = origin - vertex0;
+        const float u = glm::dot(s, p) * inverseDeterminant;
+
+        if (!(u >= 0.0f && u <= 1.0f))
+        {
+            return false;
+        }
+
+        const glm::vec3 q = glm::cross(s, edge1);
+        const float v = glm::dot(direction, q) * inverseDeterminant;
+
+        if (!(v >= 0.0f && u + v <= 1.0f))
+        {
+            return false;
+        }
+
+        const float t = glm::dot(edge2, q) * inverseDeterminant;
+
+        if (!(t >= tMin && t < tMax))
+        {
+            return false;
+        }
+
+        distance = t;
+        barycentrics = glm::vec2(u, v);
+        return true;
+    }
+
+    // Same quadratic as the procedural intersection shader. Writes the nearest distance at which the sphere is entered or left within [tMin, tMax).
+    inline bool IntersectSphere(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& center, float radius, float tMin, float tMax, float& distance)
+    {
+        const glm::vec3 oc = origin - center;
+        const float a = glm::dot(direction, direction);
+        const float b = glm::dot(oc, direction);
+        const float c = glm::dot(oc, oc) - radius * radius;
+        const float discriminant = b * b - a * c;
+
+        if (discriminant < 0.0f)
+        {
+            return false;
+        }
+
+        const float t1 = (-b - std::sqrt(discriminant)) / a;
+        const float t2 = (-b + std::sqrt(discriminant)) / a;
+        const bool isFirstInRange = tMin <= t1 && t1 < tMax;
+
+        if (!isFirstInRange && !(tMin <= t2 && t2 < tMax))
+        {
+            return false;
+        }
+
+        distance = isFirstInRange ? t1 : t2;
+        return true;
+    }
+
+    // Up to Width triangles as a structure of arrays, so one ray is tested against all of them with a single set of SIMD instructions.
+    // Unused lanes have zero edges, their determinant is 0 and no ray hits them.
+    template<uint32_t Width>
+    struct alignas(32) TriangleBlock
+    {
+        float m_Vertex0X[Width] = {};
+        float m_Vertex0Y[Width] = {};
+        float m_Vertex0Z[Width] = {};
+        float m_Edge1X[Width] = {};
+        float m_Edge1Y[Width] = {};
+        float m_Edge1Z[Width] = {};
+        float m_Edge2X[Width] = {};
+        float m_Edge2Y[Width] = {};
+        float m_Edge2Z[Width] = {};
+
+        void Set(uint32_t lane, const glm::vec3& vertex0, const glm::vec3& edge1, const glm::vec3& edge2)
+        {
+            m_Vertex0X[lane] = vertex0.x;
+            m_Vertex0Y[lane] = vertex0.y;
+            m_Vertex0Z[lane] = vertex0.z;
+            m_Edge1X[lane] = edge1.x;
+            m_Edge1Y[lane] = edge1.y;
+            m_Edge1Z[lane] = edge1.z;
+            m_Edge2X[lane] = edge2.x;
+            m_Edge2Y[lane] = edge2.y;
+            m_Edge2Z[lane] = edge2.z;
+        }
+    };
+
+    // Unused lanes have a NaN radius, which no comparison accepts.
+    template<uint32_t Width>
+    struct alignas(32) SphereBlock
+    {
+        float m_CenterX[Width] = {};
+        float m_CenterY[Width] = {};
+        float m_CenterZ[Width] = {};
+        float m_Radius[Width];
+
+        SphereBlock()
+        {
+            for (float& radius : m_Radius)
+            {
+                radius = std::numeric_limits<float>::quiet_NaN();
+            }
+        }
+
+        void Set(uint32_t lane, const glm::vec3& center, float radius)
+        {
+            m_CenterX[lane] = center.x;
+            m_CenterY[lane] = center.y;
+            m_CenterZ[lane] = center.z;
+            m_Radius[lane] = radius;
+        }
+    };
+
+    struct BlockHit
+    {
+        float m_Distance;
+        uint32_t m_Lane;
+        glm::vec2 m_Barycentrics; // Zero for spheres.
+    };
+
+    // Instruction sets of the block tests. 8 wide blocks are tested as two halves by the SSE4.1 kernel, 4 wide blocks take the SSE4.1 one for AVX2.
+    enum class IntersectionKernel
+    {
+        Scalar,
+        SSE41,
+        AVX2
+    };
+
+    // The widest kernel the processor supports, queried once.
+    IntersectionKernel GetIntersectionKernel();
+
+    // Replace the hit with the nearest lane intersected within [tMin, hit.m_Distance). The results are bit for bit those of the single triangle and
+    // sphere tests applied to each lane in order, so ties go to the lowest lane. The kernel must be supported by the processor.
+    template<uint32_t Width>
+    bool IntersectTriangles(const TriangleBlock<Width>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, BlockHit& hit, IntersectionKernel kernel);
+
+    template<uint32_t Width>
+    bool IntersectSpheres(const SphereBlock<Width>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, BlockHit& hit, IntersectionKernel kernel);
+
+    extern template bool IntersectTriangles<4>(const TriangleBlock<4>&, const glm::vec3&, const glm::vec3&, float, BlockHit&, IntersectionKernel);
+    extern template bool IntersectTriangles<8>(const TriangleBlock<8>&, const glm::vec3&, const glm::vec3&, float, BlockHit&, IntersectionKernel);
+    extern template bool IntersectSpheres<4>(const SphereBlock<4>&, const glm::vec3&, const glm::vec3&, float, BlockHit&, IntersectionKernel);
+    extern template bool IntersectSpheres<8>(const SphereBlock<8>&, const glm::vec3&, const glm::vec3&, float, BlockHit&, IntersectionKernel);
+}
\ No newline at end of file
@@ -0,0 +1,408 @@
+#include "IntersectionTest.h"
+#include "Intersection.h"
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <random>
+
+namespace Math
+{
+    namespace IntersectionTestUtilities
+    {
+        const uint32_t RandomBlockCount = 100000;
+        const uint32_t TieBlockCount = 10000;
+        const uint32_t SpecialValueBlockCount = 5000;
+        const uint32_t MeshCount = 100;
+        const uint32_t RaysPerMeshPoint = 16;
+
+        // The distances the path tracer traces with.
+        const float MinimumDistance = 0.001f;
+        const float MaximumDistance = 10000.0f;
+
+        const char* GetKernelName(IntersectionKernel kernel)
+        {
+            switch (kernel)
+            {
+            case IntersectionKernel::SSE41: return "SSE4.1";
+            case IntersectionKernel::AVX2: return "AVX2";
+            default: return "Scalar";
+            }
+        }
+
+        // Distances are compared bit for bit, so a kernel that flips the sign of a zero or rounds differently is caught. Any two NaNs are the same.
+        bool IsSame(float a, float b)
+        {
+            return std::memcmp(&a, &b, sizeof(float)) == 0 || (std::isnan(a) && std::isnan(b));
+        }
+
+        bool IsSame(const BlockHit& a, const BlockHit& b)
+        {
+            return IsSame(a.m_Distance, b.m_Distance) && a.m_Lane == b.m_Lane && IsSame(a.m_Barycentrics.x, b.m_Barycentrics.x) && IsSame(a.m_Barycentrics.y, b.m_Barycentrics.y);
+        }
+
+        class Generator final
+        {
+        public:
+            explicit Generator(uint32_t seed) : m_Engine(seed) { }
+
+            float Uniform(float minimum, float maximum) { return std::uniform_real_distribution<float>(minimum, maximum)(m_Engine); }
+            uint32_t Index(uint32_t count) { return std::uniform_int_distribution<uint32_t>(0, count - 1)(m_Engine); }
+            glm::vec3 Vector(float extent) { return glm::vec3(Uniform(-extent, extent), Uniform(-extent, extent), Uniform(-extent, extent)); }
+
+            // Mostly the path tracer's range, sometimes a random one so hits beyond tMax and before tMin are exercised.
+            float MinimumDistance(uint32_t iteration) { return iteration % 7 == 0 ? Uniform(0.0f, 2.0f) : IntersectionTestUtilities::MinimumDistance; }
+            float MaximumDistance(uint32_t iteration) { return iteration % 5 == 0 ? Uniform(0.1f, 3.0f) : IntersectionTestUtilities::MaximumDistance; }
+
+            float SpecialValue()
+            {
+                const float values[] = { INFINITY, -INFINITY, NAN, 0.0f, -0.0f, 1e-40f, 1e30f, -1e30f };
+                return values[Index(static_cast<uint32_t>(std::size(values)))];
+            }
+
+        private:
+            std::mt19937 m_Engine;
+        };
+
+        // Runs one ray against a block with every kernel and counts the results that differ from testing the lanes one after the other.
+        class Checker final
+        {
+        public:
+            Checker(std::vector<IntersectionTest::Result>& results, const std::vector<IntersectionKernel>& kernels, const std::string& testCase)
+                : m_Results(results), m_Kernels(kernels), m_FirstResult(results.size())
+            {
+                for (const IntersectionKernel kernel : kernels)
+                {
+                    IntersectionTest::Result result = {};
+                    result.m_Case = testCase;
+                    result.m_Kernel = GetKernelName(kernel);
+                    m_Results.push_back(result);
+                }
+            }
+
+            template<uint32_t Width>
+            void CheckTriangles(const TriangleBlock<Width>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax)
+            {
+                BlockHit expectedHit = { tMax, ~0u, glm::vec2(-1.0f) };
+                bool isExpectedHit = false;
+
+                for (uint32_t i = 0; i != Width; ++i)
+                {
+                    const glm::vec3 vertex0(block.m_Vertex0X[i], block.m_Vertex0Y[i], block.m_Vertex0Z[i]);
+                    const glm::vec3 edge1(block.m_Edge1X[i], block.m_Edge1Y[i], block.m_Edge1Z[i]);
+                    const glm::vec3 edge2(block.m_Edge2X[i], block.m_Edge2Y[i], block.m_Edge2Z[i]);
+                    float distance;
+                    glm::vec2 barycentrics;
+
+                    if (IntersectTriangle(origin, direction, vertex0, edge1, edge2, tMin, expectedHit.m_Distance, distance, barycentrics))
+                    {
+                        expectedHit = { distance, i, barycentrics };
+                        isExpectedHit = true;
+                    }
+                }
+
+                for (size_t k = 0; k != m_Kernels.size(); ++k)
+                {
+                    BlockHit hit = { tMax, ~0u, glm::vec2(-1.0f) };
+                    const bool isHit = IntersectTriangles(block, origin, direction, tMin, hit, m_Kernels[k]);
+                    Record(k, isHit == isExpectedHit && IsSame(hit, expectedHit));
+                }
+            }
+
+            template<uint32_t Width>
+            void CheckSpheres(const SphereBlock<Width>& block, const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax)
+            {
+                BlockHit expectedHit = { tMax, ~0u, glm::vec2(-1.0f) };
+                bool isExpectedHit = false;
+
+                for (uint32_t i = 0; i != Width; ++i)
+                {
+                    const glm::vec3 center(block.m_CenterX[i], block.m_CenterY[i], block.m_CenterZ[i]);
+                    float distance;
+
+                    if (IntersectSphere(origin, direction, center, block.m_Radius[i], tMin, expectedHit.m_Distance, distance))
+                    {
+                        expectedHit = { distance, i, glm::vec2(0.0f) };
+                        isExpectedHit = true;
+                    }
+                }
+
+                for (size_t k = 0; k != m_Kernels.size(); ++k)
+                {
+                    BlockHit hit = { tMax, ~0u, glm::vec2(-1.0f) };
+                    const bool isHit = IntersectSpheres(block, origin, direction, tMin, hit, m_Kernels[k]);
+                    Record(k, isHit == isExpectedHit && IsSame(hit, expectedHit));
+                }
+            }
+
+        private:
+            void Record(size_t kernelIndex, bool isMatch)
+            {
+                IntersectionTest::Result& result = m_Results[m_FirstResult + kernelIndex];
+                result.m_CheckCount++;
+                result.m_MismatchCount += isMatch ? 0 : 1;
+            }
+
+            std::vector<IntersectionTest::Result>& m_Results;
+            const std::vector<IntersectionKernel>& m_Kernels;
+            const size_t m_FirstResult;
+        };
+
+        // Rays aimed at points inside the triangles, or anywhere near them.
+        template<uint32_t Width>
+        void CheckRandomTriangles(Generator& generator, Checker& checker)
+        {
+            for (uint32_t iteration = 0; iteration != RandomBlockCount; ++iteration)
+            {
+                TriangleBlock<Width> block;
+                const uint32_t laneCount = 1 + generator.Index(Width);
+                std::array<glm::vec3, Width> insidePoints;
+
+                for (uint32_t lane = 0; lane != laneCount; ++lane)
+                {
+                    const glm::vec3 vertex0 = generator.Vector(5.0f);
+                    const glm::vec3 edge1 = generator.Vector(2.0f);
+                    const glm::vec3 edge2 = generator.Vector(2.0f);
+
+                    block.Set(lane, vertex0, edge1, edge2);
+                    insidePoints[lane] = vertex0 + edge1 * generator.Uniform(0.0f, 0.5f) + edge2 * generator.Uniform(0.0f, 0.5f);
+                }
+
+                const glm::vec3 origin = generator.Vector(10.0f);
+                const glm::vec3 target = iteration % 2 == 0 ? insidePoints[generator.Index(laneCount)] : generator.Vector(5.0f);
+                const glm::vec3 direction = (target - origin) * generator.Uniform(0.1f, 3.0f);
+
+                checker.CheckTriangles(block, origin, direction, generator.MinimumDistance(iteration), generator.MaximumDistance(iteration));
+            }
+        }
+
+        // Identical lanes must resolve to the lowest one. Every third lane is collinear, and some rays run parallel to the triangles' plane or end exactly at a hit.
+        template<uint32_t Width>
+        void CheckTiedTriangles(Generator& generator, Checker& checker)
+        {
+            for (uint32_t iteration = 0; iteration != TieBlockCount; ++iteration)
+            {
+                TriangleBlock<Width> block;
+                const glm::vec3 vertex0 = generator.Vector(5.0f);
+                const glm::vec3 edge1 = generator.Vector(2.0f);
+                const glm::vec3 edge2 = generator.Vector(2.0f);
+
+                for (uint32_t lane = 0; lane != Width; ++lane)
+                {
+                    block.Set(lane, vertex0, edge1, lane % 3 == 2 ? edge1 * 2.0f : edge2);
+                }
+
+                const glm::vec3 origin = generator.Vector(10.0f);
+                const glm::vec3 parallelDirection = glm::cross(glm::cross(edge1, edge2), generator.Vector(1.0f));
+
+                const glm::vec3 direction = vertex0 + (edge1 + edge2) * 0.3f - origin;
+                float distance;
+                glm::vec2 barycentrics;
+
+                checker.CheckTriangles(block, origin, direction, MinimumDistance, MaximumDistance);
+
+                // Hits exactly at tMin are kept and hits exactly at tMax are not.
+                if (IntersectTriangle(origin, direction, vertex0, edge1, edge2, MinimumDistance, MaximumDistance, distance, barycentrics))
+                {
+                    checker.CheckTriangles(block, origin, direction, MinimumDistance, distance);
+                    checker.CheckTriangles(block, origin, direction, distance, MaximumDistance);
+                }
+
+                checker.CheckTriangles(block, vertex0, parallelDirection, 0.0f, MaximumDistance);
+            }
+        }
+
+        template<uint32_t Width>
+        void CheckRandomSpheres(Generator& generator, Checker& checker)
+        {
+            for (uint32_t iteration = 0; iteration != RandomBlockCount; ++iteration)
+            {
+                SphereBlock<Width> block;
+                SphereBlock<Width> tiedBlock;
+                const uint32_t laneCount = 1 + generator.Index(Width);
+                std::array<glm::vec3, Width> centers;
+
+                // Some spheres have a zero or negative radius, which the shader's quadratic accepts like any other. The tied block repeats the first sphere in every lane.
+                for (uint32_t lane = 0; lane != laneCount; ++lane)
+                {
+                    const float radius = iteration % 11 == 0 ? 0.0f : generator.Uniform(0.01f, 2.0f);
+
+                    centers[lane] = generator.Vector(5.0f);
+                    block.Set(lane, centers[lane], iteration % 13 == 0 ? -radius : radius);
+                }
+
+                for (uint32_t lane = 0; lane != Width; ++lane)
+                {
+                    tiedBlock.Set(lane, centers[0], 1.0f);
+                }
+
+                // A third of the rays start inside a sphere.
+                const glm::vec3 origin = iteration % 3 == 0 ? centers[0] + generator.Vector(0.5f) : generator.Vector(10.0f);
+                const glm::vec3 target = iteration % 2 == 0 ? centers[generator.Index(laneCount)] + generator.Vector(1.0f) : generator.Vector(5.0f);
+                const glm::vec3 direction = (target - origin) * generator.Uniform(0.1f, 3.0f);
+                const float tMin = generator.MinimumDistance(iteration);
+                const float tMax = generator.MaximumDistance(iteration);
+
+                checker.CheckSpheres(block, origin, direction, tMin, tMax);
+                checker.CheckSpheres(tiedBlock, origin, direction, tMin, tMax);
+
+                // Hits exactly at tMin are kept and hits exactly at tMax are not.
+                float distance;
+
+                if (IntersectSphere(origin, direction, centers[0], 1.0f, tMin, tMax, distance))
+                {
+                    checker.CheckSpheres(tiedBlock, origin, direction, tMin, distance);
+                    checker.CheckSpheres(tiedBlock, origin, direction, distance, tMax);
+                }
+            }
+        }
+
+        template<uint32_t Width>
+        void CheckSpecialValues(Generator& generator, Checker& triangleChecker, Checker& sphereChecker)
+        {
+            for (uint32_t iteration = 0; iteration != SpecialValueBlockCount; ++iteration)
+            {
+                TriangleBlock<Width> triangles;
+                SphereBlock<Width> spheres;
+
+                for (uint32_t lane = 0; lane != Width; ++lane)
+                {
+                    triangles.Set(lane, generator.Vector(5.0f), generator.Vector(2.0f), generator.Vector(2.0f));
+                    spheres.Set(lane, generator.Vector(5.0f), generator.Uniform(0.0f, 2.0f));
+                }
+
+                glm::vec3 origin = generator.Vector(3.0f);
+                glm::vec3 direction = generator.Vector(1.0f);
+
+                direction[generator.Index(3)] = generator.SpecialValue();
+
+                if (iteration % 2 == 1)
+                {
+                    origin[generator.Index(3)] = generator.SpecialValue();
+                }
+
+                triangleChecker.CheckTriangles(triangles, origin, direction, MinimumDistance, MaximumDistance);
+                sphereChecker.CheckSpheres(spheres, origin, direction, MinimumDistance, MaximumDistance);
+            }
+        }
+
+        // Closed height fields, half of them on an integer grid so the points on their edges are exact. Rays through vertices and shared edges are where a
+        // kernel that rounds differently from the single triangle test would let a ray slip between two triangles.
+        template<uint32_t Width>
+        void CheckSharedEdges(Generator& generator, Checker& checker)
+        {
+            const uint32_t GridSize = 5;
+
+            for (uint32_t mesh = 0; mesh != MeshCount; ++mesh)
+            {
+                const bool isExact = mesh % 2 == 0;
+                const float scale = isExact ? 8.0f : std::pow(10.0f, generator.Uniform(-3.0f, 3.0f));
+                glm::vec3 points[GridSize][GridSize];
+
+                for (uint32_t i = 0; i != GridSize; ++i)
+                {
+                    for (uint32_t j = 0; j != GridSize; ++j)
+                    {
+                        const glm::vec3 jitter = isExact ? glm::round(generator.Vector(2.0f)) : generator.Vector(0.3f) * scale;
+                        points[i][j] = glm::vec3(i * scale, j * scale, 0.0f) + jitter;
+                    }
+                }
+
+                // Alternate the diagonal so vertices are shared by both four and eight triangles.
+                std::vector<std::array<glm::vec3, 3>> triangles;
+
+                for (uint32_t i = 0; i + 1 != GridSize; ++i)
+                {
+                    for (uint32_t j = 0; j + 1 != GridSize; ++j)
+                    {
+                        if ((i + j) % 2 == 0)
+                        {
+                            triangles.push_back({ points[i][j], points[i + 1][j], points[i + 1][j + 1] });
+                            triangles.push_back({ points[i + 1][j + 1], points[i][j + 1], points[i][j] });
+                        }
+                        else
+                        {
+                            triangles.push_back({ points[i + 1][j], points[i + 1][j + 1], points[i][j + 1] });
+                            triangles.push_back({ points[i][j + 1], points[i][j], points[i + 1][j] });
+                        }
+                    }
+                }
+
+                std::vector<TriangleBlock<Width>> blocks((triangles.size() + Width - 1) / Width);
+
+                for (size_t t = 0; t != triangles.size(); ++t)
+                {
+                    blocks[t / Width].Set(static_cast<uint32_t>(t % Width), triangles[t][0], triangles[t][1] - triangles[t][0], triangles[t][2] - triangles[t][0]);
+                }
+
+                // Interior vertices, and points along the edges leaving them.
+                for (uint32_t i = 1; i + 1 != GridSize; ++i)
+                {
+                    for (uint32_t j = 1; j + 1 != GridSize; ++j)
+                    {
+                        const glm::vec3 neighbours[] = { points[i + 1][j], points[i][j + 1], points[i + 1][j + 1], points[i - 1][j + 1] };
+
+                        for (uint32_t n = 0; n != 4 * 8; ++n)
+                        {
+                            const glm::vec3 target = points[i][j] + (neighbours[n / 8] - points[i][j]) * (static_cast<float>(n % 8) / 8.0f);
+
+                            for (uint32_t r = 0; r != RaysPerMeshPoint; ++r)
+                            {
+                                const float height = generator.Uniform(2.0f, 8.0f) * scale;
+                                const glm::vec3 origin = target + glm::vec3(generator.Uniform(-5.0f, 5.0f) * scale, generator.Uniform(-5.0f, 5.0f) * scale, r % 2 == 0 ? height : -height);
+
+                                for (const TriangleBlock<Width>& block : blocks)
+                                {
+                                    checker.CheckTriangles(block, origin, target - origin, 0.0f, MaximumDistance);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        template<uint32_t Width>
+        void CheckBlocks(Generator& generator, Checker& randomTriangles, Checker& tiedTriangles, Checker& specialTriangles, Checker& randomSpheres, Checker& specialSpheres, Checker& sharedEdges)
+        {
+            CheckRandomTriangles<Width>(generator, randomTriangles);
+            CheckTiedTriangles<Width>(generator, tiedTriangles);
+            CheckRandomSpheres<Width>(generator, randomSpheres);
+            CheckSpecialValues<Width>(generator, specialTriangles, specialSpheres);
+            CheckSharedEdges<Width>(generator, sharedEdges);
+        }
+    }
+
+    std::vector<IntersectionTest::Result> IntersectionTest::Run(uint32_t seed)
+    {
+        using namespace IntersectionTestUtilities;
+
+        // Only kernels the processor supports may run.
+        const IntersectionKernel widestKernel = GetIntersectionKernel();
+        std::vector<IntersectionKernel> kernels = { IntersectionKernel::Scalar };
+
+        if (widestKernel == IntersectionKernel::SSE41 || widestKernel == IntersectionKernel::AVX2)
+        {
+            kernels.push_back(IntersectionKernel::SSE41);
+        }
+
+        if (widestKernel == IntersectionKernel::AVX2)
+        {
+            kernels.push_back(IntersectionKernel::AVX2);
+        }
+
+        std::vector<Result> results;
+
+        Checker randomTriangles(results, kernels, "Random triangles");
+        Checker tiedTriangles(results, kernels, "Tied and degenerate triangles");
+        Checker specialTriangles(results, kernels, "Special value rays on triangles");
+        Checker randomSpheres(results, kernels, "Random spheres");
+        Checker specialSpheres(results, kernels, "Special value rays on spheres");
+        Checker sharedEdges(results, kernels, "Shared edges");
+
+        Generator generator(seed);
+        CheckBlocks<4>(generator, randomTriangles, tiedTriangles, specialTriangles, randomSpheres, specialSpheres, sharedEdges);
+        CheckBlocks<8>(generator, randomTriangles, tiedTriangles, specialTriangles, randomSpheres, specialSpheres, sharedEdges);
+
+        return results;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Math
+{
+    // Checks the block intersection kernels against the single triangle and sphere tests they vectorize, whose results they must reproduce bit for bit.
+    // Every kernel the processor supports runs on 4 and 8 wide blocks of random triangles and spheres, identical and degenerate lanes, rays with infinite,
+    // NaN and denormal components, and rays through the shared edges and vertices of closed meshes.
+    class IntersectionTest final
+    {
+    public:
+        struct Result
+        {
+            std::string m_Case;            // For example "Random triangles" or "Shared edges".
+            std::string m_Kernel;          // "Scalar", "SSE4.1" or "AVX2".
+            uint64_t m_CheckCount = 0;     // Rays tested against a block.
+            uint64_t m_MismatchCount = 0;  // Tests whose hit differs from the single primitive tests.
+        };
+
+        // The same seed generates the same rays and primitives.
+        static std::vector<Result> Run(uint32_t seed);
+    };
+}
\ No newline at end of file
@@ -6,7 +6,12 @@
 #include "Vulkan/VulkanSwapChain.h"
 #include "Vulkan/VulkanCommandPool.h"
 #include "Vulkan/VulkanDevice.h"
+#include "Vulkan/VulkanMemoryAllocator.h"
 #include "Core/Window.h"
+#include "Exporters/ImageExporter.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
 
 namespace RaytracerUtilities
 {
@@ -16,17 +21,25 @@ namespace RaytracerUtilities
 #else
         false;
 #endif
+
+    // Seconds between two benchmark reports.
+    const double BenchmarkPeriod = 5.0;
 }
 
 Raytracer::Raytracer(const UserSettings& userSettings, const Vulkan::WindowSettings& windowSettings, VkPresentModeKHR requestedPresentationMode)
                    : Vulkan::Raytracing::RaytracingApplication(windowSettings, requestedPresentationMode, RaytracerUtilities::EnableValidationLayers), 
-                     m_UserSettings(userSettings)
+                     m_UserSettings(userSettings), m_PreviousSettings(userSettings)
 {
     CheckFramebufferSize();
 }
 
 Raytracer::~Raytracer()
 {
+    if (m_PendingScene.valid())
+    {
+        m_PendingScene.wait();
+    }
+
     m_Scene.reset();
 }
 
@@ -37,23 +50,26 @@ const Resources::Scene& Raytracer::GetScene() const
 
 Resources::UniformBufferObject Raytracer::GetUniformBufferObject(VkExtent2D extent) const
 {
-    const SceneList::CameraInitialState& initialState = m_CameraInitialState;
+    return CreateUniformBufferObject(m_UserSettings, m_ModelViewController.GetModelView(), extent, m_TotalNumberOfSamples, m_NumberOfSamples);
+}
 
+Resources::UniformBufferObject Raytracer::CreateUniformBufferObject(const UserSettings& userSettings, const glm::mat4& modelView, VkExtent2D extent, uint32_t totalNumberOfSamples, uint32_t numberOfSamples)
+{
     Resources::UniformBufferObject uniformBufferObject = {};
-    uniformBufferObject.m_ModelView = m_ModelViewController.GetModelView();
-    uniformBufferObject.m_Projection = glm::perspective(glm::radians(m_UserSettings.m_FieldOfView), static_cast<float>(extent.width) / static_cast<float>(extent.height), 0.1f, 10000.0f);
+    uniformBufferObject.m_ModelView = modelView;
+    uniformBufferObject.m_Projection = glm::perspective(glm::radians(userSettings.m_FieldOfView), static_cast<float>(extent.width) / static_cast<float>(extent.height), 0.1f, 10000.0f);
     uniformBufferObject.m_Projection[1][1] *= -1; // Inverting Y for Vulkan, https://matthewwellings.com/blog/the-new-vulkan-coordinate-system/
     uniformBufferObject.m_ModelViewInverse = glm::inverse(uniformBufferObject.m_ModelView);
     uniformBufferObject.m_ProjectionInverse = glm::inverse(uniformBufferObject.m_Projection);
-    uniformBufferObject.m_Aperture = m_UserSettings.m_Aperture;
-    uniformBufferObject.m_FocusDistance = m_UserSettings.m_FocusDistance;
-    uniformBufferObject.m_TotalSamplesCount = m_TotalNumberOfSamples;
-    uniformBufferObject.m_SampleCount = m_NumberOfSamples;
-    uniformBufferObject.m_BounceCount = m_UserSettings.m_NumberOfBounces;
+    uniformBufferObject.m_Aperture = userSettings.m_Aperture;
+    uniformBufferObject.m_FocusDistance = userSettings.m_FocusDistance;
+    uniformBufferObject.m_TotalSamplesCount = totalNumberOfSamples;
+    uniformBufferObject.m_SampleCount = numberOfSamples;
+    uniformBufferObject.m_BounceCount = userSettings.m_NumberOfBounces;
     uniformBufferObject.m_RandomSeed = 1;
     uniformBufferObject.m_HasSky = true;
-    uniformBufferObject.m_ShowHeatMap = m_UserSettings.m_ShowHeatmap;
-    uniformBufferObject.m_HeatmapScale = m_UserSettings.m_HeatmapScale;
+    uniformBufferObject.m_ShowHeatMap = userSettings.m_ShowHeatmap;
+    uniformBufferObject.m_HeatmapScale = userSettings.m_HeatmapScale;
 
     return uniformBufferObject;
 }
@@ -83,8 +99,10 @@ void Raytracer::OnDeviceSet()
 {
     RaytracingApplication::OnDeviceSet();
 
-    LoadScene(m_UserSettings.m_SceneIndex);
+    LoadScene(ImportScene(m_UserSettings.m_SceneIndex));
 
+    SetBatchStaticGeometry(m_UserSettings.m_BatchStaticGeometry);
+    SetCompactAccelerationStructures(m_UserSettings.m_CompactAccelerationStructures);
     CreateAccelerationStructures();
 }
 
@@ -92,7 +110,7 @@ void Raytracer::CreateSwapChain()
 {
     RaytracingApplication::CreateSwapChain();
     
-    m_Editor.reset(new Editor(GetCommandPool(), GetSwapChain(), GetDepthBuffer(), m_UserSettings));
+    m_Editor.reset(IsHeadless() ? nullptr : new Editor(GetCommandPool(), GetSwapChain(), GetDepthBuffer(), m_UserSettings));
     m_ResetAccumulation = true;
 
     CheckFramebufferSize();
@@ -106,16 +124,40 @@ void Raytracer::DeleteSwapChain()
 
 void Raytracer::DrawFrame()
 {
-    // Check if the scene has been changed by the user.
-    if (m_SceneIndex != static_cast<uint32_t>(m_UserSettings.m_SceneIndex))
+    // Check if the scene has been changed by the user. Its models and textures are imported in the background, the current scene keeps rendering meanwhile.
+    if (m_SceneIndex != static_cast<uint32_t>(m_UserSettings.m_SceneIndex) && !m_PendingScene.valid())
+    {
+        m_PendingScene = std::async(std::launch::async, &Raytracer::ImportScene, static_cast<uint32_t>(m_UserSettings.m_SceneIndex));
+    }
+
+    // Swap in the new scene once it has been imported. Selecting another scene meanwhile starts its import after this one is done.
+    if (m_PendingScene.valid() && m_PendingScene.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    {
+        ImportedScene importedScene = m_PendingScene.get();
+
+        // Finish outstanding operations. The previous scene is released before the new one is uploaded, through the upload manager's transfer queue.
+        GetDevice().WaitIdle();
+        DeleteSwapChain();
+        DeleteAccelerationStructures();
+        LoadScene(std::move(importedScene));
+        CreateAccelerationStructures();
+        CreateSwapChain();
+        return;
+    }
+
+    // Check if the acceleration structure layout has been changed by the user.
+    if (m_UserSettings.RequireAccelerationStructureRebuild(m_PreviousSettings))
     {
-        // Finish outstanding operations.
         GetDevice().WaitIdle();
         DeleteSwapChain();
         DeleteAccelerationStructures();
-        LoadScene(m_UserSettings.m_SceneIndex);
+        SetBatchStaticGeometry(m_UserSettings.m_BatchStaticGeometry);
+        SetCompactAccelerationStructures(m_UserSettings.m_CompactAccelerationStructures);
         CreateAccelerationStructures();
         CreateSwapChain();
+
+        m_PreviousSettings.m_BatchStaticGeometry = m_UserSettings.m_BatchStaticGeometry;
+        m_PreviousSettings.m_CompactAccelerationStructures = m_UserSettings.m_CompactAccelerationStructures;
         return;
     }
 
@@ -131,22 +173,95 @@ void Raytracer::DrawFrame()
     m_NumberOfSamples = glm::clamp(m_UserSettings.m_MaxNumberOfSamples - m_TotalNumberOfSamples, 0u, m_UserSettings.m_NumberOfSamples);
     m_TotalNumberOfSamples += m_NumberOfSamples;
 
+    SetCompareUniformUpdates(m_UserSettings.m_CompareUniformUpdates);
     Application::DrawFrame();
 }
 
 
+void Raytracer::RenderOffscreen(uint32_t sampleCount, const std::string& outputPath)
+{
+    if (!IsHeadless())
+    {
+        throw std::logic_error("Offscreen renders require a headless application.");
+    }
+
+    m_UserSettings.m_IsRaytracingEnabled = true;
+    m_UserSettings.m_IsRayAccumulationEnabled = true;
+    m_UserSettings.m_MaxNumberOfSamples = sampleCount;
+    m_ResetAccumulation = true;
+
+    const std::chrono::high_resolution_clock::time_point renderStart = std::chrono::high_resolution_clock::now();
+    uint32_t frameCount = 0;
+
+    do
+    {
+        DrawFrame();
+        frameCount++;
+    } while (m_TotalNumberOfSamples < sampleCount);
+
+    GetDevice().WaitIdle();
+
+    const std::chrono::high_resolution_clock::time_point exportStart = std::chrono::high_resolution_clock::now();
+    const double renderTime = std::chrono::duration<double>(exportStart - renderStart).count();
+
+    // The accumulation image holds the sum of all samples, average them into the final radiance.
+    std::vector<float> pixels = ReadAccumulationImage();
+    const float sampleWeight = 1.0f / static_cast<float>(std::max(1u, m_TotalNumberOfSamples));
+
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+        pixels[i + 0] *= sampleWeight;
+        pixels[i + 1] *= sampleWeight;
+        pixels[i + 2] *= sampleWeight;
+        pixels[i + 3] = 1.0f;
+    }
+
+    const VkExtent2D extent = GetSwapChain().GetExtent();
+    Exporters::ImageExporter::Export(outputPath, pixels, extent.width, extent.height);
+
+    const double exportTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - exportStart).count();
+    const double rayRate = double(extent.width) * extent.height * m_TotalNumberOfSamples / (renderTime * 1000000000);
+
+    std::cout << "Rendered " << m_TotalNumberOfSamples << " samples at " << extent.width << "x" << extent.height << " in " << frameCount << " frames, " << renderTime << " seconds (" << rayRate << " Gr/s).\n";
+    std::cout << "Wrote '" << outputPath << "' in " << exportTime << " seconds.\n";
+}
+
 void Raytracer::Render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 {
+    // Headless renders keep the scene's initial camera and have no user interface.
+    if (IsHeadless())
+    {
+        RaytracingApplication::Render(commandBuffer, imageIndex);
+        return;
+    }
+
     // Record delta time between calls to Render.
     const auto previousTime = m_Time;
     m_Time = GetWindow().GetTime();
     const auto deltaTime = m_Time - previousTime;
 
-    // Update the camera position/angle.
-    m_ResetAccumulation = m_ModelViewController.UpdateCamera(m_CameraInitialState.m_ControlSpeed, deltaTime);
+    // Update the camera position/angle. Benchmarks keep the scene's initial camera so runs stay comparable.
+    if (!m_UserSettings.m_IsBenchmarkingEnabled)
+    {
+        m_ResetAccumulation = m_ModelViewController.UpdateCamera(m_CameraInitialState.m_ControlSpeed, deltaTime);
+    }
+
+    // Move the scene's animated instances, benchmarks keep them where they were loaded.
+    if (!m_UserSettings.m_IsBenchmarkingEnabled && !m_CameraInitialState.m_Animations.empty())
+    {
+        for (const SceneList::InstanceAnimation& animation : m_CameraInitialState.m_Animations)
+        {
+            SetInstanceTransform(animation.m_ModelIndex, animation.m_InstanceIndex, animation.m_Transform(m_Time));
+        }
+
+        m_ResetAccumulation = true;
+    }
+
+    // The rasterizer reads the transforms from the scene's instance buffer, the ray tracer from the top level structure.
+    UpdateInstanceBuffer(commandBuffer);
 
     // Check the current state of the benchmark and update it for the new frame.
-    CheckAndUpdateBenchmarkState(previousTime);
+    CheckAndUpdateBenchmarkState();
 
     // Render the scene.
     if (m_UserSettings.m_IsRaytracingEnabled)
@@ -171,21 +286,46 @@ void Raytracer::Render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
         statistics.m_TotalSamples = m_TotalNumberOfSamples;
     }
 
+    statistics.m_UniformUpdateTime = GetUniformUpdateTime();
+    statistics.m_MapUnmapUniformUpdateTime = GetMapUnmapUniformUpdateTime();
+    statistics.m_BottomLevelSize = GetBottomLevelSize();
+    statistics.m_CompactedBottomLevelSize = GetCompactedBottomLevelSize();
+    statistics.m_IsLoadingScene = m_PendingScene.valid();
+
+    const Vulkan::VulkanMemoryAllocator::Statistics memoryStatistics = GetDevice().GetMemoryAllocator().GetStatistics();
+    statistics.m_DeviceMemoryUsed = memoryStatistics.m_UsedSize;
+    statistics.m_DeviceMemoryReserved = memoryStatistics.m_BlockSize;
+    statistics.m_DeviceMemoryAllocations = memoryStatistics.m_AllocationCount;
+    statistics.m_DeviceMemoryBlocks = memoryStatistics.m_BlockCount;
+
     m_Editor->Render(commandBuffer, GetSwapchainFramebuffer(imageIndex), statistics);
 }
 
-void Raytracer::LoadScene(uint32_t sceneIndex)
+Raytracer::ImportedScene Raytracer::ImportScene(uint32_t sceneIndex)
 {
-    auto [models, textures] = SceneList::s_AllScenes[sceneIndex].second(m_CameraInitialState);
+    // Only touches host memory, so it is safe to run on any thread.
+    ImportedScene importedScene = {};
+    importedScene.m_SceneIndex = sceneIndex;
+    importedScene.m_Assets = SceneList::s_AllScenes[sceneIndex].second(importedScene.m_CameraInitialState);
 
     // If there are no textures, add a dummy one. It makes the pipeline setup a lot easier.
+    std::vector<Resources::Texture>& textures = std::get<1>(importedScene.m_Assets);
+
     if (textures.empty())
     {
         textures.push_back(Resources::Texture::LoadTexture("../Assets/Textures/White.png", Vulkan::SamplerConfiguration()));
     }
 
-    m_Scene.reset(new Resources::Scene(GetCommandPool(), std::move(models), std::move(textures), true));
-    m_SceneIndex = sceneIndex;
+    return importedScene;
+}
+
+void Raytracer::LoadScene(ImportedScene importedScene)
+{
+    auto& [models, textures] = importedScene.m_Assets;
+
+    m_Scene.reset(new Resources::Scene(GetUploadManager(), std::move(models), std::move(textures), true));
+    m_SceneIndex = importedScene.m_SceneIndex;
+    m_CameraInitialState = importedScene.m_CameraInitialState;
 
     m_UserSettings.m_FieldOfView = m_CameraInitialState.m_FieldOfView;
     m_UserSettings.m_Aperture = m_CameraInitialState.m_Aperture;
@@ -193,16 +333,159 @@ void Raytracer::LoadScene(uint32_t sceneIndex)
 
     m_ModelViewController.Reset(m_CameraInitialState.m_ModelView);
 
-    m_PeriodTotalFrames = 0;
+    m_BenchmarkPhase = BenchmarkPhase::SceneStart;
     m_ResetAccumulation = true;
 }
 
-void Raytracer::CheckAndUpdateBenchmarkState(double previousTime)
+void Raytracer::CheckAndUpdateBenchmarkState()
 {
-    if (!m_UserSettings.m_IsBenchmarkingEnabled)
+    // Frames rendered while the next scene is being imported still show the previous one.
+    if (!m_UserSettings.m_IsBenchmarkingEnabled || m_BenchmarkPhase == BenchmarkPhase::SceneDone)
+    {
+        return;
+    }
+
+    // Initialize the scene benchmark timers.
+    if (m_BenchmarkPhase == BenchmarkPhase::SceneStart)
+    {
+        const VkExtent2D extent = GetSwapChain().GetExtent();
+
+        VkPhysicalDeviceProperties deviceProperties = {};
+        vkGetPhysicalDeviceProperties(GetDevice().GetPhysicalDevice(), &deviceProperties);
+
+        m_BenchmarkScene = {};
+        m_BenchmarkScene.m_SceneIndex = m_SceneIndex;
+        m_BenchmarkScene.m_SceneName = SceneList::s_AllScenes[m_SceneIndex].first;
+        m_BenchmarkScene.m_DeviceName = deviceProperties.deviceName;
+        m_BenchmarkScene.m_Width = extent.width;
+        m_BenchmarkScene.m_Height = extent.height;
+        m_BenchmarkScene.m_SamplesPerFrame = m_UserSettings.m_NumberOfSamples;
+        m_BenchmarkScene.m_NumberOfBounces = m_UserSettings.m_NumberOfBounces;
+
+        m_BenchmarkPhase = BenchmarkPhase::WarmUp;
+        m_SceneInitialTime = m_Time;
+        m_SceneTotalSamples = 0;
+
+        std::cout << "\nBenchmark: Start scene #" << m_SceneIndex << " '" << m_BenchmarkScene.m_SceneName << "' at " << extent.width << "x" << extent.height << ", " << m_UserSettings.m_BenchmarkWarmUpTime << " seconds warm-up.\n";
+    }
+
+    // Once accumulation has reached its sample limit, frames no longer trace anything worth measuring.
+    const bool sampleLimitReached = m_NumberOfSamples == 0;
+    const double sceneTime = m_Time - m_SceneInitialTime;
+
+    if (!sampleLimitReached)
+    {
+        if (m_BenchmarkPhase == BenchmarkPhase::WarmUp && sceneTime >= m_UserSettings.m_BenchmarkWarmUpTime)
+        {
+            m_BenchmarkPhase = BenchmarkPhase::Measuring;
+            m_PeriodInitialTime = m_Time;
+            m_PeriodTotalFrames = 0;
+            m_PeriodTotalSamples = 0;
+        }
+        else if (m_BenchmarkPhase == BenchmarkPhase::Measuring)
+        {
+            m_PeriodTotalFrames++;
+            m_PeriodTotalSamples += m_NumberOfSamples;
+
+            // Print out the frame and ray rates at regular intervals.
+            if (m_Time - m_PeriodInitialTime >= RaytracerUtilities::BenchmarkPeriod)
+            {
+                RecordBenchmarkPeriod(false);
+            }
+        }
+    }
+
+    // Bail out from the scene if we've reached the time or sample limit.
+    const bool timeLimitReached = sceneTime >= double(m_UserSettings.m_BenchmarkWarmUpTime) + m_UserSettings.m_BenchmarkMaxTime;
+
+    if (timeLimitReached || sampleLimitReached)
+    {
+        if (m_BenchmarkPhase == BenchmarkPhase::Measuring && m_PeriodTotalFrames != 0)
+        {
+            RecordBenchmarkPeriod(true);
+        }
+
+        FinishBenchmarkScene();
+    }
+}
+
+void Raytracer::RecordBenchmarkPeriod(bool isPartialPeriod)
+{
+    const double periodTime = m_Time - m_PeriodInitialTime;
+    const double frameRate = m_PeriodTotalFrames / periodTime;
+    const double rayRate = double(m_BenchmarkScene.m_Width) * m_BenchmarkScene.m_Height * m_PeriodTotalSamples / (periodTime * 1000000000);
+
+    // The leftover period at the end of a scene counts towards the averages only, it is too short to be a fair minimum or maximum.
+    if (!isPartialPeriod)
     {
+        const bool isFirstPeriod = m_BenchmarkScene.m_TotalFrames == 0;
+
+        m_BenchmarkScene.m_MinimumFrameRate = isFirstPeriod ? frameRate : std::min(m_BenchmarkScene.m_MinimumFrameRate, frameRate);
+        m_BenchmarkScene.m_MaximumFrameRate = isFirstPeriod ? frameRate : std::max(m_BenchmarkScene.m_MaximumFrameRate, frameRate);
+
+        std::cout << "Benchmark: " << frameRate << " fps, " << rayRate << " Gr/s\n";
+    }
+
+    m_BenchmarkScene.m_TotalFrames += m_PeriodTotalFrames;
+    m_BenchmarkScene.m_TotalTime += periodTime;
+    m_SceneTotalSamples += m_PeriodTotalSamples;
+
+    m_PeriodInitialTime = m_Time;
+    m_PeriodTotalFrames = 0;
+    m_PeriodTotalSamples = 0;
+}
+
+void Raytracer::FinishBenchmarkScene()
+{
+    Exporters::BenchmarkExporter::SceneResult& result = m_BenchmarkScene;
+
+    if (result.m_TotalTime > 0)
+    {
+        result.m_FrameRate = result.m_TotalFrames / result.m_TotalTime;
+        result.m_RayRate = double(result.m_Width) * result.m_Height * m_SceneTotalSamples / (result.m_TotalTime * 1000000000);
+
+        std::cout << "Benchmark: Scene #" << result.m_SceneIndex << " averaged " << result.m_FrameRate << " fps (" << result.m_MinimumFrameRate << " - " << result.m_MaximumFrameRate << "), "
+                  << result.m_RayRate << " Gr/s over " << result.m_TotalFrames << " frames.\n";
+    }
+    else
+    {
+        std::cout << "Benchmark: Scene #" << result.m_SceneIndex << " reached its sample limit before the warm-up ended, nothing was measured.\n";
+    }
+
+    m_BenchmarkResults.push_back(result);
+    m_BenchmarkPhase = BenchmarkPhase::SceneDone;
+
+    // Rewritten after every scene so an interrupted run still keeps its results.
+    if (!m_UserSettings.m_BenchmarkOutputPath.empty())
+    {
+        Exporters::BenchmarkExporter::Export(m_UserSettings.m_BenchmarkOutputPath, m_BenchmarkResults);
+    }
+
+    if (m_UserSettings.m_BenchmarkNextScenes && static_cast<size_t>(m_UserSettings.m_SceneIndex) + 1 < SceneList::s_AllScenes.size())
+    {
+        m_UserSettings.m_SceneIndex += 1;
         return;
     }
+
+    // All done, summarize the run and exit.
+    const std::streamsize precision = std::cout.precision();
+    std::cout << "\nBenchmark Results (" << result.m_DeviceName << ")\n";
+
+    for (const Exporters::BenchmarkExporter::SceneResult& sceneResult : m_BenchmarkResults)
+    {
+        std::cout << "  #" << sceneResult.m_SceneIndex << " " << std::left << std::setw(28) << sceneResult.m_SceneName << std::right
+                  << std::fixed << std::setprecision(2) << std::setw(10) << sceneResult.m_FrameRate << " fps" << std::setw(10) << sceneResult.m_RayRate << " Gr/s\n"
+                  << std::defaultfloat;
+    }
+
+    std::cout.precision(precision);
+
+    if (!m_UserSettings.m_BenchmarkOutputPath.empty())
+    {
+        std::cout << "Wrote '" << m_UserSettings.m_BenchmarkOutputPath << "'.\n";
+    }
+
+    GetWindow().Close();
 }
 
 void Raytracer::OnKey(int key, int scanCode, int action, int mods)
@@ -4,6 +4,9 @@
 #include "Editor/ModelViewController.h"
 #include "Editor/UserSettings.h"
 #include "Editor/Editor.h"
+#include "Exporters/BenchmarkExporter.h"
+#include <future>
+#include <string>
 
 class Raytracer final : public Vulkan::Raytracing::RaytracingApplication
 {
@@ -11,6 +14,12 @@ public:
     Raytracer(const UserSettings& userSettings, const Vulkan::WindowSettings& windowSettings, VkPresentModeKHR requestedPresentationMode);
     ~Raytracer();
 
+    // Headless only. Traces the current scene until sampleCount samples per pixel have accumulated, then writes the result to a .png or .exr file.
+    void RenderOffscreen(uint32_t sampleCount, const std::string& outputPath);
+
+    // The camera and sampling parameters of a frame, shared with the CPU renderer so both trace the same rays.
+    static Resources::UniformBufferObject CreateUniformBufferObject(const UserSettings& userSettings, const glm::mat4& modelView, VkExtent2D extent, uint32_t totalNumberOfSamples, uint32_t numberOfSamples);
+
 protected:
     virtual Resources::UniformBufferObject GetUniformBufferObject(VkExtent2D extent) const override;
 
@@ -29,9 +38,20 @@ protected:
     const Resources::Scene& GetScene() const override;
 
 private:
+    // The CPU side of a scene: imported models and decoded textures, ready to be uploaded.
+    struct ImportedScene
+    {
+        uint32_t m_SceneIndex;
+        SceneList::CameraInitialState m_CameraInitialState;
+        SceneAssets m_Assets;
+    };
+
     void CheckFramebufferSize() const;
-    void LoadScene(uint32_t sceneIndex);
-    void CheckAndUpdateBenchmarkState(double previousTime);
+    static ImportedScene ImportScene(uint32_t sceneIndex);
+    void LoadScene(ImportedScene importedScene);
+    void CheckAndUpdateBenchmarkState();
+    void RecordBenchmarkPeriod(bool isPartialPeriod);
+    void FinishBenchmarkScene();
 
 private:
     UserSettings m_UserSettings = {};
@@ -41,6 +61,7 @@ private:
     std::unique_ptr<const Resources::Scene> m_Scene;
     std::unique_ptr<class Editor> m_Editor;
     uint32_t m_SceneIndex = 0;
+    std::future<ImportedScene> m_PendingScene; // Imported on a worker thread while the current scene keeps rendering.
 
     ModelViewController m_ModelViewController = {};
     double m_Time = {};
@@ -50,7 +71,20 @@ private:
     bool m_ResetAccumulation = false;
 
     // Benchmark States
+    enum class BenchmarkPhase
+    {
+        SceneStart,  // Set whenever a scene is loaded.
+        WarmUp,
+        Measuring,
+        SceneDone    // Waiting for the next scene to be imported.
+    };
+
+    BenchmarkPhase m_BenchmarkPhase = BenchmarkPhase::SceneStart;
     double m_SceneInitialTime = 0;
     double m_PeriodInitialTime = 0;
     uint32_t m_PeriodTotalFrames = 0;
+    uint64_t m_PeriodTotalSamples = 0;
+    uint64_t m_SceneTotalSamples = 0;
+    Exporters::BenchmarkExporter::SceneResult m_BenchmarkScene = {};
+    std::vector<Exporters::BenchmarkExporter::SceneResult> m_BenchmarkResults;
 };
\ No newline at end of file
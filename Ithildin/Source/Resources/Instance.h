@@ -0,0 +1,24 @@
+#pragma once
+#include "Material.h"
+#include "Math/Math.h"
+#include <optional>
+
+namespace Resources
+{
+    // Placement of a model in the scene. All instances of a model share its geometry and bottom level acceleration structure.
+    struct ModelInstance final
+    {
+        glm::mat4 m_Transform = glm::mat4(1.0f);
+        std::optional<Material> m_Material; // Replaces every material of the model when set.
+    };
+
+    // Per instance data as read by the hit shaders (see Instance.glsl) and, as instance rate vertex attributes, by the rasterizer.
+    struct alignas(16) InstanceData final
+    {
+        glm::mat4 m_Transform;
+        uint32_t m_IndexOffset;
+        uint32_t m_VertexOffset;
+        int32_t m_MaterialIndex; // Overrides the material of every vertex when not negative.
+        uint32_t m_ModelIndex;
+    };
+}
@@ -0,0 +1,155 @@
+#include "MeshOptimizer.h"
+#include "Core/Parallel.h"
+#include <algorithm>
+#include <limits>
+
+namespace Resources
+{
+    namespace MeshOptimizerUtilities
+    {
+        constexpr size_t g_MinimumTrianglesPerWorker = 64 * 1024;
+
+        // Spreads the lower 10 bits of value out so that there are two zero bits between each of them.
+        uint32_t ExpandBits(uint32_t value)
+        {
+            value = (value * 0x00010001u) & 0xFF0000FFu;
+            value = (value * 0x00000101u) & 0x0F00F00Fu;
+            value = (value * 0x00000011u) & 0xC30C30C3u;
+            value = (value * 0x00000005u) & 0x49249249u;
+
+            return value;
+        }
+
+        // 30 bit Morton code of a point inside the unit cube.
+        uint32_t GetMortonCode(const glm::vec3& point)
+        {
+            const glm::vec3 quantized = glm::clamp(point * 1024.0f, glm::vec3(0.0f), glm::vec3(1023.0f));
+
+            return ExpandBits(static_cast<uint32_t>(quantized.x)) * 4 + ExpandBits(static_cast<uint32_t>(quantized.y)) * 2 + ExpandBits(static_cast<uint32_t>(quantized.z));
+        }
+
+        // Renumbers vertices in the order the triangles, visited in the given order, first reference them. Vertices no triangle uses are dropped.
+        void RemapVertices(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<uint32_t>& triangleOrder,
+                           std::vector<Vertex>& optimizedVertices, std::vector<uint32_t>& optimizedIndices)
+        {
+            constexpr uint32_t unassigned = std::numeric_limits<uint32_t>::max();
+            std::vector<uint32_t> vertexRemap(vertices.size(), unassigned);
+
+            optimizedVertices.clear();
+            optimizedVertices.reserve(vertices.size());
+            optimizedIndices.resize(triangleOrder.size() * 3);
+
+            for (size_t triangle = 0; triangle != triangleOrder.size(); ++triangle)
+            {
+                const uint32_t* sourceTriangle = &indices[static_cast<size_t>(triangleOrder[triangle]) * 3];
+
+                for (size_t corner = 0; corner != 3; ++corner)
+                {
+                    uint32_t& remappedIndex = vertexRemap[sourceTriangle[corner]];
+
+                    if (remappedIndex == unassigned)
+                    {
+                        remappedIndex = static_cast<uint32_t>(optimizedVertices.size());
+                        optimizedVertices.push_back(vertices[sourceTriangle[corner]]);
+                    }
+
+                    optimizedIndices[triangle * 3 + corner] = remappedIndex;
+                }
+            }
+        }
+
+        glm::vec3 GetCentroid(const std::vector<Vertex>& vertices, const uint32_t* triangle)
+        {
+            return (vertices[triangle[0]].m_Position + vertices[triangle[1]].m_Position + vertices[triangle[2]].m_Position) / 3.0f;
+        }
+    }
+
+    MeshOptimizer::Statistics MeshOptimizer::Optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+    {
+        using namespace MeshOptimizerUtilities;
+
+        Statistics statistics = {};
+        statistics.m_FetchDistanceBefore = GetAverageFetchDistance(indices);
+
+        const size_t triangleCount = indices.size() / 3;
+
+        if (triangleCount == 0)
+        {
+            return statistics;
+        }
+
+        // Triangle order along the curve. Centroids are normalized to the bounds of all centroids so the curve uses its full resolution.
+        glm::vec3 boundsMinimum(std::numeric_limits<float>::max());
+        glm::vec3 boundsMaximum(std::numeric_limits<float>::lowest());
+
+        for (size_t triangle = 0; triangle != triangleCount; ++triangle)
+        {
+            const glm::vec3 centroid = GetCentroid(vertices, &indices[triangle * 3]);
+            boundsMinimum = glm::min(boundsMinimum, centroid);
+            boundsMaximum = glm::max(boundsMaximum, centroid);
+        }
+
+        const glm::vec3 inverseExtent = 1.0f / glm::max(boundsMaximum - boundsMinimum, glm::vec3(std::numeric_limits<float>::min()));
+
+        // Packing the triangle index beneath the code keeps the sort stable, so equal codes retain their import order.
+        std::vector<uint64_t> sortKeys(triangleCount);
+
+        Parallel::ForEachRange(triangleCount, g_MinimumTrianglesPerWorker, [&](size_t begin, size_t end, uint32_t)
+        {
+            for (size_t triangle = begin; triangle != end; ++triangle)
+            {
+                const glm::vec3 centroid = GetCentroid(vertices, &indices[triangle * 3]);
+                sortKeys[triangle] = static_cast<uint64_t>(GetMortonCode((centroid - boundsMinimum) * inverseExtent)) << 32 | triangle;
+            }
+        });
+
+        std::sort(sortKeys.begin(), sortKeys.end());
+
+        std::vector<uint32_t> triangleOrder(triangleCount);
+
+        for (size_t triangle = 0; triangle != triangleCount; ++triangle)
+        {
+            triangleOrder[triangle] = static_cast<uint32_t>(sortKeys[triangle]);
+        }
+
+        std::vector<Vertex> optimizedVertices;
+        std::vector<uint32_t> optimizedIndices;
+        RemapVertices(vertices, indices, triangleOrder, optimizedVertices, optimizedIndices);
+
+        // Models that were authored or scanned in strips can already be in better order than the curve, which has to jump between its cells.
+        // Those keep their triangle order and only have their vertices renumbered.
+        if (GetAverageFetchDistance(optimizedIndices) > statistics.m_FetchDistanceBefore)
+        {
+            for (size_t triangle = 0; triangle != triangleCount; ++triangle)
+            {
+                triangleOrder[triangle] = static_cast<uint32_t>(triangle);
+            }
+
+            RemapVertices(vertices, indices, triangleOrder, optimizedVertices, optimizedIndices);
+        }
+
+        vertices = std::move(optimizedVertices);
+        indices = std::move(optimizedIndices);
+
+        statistics.m_FetchDistanceAfter = GetAverageFetchDistance(indices);
+
+        return statistics;
+    }
+
+    float MeshOptimizer::GetAverageFetchDistance(const std::vector<uint32_t>& indices)
+    {
+        if (indices.size() < 2)
+        {
+            return 0.0f;
+        }
+
+        uint64_t totalDistance = 0;
+
+        for (size_t i = 1; i != indices.size(); ++i)
+        {
+            totalDistance += indices[i] > indices[i - 1] ? indices[i] - indices[i - 1] : indices[i - 1] - indices[i];
+        }
+
+        return static_cast<float>(static_cast<double>(totalDistance) / (indices.size() - 1));
+    }
+}
\ No newline at end of file
@@ -1,63 +1,55 @@
 #include "Model.h"
+#include "ModelCache.h"
+#include "MeshOptimizer.h"
+#include "NormalGenerator.h"
 #include "CornellBox.h"
 #include "Sphere.h"
-#define GLM_ENABLE_EXPERIMENTAL
+#include "VertexWelder.h"
 #include <glm/gtc/matrix_inverse.hpp>
-#include <glm/gtx/hash.hpp>
 
-#define TINYOBJLOADER_IMPLEMENTATION
-#include "Importers/Internal/tiny_obj_loader.h"
+#include "Importers/ObjImporter.h"
 
 #include <iostream>
 #include <chrono>
-#include <filesystem>
-
-namespace std
-{
-    template<> struct hash<Resources::Vertex> final
-    {
-        size_t operator()(Resources::Vertex const& vertex) const noexcept
-        {
-            return
-                Combine(hash<glm::vec3>()(vertex.m_Position),
-                    Combine(hash<glm::vec3>()(vertex.m_Normal),
-                        Combine(hash<glm::vec2>()(vertex.m_TexCoords),
-                            hash<int>()(vertex.m_MaterialIndex))));
-        }
-
-    private:
-        static size_t Combine(size_t hash0, size_t hash1)
-        {
-            return hash0 ^ (hash1 + 0x9e3779b9 + (hash0 << 6) + (hash0 >> 2));
-        }
-    };
-}
+#include <stdexcept>
 
 namespace Resources
 {
-    Model Model::LoadModel(const std::string& filePath)
+    Model Model::LoadModel(const std::string& filePath, bool optimize, NormalGenerator::Weighting normalWeighting)
     {
         std::cout << "Loading: " << filePath << "... \n";
 
-        const std::chrono::steady_clock::time_point timer = std::chrono::high_resolution_clock::now();
-        const std::string materialPath = std::filesystem::path(filePath).parent_path().string(); // Returns path to parent directory.
+        const std::chrono::high_resolution_clock::time_point timer = std::chrono::high_resolution_clock::now();
 
-        tinyobj::ObjReader modelImporter;
-
-        if (!modelImporter.ParseFromFile(filePath))
+        // A previously processed copy of this model lets us skip the import entirely.
         {
-            std::runtime_error("Failed to load model: " + filePath + " - " + modelImporter.Error() + "\n");
+            std::vector<Vertex> vertices;
+            std::vector<uint32_t> indices;
+            std::vector<Material> materials;
+
+            if (ModelCache::Load(filePath, optimize, normalWeighting, vertices, indices, materials))
+            {
+                const float elapsedTime = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+
+                std::cout << "Successfully Loaded Model (" << vertices.size() << " Unique Vertices, " << materials.size() << " Materials)\n";
+                std::cout << "Elapsed: " << elapsedTime << " Seconds (Cached: " << ModelCache::GetCachePath(filePath) << ").\n";
+
+                return Model(std::move(vertices), std::move(indices), std::move(materials), nullptr);
+            }
         }
 
-        if (!modelImporter.Warning().empty())
+        // Parsing is split across all cores by the importer.
+        const Importers::ObjImporter::Result modelImporter = Importers::ObjImporter::Import(filePath);
+
+        if (!modelImporter.m_Warning.empty())
         {
-            std::cout << "Warning: " << modelImporter.Warning() << "\n";
+            std::cout << "Warning: " << modelImporter.m_Warning << "\n";
         }
 
         // Materials
         std::vector<Material> materials;
 
-        for (const tinyobj::material_t& material : modelImporter.GetMaterials())
+        for (const tinyobj::material_t& material : modelImporter.m_Materials)
         {
             Material customMaterial = {};
             customMaterial.m_Diffuse = glm::vec4(material.diffuse[0], material.diffuse[1], material.diffuse[2], 1.0f);
@@ -76,86 +68,49 @@ namespace Resources
         }
 
         // Geometry
-        const tinyobj::attrib_t& modelAttributes = modelImporter.GetAttrib();
+        const std::chrono::high_resolution_clock::time_point weldTimer = std::chrono::high_resolution_clock::now();
 
         std::vector<Vertex> vertices;
         std::vector<uint32_t> indices;
-        std::unordered_map<Vertex, uint32_t> uniqueVertices(modelAttributes.vertices.size());
-        size_t faceID = 0;
+        VertexWelder::Weld(modelImporter, vertices, indices);
 
-        for (const tinyobj::shape_t& shape : modelImporter.GetShapes())
-        {
-            const tinyobj::mesh_t& mesh = shape.mesh;
-
-            for (const tinyobj::index_t& index : mesh.indices)
-            {
-                Vertex vertex = {};
-                vertex.m_Position =
-                {
-                    modelAttributes.vertices[3 * index.vertex_index + 0], // Index 0, 1, 2 and so on.
-                    modelAttributes.vertices[3 * index.vertex_index + 1],
-                    modelAttributes.vertices[3 * index.vertex_index + 2],
-                };
-
-                if (!modelAttributes.normals.empty())
-                {
-                    vertex.m_Normal =
-                    {
-                        modelAttributes.normals[3 * index.normal_index + 0],
-                        modelAttributes.normals[3 * index.normal_index + 1],
-                        modelAttributes.normals[3 * index.normal_index + 2],
-                    };
-                }
-
-                if (!modelAttributes.texcoords.empty())
-                {
-                    vertex.m_TexCoords =
-                    {
-                        modelAttributes.texcoords[2 * index.texcoord_index + 0],
-                        1 - modelAttributes.texcoords[2 * index.texcoord_index + 1] // In Vulkan, the Y coordinate of an image begins in the top to bottom orientation, where 0 means the top of the image. Hence, we will flip the Y coordinate as TinyOBJ assumes a coordinate system where 0 means the bottom of the image.
-                    };
-                }
-
-                vertex.m_MaterialIndex = std::max(0, mesh.material_ids[faceID++ / 3]);
-
-                if (uniqueVertices.count(vertex) == 0)
-                {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                    vertices.push_back(vertex);
-                }
-
-                indices.push_back(uniqueVertices[vertex]);
-            }
-        }
+        const float weldTime = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - weldTimer).count();
 
         // If the model did not specify models, then create smooth normals that conserve the same number of vertices.
         // Usiong flat normals would mean creating more vertices than we currently have, so for simplicity and better visuals, we don't do it.
         // See: https://stackoverflow.com/questions/12139840/obj-file-averaging-normals.
-        if (modelAttributes.normals.empty())
+        const std::chrono::high_resolution_clock::time_point normalTimer = std::chrono::high_resolution_clock::now();
+
+        if (modelImporter.m_Normals.empty())
         {
-            std::vector<glm::vec3> normals(vertices.size());
+            NormalGenerator::Generate(vertices, indices, normalWeighting);
+        }
 
-            for (size_t i = 0; i < indices.size(); i += 3)
-            {
-                const auto normal = glm::normalize(glm::cross(
-                    glm::vec3(vertices[indices[i + 1]].m_Position) - glm::vec3(vertices[indices[i]].m_Position),
-                    glm::vec3(vertices[indices[i + 2]].m_Position) - glm::vec3(vertices[indices[i]].m_Position)));
+        const float normalTime = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - normalTimer).count();
 
-                vertices[indices[i + 0]].m_Normal += normal;
-                vertices[indices[i + 1]].m_Normal += normal;
-                vertices[indices[i + 2]].m_Normal += normal;
-            }
+        // Locality
+        const std::chrono::high_resolution_clock::time_point optimizeTimer = std::chrono::high_resolution_clock::now();
 
-            for (Vertex& vertex : vertices)
-            {
-                vertex.m_Normal = glm::normalize(vertex.m_Normal);
-            }
+        MeshOptimizer::Statistics optimizerStatistics = {};
+
+        if (optimize)
+        {
+            optimizerStatistics = MeshOptimizer::Optimize(vertices, indices);
         }
 
+        const float optimizeTime = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - optimizeTimer).count();
         const float elapsedTime = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
 
-        std::cout << "Successfully Loaded Model (" << modelAttributes.vertices.size() << " Vertices, " << uniqueVertices.size() << " Unique Vertices, " << materials.size() << " Materials)\n";
-        std::cout << "Elapsed: " << elapsedTime << " Seconds.\n";
+        std::cout << "Successfully Loaded Model (" << modelImporter.m_Positions.size() / 3 << " Vertices, " << vertices.size() << " Unique Vertices, " << materials.size() << " Materials)\n";
+        std::cout << "Elapsed: " << elapsedTime << " Seconds (Read: " << modelImporter.m_ReadTime << ", Parse: " << modelImporter.m_ParseTime << ", Merge: " << modelImporter.m_MergeTime
+                  << ", Weld: " << weldTime << ", Normals: " << normalTime << ", Optimize: " << optimizeTime << ").\n";
+
+        if (optimize)
+        {
+            std::cout << "Average Vertex Fetch Distance: " << optimizerStatistics.m_FetchDistanceBefore << " -> " << optimizerStatistics.m_FetchDistanceAfter << "\n";
+        }
+
+        ModelCache::Save(filePath, modelImporter.m_MaterialLibraries, optimize, normalWeighting, vertices, indices, materials);
 
         return Model(std::move(vertices), std::move(indices), std::move(materials), nullptr);
     }
@@ -306,6 +261,16 @@ namespace Resources
         }
     }
 
+    void Model::SetInstances(std::vector<ModelInstance>&& instances)
+    {
+        if (instances.empty())
+        {
+            throw std::runtime_error("A model needs at least one instance.");
+        }
+
+        m_Instances = std::move(instances);
+    }
+
     Model::Model(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices, std::vector<Material>&& materials, const Procedural* procedural)
                : m_Vertices(std::move(vertices)), m_Indices(std::move(indices)), m_Materials(std::move(materials)), m_Procedural(procedural)
     {
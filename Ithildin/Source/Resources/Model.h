@@ -1,5 +1,7 @@
 #pragma once
 #include "Material.h"
+#include "NormalGenerator.h"
+#include "Instance.h"
 #include "Vertex.h"
 #include "Procedural.h"
 #include <string>
@@ -11,7 +13,8 @@ namespace Resources
     class Model final
     {
     public:
-        static Model LoadModel(const std::string& filePath);
+        // Optimized models have their triangles and vertices reordered for memory locality. The weighting only applies to models whose file has no normals of its own.
+        static Model LoadModel(const std::string& filePath, bool optimize = true, NormalGenerator::Weighting normalWeighting = NormalGenerator::Weighting::Uniform);
         static Model CreateCornellBox(const float scale);
         static Model CreateBox(const glm::vec3& point0, const glm::vec3& point1, const Material& material);
         static Model CreateSphere(const glm::vec3& center, float radius, const Material& material, bool isProcedural);
@@ -19,17 +22,22 @@ namespace Resources
         Model() = default;
 
         void SetMaterial(const Material& material);
-        void SetTransform(const glm::mat4& transform);
+        void SetTransform(const glm::mat4& transform); // Bakes the transform into the vertices. Use instances to place the same geometry more than once.
+        void SetInstances(std::vector<ModelInstance>&& instances);
+        void SetDynamic(bool isDynamic) { m_IsDynamic = isDynamic; } // Dynamic models keep their own top level instances so they can be moved after the scene is built.
 
         const std::vector<Vertex>& GetVertices() const { return m_Vertices; }
         const std::vector<uint32_t>& GetIndices() const { return m_Indices; }
         const std::vector<Material>& GetMaterials() const { return m_Materials; }
+        const std::vector<ModelInstance>& GetInstances() const { return m_Instances; }
 
         const Procedural* GetProcedural() const { return m_Procedural.get(); }
+        bool IsDynamic() const { return m_IsDynamic; }
 
         uint32_t GetNumberOfVertices() const { return static_cast<uint32_t>(m_Vertices.size()); }
         uint32_t GetNumberOfIndices() const { return static_cast<uint32_t>(m_Indices.size()); }
         uint32_t GetNumberOfMaterials() const { return static_cast<uint32_t>(m_Materials.size()); }
+        uint32_t GetNumberOfInstances() const { return static_cast<uint32_t>(m_Instances.size()); }
 
     private:
         Model(std::vector<Vertex>&& vertices, std::vector<uint32_t>&& indices, std::vector<Material>&& materials, const class Procedural* procedural);
@@ -38,6 +46,8 @@ namespace Resources
         std::vector<Vertex> m_Vertices;
         std::vector<uint32_t> m_Indices;
         std::vector<Material> m_Materials;
+        std::vector<ModelInstance> m_Instances = { ModelInstance() };
+        bool m_IsDynamic = false;
         std::shared_ptr<const Procedural> m_Procedural;
     };
 }
\ No newline at end of file
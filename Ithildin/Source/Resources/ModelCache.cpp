@@ -0,0 +1,285 @@
+#include "ModelCache.h"
+#include "Core/MappedFile.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace Resources
+{
+    namespace ModelCacheUtilities
+    {
+        constexpr uint32_t g_Magic = 0x4D485449; // "ITHM"
+        constexpr uint32_t g_Version = 3;
+        constexpr uint64_t g_SectionAlignment = 16;
+
+        struct Header
+        {
+            uint32_t m_Magic;
+            uint32_t m_Version;
+            uint64_t m_SourceHash;
+
+            // Guards against the layout of our structures changing without the version being bumped.
+            uint32_t m_VertexSize;
+            uint32_t m_MaterialSize;
+
+            uint64_t m_VertexCount;
+            uint64_t m_IndexCount;
+            uint64_t m_MaterialCount;
+
+            // Byte offsets from the start of the file.
+            uint64_t m_VertexOffset;
+            uint64_t m_IndexOffset;
+            uint64_t m_MaterialOffset;
+            uint64_t m_LibraryOffset; // Paths of the .mtl files the source references, separated by new lines.
+            uint64_t m_LibrarySize;
+
+            glm::vec3 m_BoundsMinimum;
+            glm::vec3 m_BoundsMaximum;
+        };
+
+        uint64_t AlignUp(uint64_t value)
+        {
+            return (value + g_SectionAlignment - 1) & ~(g_SectionAlignment - 1);
+        }
+
+        void AddToHash(const void* data, size_t size, uint64_t& hash)
+        {
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+            for (size_t i = 0; i != size; ++i)
+            {
+                hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+            }
+        }
+
+        bool AddFileToHash(const std::string& filePath, uint64_t& hash)
+        {
+            std::error_code error;
+            const uint64_t fileSize = static_cast<uint64_t>(std::filesystem::file_size(filePath, error));
+
+            if (error)
+            {
+                return false;
+            }
+
+            const int64_t writeTime = static_cast<int64_t>(std::filesystem::last_write_time(filePath, error).time_since_epoch().count());
+
+            if (error)
+            {
+                return false;
+            }
+
+            const uint64_t values[] = { fileSize, static_cast<uint64_t>(writeTime) };
+            AddToHash(values, sizeof(values), hash);
+            return true;
+        }
+
+        // FNV-1a over the size and modification time of the source file and its material libraries, and the options it was processed with. Editing or replacing
+        // the OBJ or one of its .mtl files invalidates its cache. A missing library is hashed as such, so the cache is also invalidated once it appears.
+        bool GetSourceHash(const std::string& filePath, const std::vector<std::string>& materialLibraries, bool isOptimized, NormalGenerator::Weighting normalWeighting, uint64_t& hash)
+        {
+            hash = 0xcbf29ce484222325ull;
+
+            if (!AddFileToHash(filePath, hash))
+            {
+                return false;
+            }
+
+            for (const std::string& library : materialLibraries)
+            {
+                if (!AddFileToHash(library, hash))
+                {
+                    const uint64_t missingLibrary = std::numeric_limits<uint64_t>::max();
+                    AddToHash(&missingLibrary, sizeof(missingLibrary), hash);
+                }
+            }
+
+            const uint64_t options[] = { g_Version, isOptimized ? 1u : 0u, static_cast<uint64_t>(normalWeighting) };
+            AddToHash(options, sizeof(options), hash);
+            return true;
+        }
+
+        std::string JoinLibraries(const std::vector<std::string>& materialLibraries)
+        {
+            std::string libraries;
+
+            for (const std::string& library : materialLibraries)
+            {
+                libraries += library + '\n';
+            }
+
+            return libraries;
+        }
+
+        std::vector<std::string> SplitLibraries(const std::string& libraries)
+        {
+            std::vector<std::string> materialLibraries;
+            size_t begin = 0;
+
+            for (size_t end = libraries.find('\n'); end != std::string::npos; begin = end + 1, end = libraries.find('\n', begin))
+            {
+                materialLibraries.push_back(libraries.substr(begin, end - begin));
+            }
+
+            return materialLibraries;
+        }
+
+        bool IsSectionInFile(uint64_t offset, uint64_t count, uint64_t elementSize, uint64_t fileSize)
+        {
+            return offset <= fileSize && count <= (fileSize - offset) / elementSize;
+        }
+    }
+
+    std::string ModelCache::GetCachePath(const std::string& filePath)
+    {
+        return std::filesystem::path(filePath).replace_extension(".mesh").string();
+    }
+
+    bool ModelCache::Load(const std::string& filePath, bool isOptimized, NormalGenerator::Weighting normalWeighting, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<Material>& materials)
+    {
+        using namespace ModelCacheUtilities;
+
+        const MappedFile file(GetCachePath(filePath));
+
+        if (!file.IsValid() || file.GetSize() < sizeof(Header))
+        {
+            return false;
+        }
+
+        Header header = {};
+        std::memcpy(&header, file.GetData(), sizeof(Header));
+
+        if (header.m_Magic != g_Magic || header.m_Version != g_Version || header.m_VertexSize != sizeof(Vertex) || header.m_MaterialSize != sizeof(Material))
+        {
+            return false;
+        }
+
+        if (!IsSectionInFile(header.m_LibraryOffset, header.m_LibrarySize, 1, file.GetSize()))
+        {
+            std::cout << "Warning: Ignoring truncated mesh cache for " << filePath << ".\n";
+            return false;
+        }
+
+        // The libraries are those the source referenced when the cache was written. If the source has changed since, its own size or time already differs.
+        const std::string libraries(reinterpret_cast<const char*>(file.GetData() + header.m_LibraryOffset), header.m_LibrarySize);
+        uint64_t sourceHash = 0;
+
+        if (!GetSourceHash(filePath, SplitLibraries(libraries), isOptimized, normalWeighting, sourceHash) || header.m_SourceHash != sourceHash)
+        {
+            return false;
+        }
+
+        if (!IsSectionInFile(header.m_VertexOffset, header.m_VertexCount, sizeof(Vertex), file.GetSize()) ||
+            !IsSectionInFile(header.m_IndexOffset, header.m_IndexCount, sizeof(uint32_t), file.GetSize()) ||
+            !IsSectionInFile(header.m_MaterialOffset, header.m_MaterialCount, sizeof(Material), file.GetSize()))
+        {
+            std::cout << "Warning: Ignoring truncated mesh cache for " << filePath << ".\n";
+            return false;
+        }
+
+        vertices.resize(header.m_VertexCount);
+        indices.resize(header.m_IndexCount);
+        materials.resize(header.m_MaterialCount);
+
+        std::memcpy(vertices.data(), file.GetData() + header.m_VertexOffset, vertices.size() * sizeof(Vertex));
+        std::memcpy(indices.data(), file.GetData() + header.m_IndexOffset, indices.size() * sizeof(uint32_t));
+        std::memcpy(materials.data(), file.GetData() + header.m_MaterialOffset, materials.size() * sizeof(Material));
+
+        for (const uint32_t index : indices)
+        {
+            if (index >= vertices.size())
+            {
+                std::cout << "Warning: Ignoring corrupt mesh cache for " << filePath << ".\n";
+                return false;
+            }
+        }
+
+        std::cout << "Loaded Mesh Cache (Bounds: [" << header.m_BoundsMinimum.x << ", " << header.m_BoundsMinimum.y << ", " << header.m_BoundsMinimum.z << "] - ["
+                  << header.m_BoundsMaximum.x << ", " << header.m_BoundsMaximum.y << ", " << header.m_BoundsMaximum.z << "])\n";
+
+        return true;
+    }
+
+    void ModelCache::Save(const std::string& filePath, const std::vector<std::string>& materialLibraries, bool isOptimized, NormalGenerator::Weighting normalWeighting, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<Material>& materials)
+    {
+        using namespace ModelCacheUtilities;
+
+        Header header = {};
+        header.m_Magic = g_Magic;
+        header.m_Version = g_Version;
+        header.m_VertexSize = sizeof(Vertex);
+        header.m_MaterialSize = sizeof(Material);
+        header.m_VertexCount = vertices.size();
+        header.m_IndexCount = indices.size();
+        header.m_MaterialCount = materials.size();
+        header.m_VertexOffset = AlignUp(sizeof(Header));
+        header.m_IndexOffset = AlignUp(header.m_VertexOffset + vertices.size() * sizeof(Vertex));
+        header.m_MaterialOffset = AlignUp(header.m_IndexOffset + indices.size() * sizeof(uint32_t));
+
+        const std::string libraries = JoinLibraries(materialLibraries);
+        header.m_LibraryOffset = AlignUp(header.m_MaterialOffset + materials.size() * sizeof(Material));
+        header.m_LibrarySize = libraries.size();
+        header.m_BoundsMinimum = glm::vec3(std::numeric_limits<float>::max());
+        header.m_BoundsMaximum = glm::vec3(std::numeric_limits<float>::lowest());
+
+        if (!GetSourceHash(filePath, materialLibraries, isOptimized, normalWeighting, header.m_SourceHash))
+        {
+            return;
+        }
+
+        for (const Vertex& vertex : vertices)
+        {
+            header.m_BoundsMinimum = glm::min(header.m_BoundsMinimum, vertex.m_Position);
+            header.m_BoundsMaximum = glm::max(header.m_BoundsMaximum, vertex.m_Position);
+        }
+
+        // Write to a temporary file first so that a crash midway never leaves a truncated cache behind.
+        const std::string cachePath = GetCachePath(filePath);
+        const std::string temporaryPath = cachePath + ".tmp";
+        std::error_code error;
+
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+
+            if (!file)
+            {
+                std::cout << "Warning: Failed to create mesh cache " << temporaryPath << ".\n";
+                std::filesystem::remove(temporaryPath, error);
+                return;
+            }
+
+            const auto writeSection = [&file](uint64_t offset, const void* data, size_t size)
+            {
+                const char padding[g_SectionAlignment] = {};
+                file.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(file.tellp())));
+                file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            };
+
+            file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            writeSection(header.m_VertexOffset, vertices.data(), vertices.size() * sizeof(Vertex));
+            writeSection(header.m_IndexOffset, indices.data(), indices.size() * sizeof(uint32_t));
+            writeSection(header.m_MaterialOffset, materials.data(), materials.size() * sizeof(Material));
+            writeSection(header.m_LibraryOffset, libraries.data(), libraries.size());
+
+            // Closing flushes the last writes, and the partial file can only be removed once it is closed.
+            file.close();
+
+            if (!file)
+            {
+                std::cout << "Warning: Failed to write mesh cache " << temporaryPath << ".\n";
+                std::filesystem::remove(temporaryPath, error);
+                return;
+            }
+        }
+
+        std::filesystem::rename(temporaryPath, cachePath, error);
+
+        if (error)
+        {
+            std::cout << "Warning: Failed to write mesh cache " << cachePath << " (" << error.message() << ").\n";
+            std::filesystem::remove(temporaryPath, error);
+        }
+    }
+}
\ No newline at end of file
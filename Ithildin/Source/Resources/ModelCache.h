@@ -0,0 +1,24 @@
+#pragma once
+#include "Material.h"
+#include "NormalGenerator.h"
+#include "Vertex.h"
+#include <string>
+#include <vector>
+
+namespace Resources
+{
+    // Binary copy of a fully processed model (welded vertices, generated normals, indices and materials), stored next to its source file with a .mesh extension.
+    // Loading memory maps the file and copies each section straight into place, skipping parsing, welding and normal generation entirely.
+    class ModelCache final
+    {
+    public:
+        static std::string GetCachePath(const std::string& filePath);
+
+        // Returns false if there is no cache, or if it is out of date with the source file or its material libraries, was written with different processing options
+        // or by an incompatible build.
+        static bool Load(const std::string& filePath, bool isOptimized, NormalGenerator::Weighting normalWeighting, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<Material>& materials);
+
+        // Failing to write the cache is not fatal. The model will simply be imported again next time.
+        static void Save(const std::string& filePath, const std::vector<std::string>& materialLibraries, bool isOptimized, NormalGenerator::Weighting normalWeighting, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<Material>& materials);
+    };
+}
\ No newline at end of file
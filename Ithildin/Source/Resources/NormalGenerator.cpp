@@ -0,0 +1,154 @@
+#include "NormalGenerator.h"
+#include "Core/Parallel.h"
+#include <algorithm>
+
+namespace Resources
+{
+    namespace NormalGeneratorUtilities
+    {
+        constexpr size_t g_MinimumFacesPerWorker = 256 * 1024;
+        constexpr size_t g_MinimumVerticesPerWorker = 256 * 1024;
+
+        // Range of vertices touched by a worker's faces, along with the normals it accumulated for them.
+        struct Window
+        {
+            uint32_t m_First = 0;
+            uint32_t m_Last = 0;
+            std::vector<glm::vec3> m_Normals;
+        };
+
+        // Adds the normal of each face in [begin, end) to its vertices. The weighting and destination are compile time choices to keep them out of the inner loop.
+        template<NormalGenerator::Weighting TWeighting, typename TFunction>
+        void AccumulateFaces(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t begin, size_t end, const TFunction& getAccumulatedNormal)
+        {
+            for (size_t face = begin; face != end; ++face)
+            {
+                const uint32_t* faceIndices = &indices[face * 3];
+
+                // Refer to positions in place. Copying them out costs more than the cross product itself on some compilers.
+                const glm::vec3* positions[3] = { &vertices[faceIndices[0]].m_Position, &vertices[faceIndices[1]].m_Position, &vertices[faceIndices[2]].m_Position };
+                const glm::vec3 faceNormal = glm::cross(*positions[1] - *positions[0], *positions[2] - *positions[0]);
+
+                if (glm::dot(faceNormal, faceNormal) == 0.0f) // Degenerate triangles have no orientation to contribute.
+                {
+                    continue;
+                }
+
+                const glm::vec3 normal = glm::normalize(faceNormal);
+
+                for (uint32_t corner = 0; corner != 3; ++corner)
+                {
+                    if constexpr (TWeighting == NormalGenerator::Weighting::Angle)
+                    {
+                        const glm::vec3 edge0 = glm::normalize(*positions[(corner + 1) % 3] - *positions[corner]);
+                        const glm::vec3 edge1 = glm::normalize(*positions[(corner + 2) % 3] - *positions[corner]);
+
+                        getAccumulatedNormal(faceIndices[corner]) += normal * std::acos(glm::clamp(glm::dot(edge0, edge1), -1.0f, 1.0f));
+                    }
+                    else
+                    {
+                        getAccumulatedNormal(faceIndices[corner]) += normal;
+                    }
+                }
+            }
+        }
+
+        template<typename TFunction>
+        void AccumulateFaces(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, size_t begin, size_t end, NormalGenerator::Weighting weighting, const TFunction& getAccumulatedNormal)
+        {
+            if (weighting == NormalGenerator::Weighting::Angle)
+            {
+                AccumulateFaces<NormalGenerator::Weighting::Angle>(vertices, indices, begin, end, getAccumulatedNormal);
+            }
+            else
+            {
+                AccumulateFaces<NormalGenerator::Weighting::Uniform>(vertices, indices, begin, end, getAccumulatedNormal);
+            }
+        }
+    }
+
+    void NormalGenerator::Generate(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Weighting weighting, uint32_t workerCount)
+    {
+        using namespace NormalGeneratorUtilities;
+
+        const size_t faceCount = indices.size() / 3;
+
+        // Faces are split into contiguous ranges. The first worker accumulates straight into the vertices, while every other worker accumulates into a
+        // private window covering just the vertices its range touches. Welded models hand out vertex indices in first use order, so windows stay narrow.
+        const size_t maxWorkerCount = workerCount == 0 ? std::max<size_t>(1, faceCount / g_MinimumFacesPerWorker) : std::max<size_t>(1, faceCount);
+        workerCount = static_cast<uint32_t>(std::min<size_t>(workerCount == 0 ? Parallel::GetWorkerCount() : workerCount, maxWorkerCount));
+        std::vector<Window> windows(workerCount);
+
+        const auto getFaceRange = [&](uint32_t worker) { return std::make_pair(faceCount * worker / workerCount, faceCount * (worker + 1) / workerCount); };
+
+        if (workerCount > 1)
+        {
+            Parallel::ForEachWorker(workerCount - 1, [&](uint32_t worker)
+            {
+                const std::pair<size_t, size_t> faceRange = getFaceRange(worker + 1);
+                const auto bounds = std::minmax_element(indices.begin() + faceRange.first * 3, indices.begin() + faceRange.second * 3);
+
+                windows[worker + 1].m_First = *bounds.first;
+                windows[worker + 1].m_Last = *bounds.second;
+            });
+
+            size_t windowSize = 0;
+
+            for (uint32_t worker = 1; worker != workerCount; ++worker)
+            {
+                windowSize += windows[worker].m_Last - windows[worker].m_First + 1;
+            }
+
+            if (windowSize > vertices.size() * 2) // Scattered indices would make every window span most of the model. Serial accumulation is cheaper than that.
+            {
+                workerCount = 1;
+            }
+        }
+
+        Parallel::ForEachRange(vertices.size(), g_MinimumVerticesPerWorker, [&](size_t begin, size_t end, uint32_t)
+        {
+            for (size_t vertex = begin; vertex != end; ++vertex)
+            {
+                vertices[vertex].m_Normal = glm::vec3(0.0f);
+            }
+        });
+
+        Parallel::ForEachWorker(workerCount, [&](uint32_t worker)
+        {
+            const std::pair<size_t, size_t> faceRange = getFaceRange(worker);
+
+            if (worker == 0)
+            {
+                AccumulateFaces(vertices, indices, faceRange.first, faceRange.second, weighting, [&vertices](uint32_t vertex) -> glm::vec3& { return vertices[vertex].m_Normal; });
+                return;
+            }
+
+            Window& window = windows[worker];
+            window.m_Normals.resize(window.m_Last - window.m_First + 1, glm::vec3(0.0f));
+
+            AccumulateFaces(vertices, indices, faceRange.first, faceRange.second, weighting, [&window](uint32_t vertex) -> glm::vec3& { return window.m_Normals[vertex - window.m_First]; });
+        });
+
+        // Merge the windows in worker order, so the result does not depend on thread timing. With a single worker this is exactly the serial algorithm.
+        Parallel::ForEachRange(vertices.size(), g_MinimumVerticesPerWorker, [&](size_t begin, size_t end, uint32_t)
+        {
+            for (size_t vertex = begin; vertex != end; ++vertex)
+            {
+                glm::vec3& normal = vertices[vertex].m_Normal;
+
+                for (uint32_t worker = 1; worker < workerCount; ++worker)
+                {
+                    if (vertex >= windows[worker].m_First && vertex <= windows[worker].m_Last)
+                    {
+                        normal += windows[worker].m_Normals[vertex - windows[worker].m_First];
+                    }
+                }
+
+                if (glm::dot(normal, normal) > 0.0f)
+                {
+                    normal = glm::normalize(normal);
+                }
+            }
+        });
+    }
+}
\ No newline at end of file
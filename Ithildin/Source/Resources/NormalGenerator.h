@@ -0,0 +1,22 @@
+#pragma once
+#include "Vertex.h"
+#include <vector>
+
+namespace Resources
+{
+    // Generates smooth per-vertex normals from triangle lists, for geometry that did not come with its own.
+    class NormalGenerator final
+    {
+    public:
+        enum class Weighting
+        {
+            Uniform, // Every adjacent face contributes equally.
+            Angle    // Faces contribute by the angle they make at the vertex, which keeps normals stable regardless of how a surface is tessellated.
+        };
+
+        // Overwrites the normal of every vertex. Vertices that are not part of any non-degenerate triangle are left with a zero normal.
+        // Large meshes are spread over all avaliable cores, and partial sums are always combined in the same order, so the output does not depend on thread timing.
+        // A non-zero worker count replaces the core count and ignores the minimum number of faces per worker, so that --normals-test can exercise the parallel path on any machine.
+        static void Generate(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, Weighting weighting = Weighting::Uniform, uint32_t workerCount = 0);
+    };
+}
\ No newline at end of file
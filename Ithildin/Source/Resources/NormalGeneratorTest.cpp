@@ -0,0 +1,173 @@
+#include "NormalGeneratorTest.h"
+#include "NormalGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace Resources
+{
+    namespace NormalGeneratorTestUtilities
+    {
+        const uint32_t GridSize = 400; // 318K faces.
+        const uint32_t WorkerCounts[] = { 1, 2, 3, 8 };
+
+        // Partial sums are added in a different order than the serial loop adds them, which may move a normalized component by a few ulps.
+        const float Tolerance = 1e-5f;
+
+        // The loop the parallel generator replaced: every face adds its normal to its vertices in index order.
+        void GenerateSerial(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, NormalGenerator::Weighting weighting)
+        {
+            for (Vertex& vertex : vertices)
+            {
+                vertex.m_Normal = glm::vec3(0.0f);
+            }
+
+            for (size_t face = 0; face != indices.size() / 3; ++face)
+            {
+                const uint32_t* faceIndices = &indices[face * 3];
+                const glm::vec3 positions[3] = { vertices[faceIndices[0]].m_Position, vertices[faceIndices[1]].m_Position, vertices[faceIndices[2]].m_Position };
+                const glm::vec3 faceNormal = glm::cross(positions[1] - positions[0], positions[2] - positions[0]);
+
+                if (glm::dot(faceNormal, faceNormal) == 0.0f)
+                {
+                    continue;
+                }
+
+                const glm::vec3 normal = glm::normalize(faceNormal);
+
+                for (uint32_t corner = 0; corner != 3; ++corner)
+                {
+                    float weight = 1.0f;
+
+                    if (weighting == NormalGenerator::Weighting::Angle)
+                    {
+                        const glm::vec3 edge0 = glm::normalize(positions[(corner + 1) % 3] - positions[corner]);
+                        const glm::vec3 edge1 = glm::normalize(positions[(corner + 2) % 3] - positions[corner]);
+
+                        weight = std::acos(glm::clamp(glm::dot(edge0, edge1), -1.0f, 1.0f));
+                    }
+
+                    vertices[faceIndices[corner]].m_Normal += normal * weight;
+                }
+            }
+
+            for (Vertex& vertex : vertices)
+            {
+                if (glm::dot(vertex.m_Normal, vertex.m_Normal) > 0.0f)
+                {
+                    vertex.m_Normal = glm::normalize(vertex.m_Normal);
+                }
+            }
+        }
+
+        // A bumpy heightfield with jittered vertices, numbered row by row like a welded model.
+        void CreateGrid(std::mt19937& engine, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+        {
+            std::uniform_real_distribution<float> jitter(-0.3f, 0.3f);
+
+            vertices.clear();
+            indices.clear();
+
+            for (uint32_t y = 0; y != GridSize; ++y)
+            {
+                for (uint32_t x = 0; x != GridSize; ++x)
+                {
+                    Vertex vertex = {};
+                    vertex.m_Position = glm::vec3(x + jitter(engine), std::sin(x * 0.1f) * std::cos(y * 0.07f) * 5.0f + jitter(engine), y + jitter(engine));
+                    vertices.push_back(vertex);
+                }
+            }
+
+            for (uint32_t y = 0; y + 1 != GridSize; ++y)
+            {
+                for (uint32_t x = 0; x + 1 != GridSize; ++x)
+                {
+                    const uint32_t corner = y * GridSize + x;
+                    indices.insert(indices.end(), { corner, corner + 1, corner + GridSize + 1, corner, corner + GridSize + 1, corner + GridSize });
+                }
+            }
+        }
+
+        void Check(std::vector<NormalGeneratorTest::Result>& results, const std::string& name, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+        {
+            for (const NormalGenerator::Weighting weighting : { NormalGenerator::Weighting::Uniform, NormalGenerator::Weighting::Angle })
+            {
+                std::vector<Vertex> expectedVertices = vertices;
+                GenerateSerial(expectedVertices, indices, weighting);
+
+                for (const uint32_t workerCount : WorkerCounts)
+                {
+                    std::vector<Vertex> generatedVertices = vertices;
+                    NormalGenerator::Generate(generatedVertices, indices, weighting, workerCount);
+
+                    NormalGeneratorTest::Result result = {};
+                    result.m_Case = name;
+                    result.m_Weighting = weighting == NormalGenerator::Weighting::Angle ? "Angle" : "Uniform";
+                    result.m_WorkerCount = workerCount;
+                    result.m_VertexCount = vertices.size();
+
+                    for (size_t vertex = 0; vertex != vertices.size(); ++vertex)
+                    {
+                        const glm::vec3 deviation = glm::abs(generatedVertices[vertex].m_Normal - expectedVertices[vertex].m_Normal);
+                        const float maxDeviation = std::max({ deviation.x, deviation.y, deviation.z });
+
+                        // A NaN deviation fails the comparison as well.
+                        if (!(maxDeviation <= Tolerance))
+                        {
+                            result.m_MismatchCount++;
+                        }
+
+                        result.m_MaxDeviation = std::max(result.m_MaxDeviation, maxDeviation);
+                    }
+
+                    results.push_back(result);
+                }
+            }
+        }
+    }
+
+    std::vector<NormalGeneratorTest::Result> NormalGeneratorTest::Run(uint32_t seed)
+    {
+        using namespace NormalGeneratorTestUtilities;
+
+        std::mt19937 engine(seed);
+        std::vector<Result> results;
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+
+        CreateGrid(engine, vertices, indices);
+        Check(results, "Grid", vertices, indices);
+
+        // Whole faces move, so every worker's window spans nearly the whole model. Few workers still run in parallel with wide windows, many fall back to serial accumulation.
+        {
+            std::vector<uint32_t> faces(indices.size() / 3);
+
+            for (uint32_t face = 0; face != faces.size(); ++face)
+            {
+                faces[face] = face;
+            }
+
+            std::shuffle(faces.begin(), faces.end(), engine);
+            std::vector<uint32_t> shuffledIndices;
+            shuffledIndices.reserve(indices.size());
+
+            for (const uint32_t face : faces)
+            {
+                shuffledIndices.insert(shuffledIndices.end(), indices.begin() + face * 3, indices.begin() + face * 3 + 3);
+            }
+
+            Check(results, "Shuffled faces", vertices, shuffledIndices);
+        }
+
+        // Collapsing every 17th vertex onto its neighbour leaves zero area faces, and vertices past the grid are used by no face at all.
+        for (size_t vertex = 0; vertex + 1 < vertices.size(); vertex += 17)
+        {
+            vertices[vertex].m_Position = vertices[vertex + 1].m_Position;
+        }
+
+        vertices.resize(vertices.size() + 1000, Vertex{});
+        Check(results, "Degenerate and unused vertices", vertices, indices);
+
+        return results;
+    }
+}
\ No newline at end of file
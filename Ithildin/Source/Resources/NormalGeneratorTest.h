@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Resources
+{
+    // Checks the parallel normal generator against a plain serial loop over the faces, with both weightings and a range of worker counts.
+    // The meshes are a welded grid, the same grid with its faces shuffled so that every window spans nearly the whole model, and a grid with collapsed and unused vertices.
+    class NormalGeneratorTest final
+    {
+    public:
+        struct Result
+        {
+            std::string m_Case;            // For example "Grid" or "Shuffled faces".
+            std::string m_Weighting;       // "Uniform" or "Angle".
+            uint32_t m_WorkerCount = 0;
+            uint64_t m_VertexCount = 0;
+            float m_MaxDeviation = 0.0f;   // Largest difference of a normal component from the serial result.
+            uint64_t m_MismatchCount = 0;  // Vertices that deviate by more than rounding can explain.
+        };
+
+        // The same seed generates the same meshes.
+        static std::vector<Result> Run(uint32_t seed);
+    };
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Vulkan/VulkanDebugUtilities.h"
 #include "Vulkan/VulkanBuffer.h"
 #include "Vulkan/VulkanBufferUtilities.h"
+#include "Vulkan/VulkanUploadManager.h"
 #include "Vulkan/VulkanImage.h"
 #include "Vulkan/VulkanImageView.h"
 #include "Vulkan/SingleTimeCommands.h"
@@ -12,11 +13,15 @@
 #include "Model.h"
 #include "Vertex.h"
 #include "Sphere.h"
+#include "Instance.h"
+#include "Core/Parallel.h"
+#include <limits>
+#include <stdexcept>
 
 namespace Resources
 {
 
-    Scene::Scene(Vulkan::VulkanCommandPool& commandPool, std::vector<Model>&& models, std::vector<Texture>&& textures, bool usedForRayTracing)
+    Scene::Scene(Vulkan::VulkanUploadManager& uploadManager, std::vector<Model>&& models, std::vector<Texture>&& textures, bool usedForRayTracing)
         : m_Models(std::move(models)), m_Textures(std::move(textures))
     {
         // Concatenate all the models in our scene.
@@ -25,7 +30,7 @@ namespace Resources
         std::vector<Material> materials;
         std::vector<glm::vec4> procedurals;
         std::vector<VkAabbPositionsKHR> aabbs; // Specifying two opposing corners of an axis-aligned bounding box.
-        std::vector<glm::uvec2> offsets;
+        std::vector<InstanceData> instances;
 
         for (const auto& model : m_Models)
         {
@@ -33,8 +38,7 @@ namespace Resources
             const uint32_t indexOffset = static_cast<uint32_t>(indices.size());
             const uint32_t vertexOffset = static_cast<uint32_t>(vertices.size());
             const uint32_t materialOffset = static_cast<uint32_t>(materials.size());
-
-            offsets.emplace_back(indexOffset, vertexOffset);
+            m_FirstInstances.push_back(static_cast<uint32_t>(instances.size()));
 
             // Copy model data one after the other by appending to the end of our vector.
             vertices.insert(vertices.end(), model.GetVertices().begin(), model.GetVertices().end());
@@ -47,6 +51,25 @@ namespace Resources
                 vertices[i].m_MaterialIndex += materialOffset;
             }
 
+            // Every instance shares the model's geometry. Instances that replace the model's materials get their own material entry.
+            for (const ModelInstance& instance : model.GetInstances())
+            {
+                InstanceData instanceData = {};
+                instanceData.m_Transform = instance.m_Transform;
+                instanceData.m_IndexOffset = indexOffset;
+                instanceData.m_VertexOffset = vertexOffset;
+                instanceData.m_MaterialIndex = -1;
+                instanceData.m_ModelIndex = static_cast<uint32_t>(&model - m_Models.data());
+
+                if (instance.m_Material)
+                {
+                    instanceData.m_MaterialIndex = static_cast<int32_t>(materials.size());
+                    materials.push_back(*instance.m_Material);
+                }
+
+                instances.push_back(instanceData);
+            }
+
             // Add optional procedurals.
             const Sphere* const sphere = dynamic_cast<const Sphere*>(model.GetProcedural());
             if (sphere != nullptr)
@@ -62,15 +85,35 @@ namespace Resources
             }
         }
 
+        // Split the vertices into full precision positions, for the acceleration structures and rasterizer, and compressed attributes for shading.
+        if (materials.size() > std::numeric_limits<uint16_t>::max())
+        {
+            throw std::runtime_error("Scene has more materials than compressed vertices can address.");
+        }
+
+        std::vector<glm::vec3> positions(vertices.size());
+        std::vector<CompressedVertex> compressedVertices(vertices.size());
+
+        Parallel::ForEachRange(vertices.size(), 64 * 1024, [&](size_t begin, size_t end, uint32_t)
+        {
+            for (size_t i = begin; i != end; ++i)
+            {
+                positions[i] = vertices[i].m_Position;
+                compressedVertices[i] = vertices[i].Compress();
+            }
+        });
+
+        // Every upload below is batched into as few transfer queue submissions as the staging memory allows, with a single wait at the end.
         const int flag = usedForRayTracing ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR : 0;
 
-        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(commandPool, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | flag, vertices, m_VertexBuffer, m_VertexBufferMemory);
-        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(commandPool, "Indices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | flag, indices, m_IndexBuffer, m_IndexBufferMemory);
-        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(commandPool, "Materials", flag, materials, m_MaterialBuffer, m_MaterialBufferMemory);
-        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(commandPool, "Offsets", flag, offsets, m_OffsetBuffer, m_OffsetBufferMemory);
+        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(uploadManager, "Positions", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | flag, positions, m_PositionBuffer, m_PositionBufferMemory);
+        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(uploadManager, "Vertices", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | flag, compressedVertices, m_VertexBuffer, m_VertexBufferMemory);
+        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(uploadManager, "Indices", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | flag, indices, m_IndexBuffer, m_IndexBufferMemory);
+        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(uploadManager, "Materials", flag, materials, m_MaterialBuffer, m_MaterialBufferMemory);
+        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(uploadManager, "Instances", VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | flag, instances, m_InstanceBuffer, m_InstanceBufferMemory);
 
-        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(commandPool, "AA BBs", flag, aabbs, m_AABBBuffer, m_AABBBufferMemory);
-        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(commandPool, "Procedurals", flag, procedurals, m_ProceduralBuffer, m_ProceduralBufferMemory);
+        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(uploadManager, "AA BBs", flag, aabbs, m_AABBBuffer, m_AABBBufferMemory);
+        Vulkan::VulkanBufferUtilities::CreateDeviceBuffer(uploadManager, "Procedurals", flag, procedurals, m_ProceduralBuffer, m_ProceduralBufferMemory);
 
         // Update all textures.
         m_TextureImages.reserve(m_Textures.size());
@@ -79,10 +122,12 @@ namespace Resources
 
         for (size_t i = 0; i != m_Textures.size(); ++i)
         {
-            m_TextureImages.emplace_back(new TextureImage(commandPool, m_Textures[i]));
+            m_TextureImages.emplace_back(new TextureImage(uploadManager, m_Textures[i]));
             m_TextureImageViews[i] = m_TextureImages[i]->GetImageView().GetHandle();
             m_TextureSamplers[i] = m_TextureImages[i]->GetSampler().GetHandle();
         }
+
+        uploadManager.Wait();
     }
 
     Scene::~Scene()
@@ -95,13 +140,15 @@ namespace Resources
         m_ProceduralBufferMemory.reset(); // Release memory after bound buffer has been destroyed.
         m_AABBBuffer.reset();
         m_AABBBufferMemory.reset();       // Release memory after bound buffer has been destroyed.
-        m_OffsetBuffer.reset();
-        m_OffsetBufferMemory.reset();     // Release memory after bound buffer has been destroyed.
+        m_InstanceBuffer.reset();
+        m_InstanceBufferMemory.reset();   // Release memory after bound buffer has been destroyed.
         m_MaterialBuffer.reset();
         m_MaterialBufferMemory.reset();   // Release memory after bound buffer has been destroyed.
         m_IndexBuffer.reset();
         m_IndexBufferMemory.reset();      // Release memory after bound buffer has been destroyed.
         m_VertexBuffer.reset();
         m_VertexBufferMemory.reset();     // Release memory after bound buffer has been destroyed.
+        m_PositionBuffer.reset();
+        m_PositionBufferMemory.reset();   // Release memory after bound buffer has been destroyed.
     }
 }
\ No newline at end of file
@@ -7,9 +7,9 @@
 namespace Vulkan
 {
     class VulkanBuffer;
-    class VulkanCommandPool;
     class VulkanDeviceMemory;
     class VulkanImage;
+    class VulkanUploadManager;
 }
 
 namespace Resources
@@ -21,16 +21,19 @@ namespace Resources
     class Scene final
     {
     public:
-        Scene(Vulkan::VulkanCommandPool& commandPool, std::vector<Model>&& models, std::vector<Texture>&& textures, bool usedForRayTracing);
+        Scene(Vulkan::VulkanUploadManager& uploadManager, std::vector<Model>&& models, std::vector<Texture>&& textures, bool usedForRayTracing);
         ~Scene();
         
          const std::vector<Model>& GetModels() const { return m_Models; }
+        const std::vector<Texture>& GetTextures() const { return m_Textures; } // Host copies, kept for the CPU renderer.
         bool HasProcedurals() const { return static_cast<bool>(m_ProceduralBuffer); }
 
-        const Vulkan::VulkanBuffer& GetVertexBuffer() const { return *m_VertexBuffer; }
+        const Vulkan::VulkanBuffer& GetPositionBuffer() const { return *m_PositionBuffer; } // Full precision vertex positions (glm::vec3).
+        const Vulkan::VulkanBuffer& GetVertexBuffer() const { return *m_VertexBuffer; }     // Compressed vertex shading attributes (CompressedVertex).
         const Vulkan::VulkanBuffer& GetIndexBuffer() const { return *m_IndexBuffer; }
         const Vulkan::VulkanBuffer& GetMaterialBuffer() const { return *m_MaterialBuffer; }
-        const Vulkan::VulkanBuffer& GetOffsetBuffer() const { return *m_OffsetBuffer; }
+        const Vulkan::VulkanBuffer& GetInstanceBuffer() const { return *m_InstanceBuffer; } // One InstanceData per model instance, in model order.
+        uint32_t GetInstanceIndex(uint32_t modelIndex, uint32_t instanceIndex) const { return m_FirstInstances[modelIndex] + instanceIndex; } // Position in the instance buffer.
         const Vulkan::VulkanBuffer& GetAABBBuffer() const { return *m_AABBBuffer; }
         const Vulkan::VulkanBuffer& GetProceduralBuffer() const { return *m_ProceduralBuffer; }
         const std::vector<VkImageView>& GetTextureImageViews() const { return m_TextureImageViews; }
@@ -39,6 +42,10 @@ namespace Resources
     private:
         const std::vector<Model> m_Models;
         const std::vector<Texture> m_Textures;
+        std::vector<uint32_t> m_FirstInstances; // Of each model in the instance buffer.
+
+        std::unique_ptr<Vulkan::VulkanBuffer> m_PositionBuffer;
+        std::unique_ptr<Vulkan::VulkanDeviceMemory> m_PositionBufferMemory;
 
         std::unique_ptr<Vulkan::VulkanBuffer> m_VertexBuffer;
         std::unique_ptr<Vulkan::VulkanDeviceMemory> m_VertexBufferMemory;
@@ -49,8 +56,8 @@ namespace Resources
         std::unique_ptr<Vulkan::VulkanBuffer> m_MaterialBuffer;
         std::unique_ptr<Vulkan::VulkanDeviceMemory> m_MaterialBufferMemory;
 
-        std::unique_ptr<Vulkan::VulkanBuffer> m_OffsetBuffer;
-        std::unique_ptr<Vulkan::VulkanDeviceMemory> m_OffsetBufferMemory;
+        std::unique_ptr<Vulkan::VulkanBuffer> m_InstanceBuffer;
+        std::unique_ptr<Vulkan::VulkanDeviceMemory> m_InstanceBufferMemory;
 
         std::unique_ptr<Vulkan::VulkanBuffer> m_AABBBuffer;
         std::unique_ptr<Vulkan::VulkanDeviceMemory> m_AABBBufferMemory;
@@ -3,39 +3,24 @@
 #include "Vulkan/VulkanDevice.h"
 #include "Vulkan/VulkanImage.h"
 #include "Vulkan/VulkanImageView.h"
-#include "Vulkan/VulkanCommandPool.h"
-#include "Vulkan/VulkanBuffer.h"
+#include "Vulkan/VulkanUploadManager.h"
 #include "Vulkan/VulkanSampler.h"
 #include "Texture.h"
 
 namespace Resources
 {
-    TextureImage::TextureImage(Vulkan::VulkanCommandPool& commandPool, const Texture& texture)
+    TextureImage::TextureImage(Vulkan::VulkanUploadManager& uploadManager, const Texture& texture)
     {
-        // Create a host staging buffer and copy the image into it.
-        const VkDeviceSize imageSize = texture.GetWidth() * texture.GetHeight() * 4; // Width Pixels * Height Pixels * Components Per Pixel
-        const Vulkan::VulkanDevice& device = commandPool.GetDevice();
-
-        std::unique_ptr<Vulkan::VulkanBuffer> stagingBuffer = std::make_unique<Vulkan::VulkanBuffer>(device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-        Vulkan::VulkanDeviceMemory stagingBufferMemory = stagingBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-
-        const auto pointerToGPUBuffer = stagingBufferMemory.Map(0, imageSize);
-        std::memcpy(pointerToGPUBuffer, texture.GetPixels(), imageSize); // Copy pixels into our memory.
-        stagingBufferMemory.Unmap();
+        const Vulkan::VulkanDevice& device = uploadManager.GetDevice();
 
         // Create the device side image, memory, view and sampler.
         m_Image.reset(new Vulkan::VulkanImage(device, VkExtent2D{ static_cast<uint32_t>(texture.GetWidth()), static_cast<uint32_t>(texture.GetHeight()) }, VK_FORMAT_R8G8B8A8_UNORM));
-        m_ImageMemory.reset(new Vulkan::VulkanDeviceMemory(m_Image->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+        m_ImageMemory.reset(new Vulkan::VulkanDeviceMemory(m_Image->AllocateMemory(Vulkan::MemoryUsage::DeviceLocal)));
         m_ImageView.reset(new Vulkan::VulkanImageView(device, m_Image->GetHandle(), m_Image->GetFormat(), VK_IMAGE_ASPECT_COLOR_BIT));
         m_ImageSampler.reset(new Vulkan::VulkanSampler(device, Vulkan::SamplerConfiguration()));
 
-        // Transfer the data to device side.
-        m_Image->TransitionImageLayout(commandPool, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-        m_Image->CopyFrom(commandPool, *stagingBuffer);
-        m_Image->TransitionImageLayout(commandPool, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-
-        // Delete the buffer before the memory frees at the end of this scope.
-        stagingBuffer.reset();
+        // Transfer the pixels to the device side, leaving the image ready for sampling.
+        uploadManager.UploadImage(*m_Image, texture.GetPixels());
     }
 
     TextureImage::~TextureImage()
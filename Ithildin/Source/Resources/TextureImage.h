@@ -3,11 +3,11 @@
 
 namespace Vulkan
 {
-    class VulkanCommandPool;
     class VulkanDeviceMemory;
     class VulkanImage;
     class VulkanImageView;
     class VulkanSampler;
+    class VulkanUploadManager;
 }
 
 namespace Resources
@@ -17,7 +17,7 @@ namespace Resources
     class TextureImage final
     {
     public:
-        TextureImage(Vulkan::VulkanCommandPool& commandPool, const Texture& texture);
+        TextureImage(Vulkan::VulkanUploadManager& uploadManager, const Texture& texture); // The upload is only complete once the upload manager has been waited on.
         ~TextureImage();
 
         const Vulkan::VulkanImageView& GetImageView() const { return *m_ImageView; }
@@ -2,32 +2,54 @@
 #include "Vulkan/VulkanDevice.h"
 #include "Vulkan/VulkanDeviceMemory.h"
 #include "vulkan/VulkanBuffer.h"
+#include <cstring>
 
 namespace Resources
 {
-    UniformBuffer::UniformBuffer(const Vulkan::VulkanDevice& device)
+    UniformBuffer::UniformBuffer(const Vulkan::VulkanDevice& device, uint32_t slotCount) : m_Device(device), m_SlotCount(slotCount)
     {
-        const size_t bufferSize = sizeof(UniformBufferObject);
+        // Descriptors can only point at slots that start on this alignment.
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(device.GetPhysicalDevice(), &deviceProperties);
+
+        const size_t alignment = static_cast<size_t>(std::max<VkDeviceSize>(1, deviceProperties.limits.minUniformBufferOffsetAlignment));
+        m_SlotStride = ((sizeof(UniformBufferObject) + alignment - 1) / alignment) * alignment;
+
+        const size_t bufferSize = m_SlotStride * slotCount;
 
         m_Buffer.reset(new Vulkan::VulkanBuffer(device, bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT));
-        m_Memory.reset(new Vulkan::VulkanDeviceMemory(m_Buffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)));
-    }
+        m_Memory.reset(new Vulkan::VulkanDeviceMemory(m_Buffer->AllocateMemory(Vulkan::MemoryUsage::HostToDevice)));
+        m_MappedData = static_cast<uint8_t*>(m_Memory->Map(0, bufferSize)); // Stays mapped for the lifetime of the buffer.
 
-    UniformBuffer::UniformBuffer(UniformBuffer&& otherBuffer) noexcept : m_Buffer(otherBuffer.m_Buffer.release()), m_Memory(otherBuffer.m_Memory.release())
-    {
+        device.GetDebugUtilities().SetObjectName(m_Buffer->GetHandle(), "Uniform Buffer");
+
+        VkMemoryAllocateInfo allocationInfoDescription = {};
+        allocationInfoDescription.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocationInfoDescription.allocationSize = sizeof(UniformBufferObject);
+        allocationInfoDescription.memoryTypeIndex = device.FindMemoryType(m_Buffer->GetMemoryRequirements().memoryTypeBits, Vulkan::MemoryUsage::HostToDevice);
 
+        Vulkan::CheckResult(vkAllocateMemory(device.GetHandle(), &allocationInfoDescription, nullptr, &m_MapUnmapMemory), "Memory Allocation");
     }
 
     UniformBuffer::~UniformBuffer()
     {
+        m_MappedData = nullptr;
         m_Buffer.reset();
         m_Memory.reset(); // Release memory after bound buffer has been destroyed.
+
+        vkFreeMemory(m_Device.GetHandle(), m_MapUnmapMemory, nullptr);
+    }
+
+    void UniformBuffer::SetValue(uint32_t slot, const UniformBufferObject& uniformBufferObject)
+    {
+        std::memcpy(m_MappedData + GetSlotOffset(slot), &uniformBufferObject, sizeof(uniformBufferObject));
     }
 
-    void UniformBuffer::SetValue(const UniformBufferObject& uniformBufferObject)
+    void UniformBuffer::SetValueWithMapUnmap(const UniformBufferObject& uniformBufferObject)
     {
-        const auto dataPointer = m_Memory->Map(0, sizeof(UniformBufferObject));
+        void* dataPointer;
+        Vulkan::CheckResult(vkMapMemory(m_Device.GetHandle(), m_MapUnmapMemory, 0, sizeof(UniformBufferObject), 0, &dataPointer), "Map Memory");
         std::memcpy(dataPointer, &uniformBufferObject, sizeof(uniformBufferObject));
-        m_Memory->Unmap();
+        vkUnmapMemory(m_Device.GetHandle(), m_MapUnmapMemory);
     }
 }
\ No newline at end of file
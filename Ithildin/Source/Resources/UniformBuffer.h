@@ -1,4 +1,5 @@
 #pragma once
+#include "Core/Core.h"
 #include "Math/Math.h"
 #include <memory>
 
@@ -29,19 +30,34 @@ namespace Resources
         uint32_t m_ShowHeatMap; // Bool
     };
 
+    // Uniform data for every frame in flight, held as a ring of slots in one buffer that stays mapped for its lifetime.
+    // Each frame writes its own slot, so the host never overwrites data that the GPU may still be reading.
     class UniformBuffer
     {
     public:
-        explicit UniformBuffer(const Vulkan::VulkanDevice& device);
-        UniformBuffer(UniformBuffer&& otherBuffer) noexcept;
+        UniformBuffer(const Vulkan::VulkanDevice& device, uint32_t slotCount);
         ~UniformBuffer();
 
         const Vulkan::VulkanBuffer& GetBuffer() const { return *m_Buffer; }
+        uint32_t GetSlotCount() const { return m_SlotCount; }
+        size_t GetSlotOffset(uint32_t slot) const { return slot * m_SlotStride; }
+        size_t GetSlotSize() const { return sizeof(UniformBufferObject); }
 
-        void SetValue(const UniformBufferObject& uniformBufferObject);
+        void SetValue(uint32_t slot, const UniformBufferObject& uniformBufferObject);
+
+        // The write the ring replaced, kept so that the overlay can compare the two. Maps a separate memory object of the same type, copies the uniforms
+        // and unmaps it again, as each per-image uniform buffer used to every frame. The GPU never reads this copy.
+        void SetValueWithMapUnmap(const UniformBufferObject& uniformBufferObject);
 
     private:
+        const Vulkan::VulkanDevice& m_Device;
         std::unique_ptr<Vulkan::VulkanBuffer> m_Buffer;
         std::unique_ptr<Vulkan::VulkanDeviceMemory> m_Memory;
+        uint8_t* m_MappedData = nullptr;
+
+        uint32_t m_SlotCount = 0;
+        size_t m_SlotStride = 0; // Slot size rounded up to the device's uniform buffer offset alignment.
+
+        VkDeviceMemory m_MapUnmapMemory = nullptr; // Allocated straight from the driver, as the memory allocator keeps its blocks mapped.
     };
 }
\ No newline at end of file
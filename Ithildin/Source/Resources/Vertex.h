@@ -1,10 +1,22 @@
 #pragma once
 #include "Math/Math.h"
 #include "Core/Core.h"
+#include "Instance.h"
+#include <GLM/gtc/packing.hpp>
 #include <array>
+#include <cmath>
 
 namespace Resources
 {
+    // Shading attributes of a vertex as stored on the GPU, at a third of the size of a full vertex.
+    struct CompressedVertex final
+    {
+        uint32_t m_Normal;        // Octahedral encoding as 2x 16 bit signed normalized values.
+        uint32_t m_TexCoords;     // 2x 16 bit floats.
+        uint16_t m_MaterialIndex;
+        uint16_t m_Padding;
+    };
+
     struct Vertex final
     {
         glm::vec3 m_Position;
@@ -20,39 +32,86 @@ namespace Resources
                    m_MaterialIndex == otherVertex.m_MaterialIndex;
         }
 
-        static VkVertexInputBindingDescription GetBindingDescription() // Specify our vertex's input binding description.
+        // Packs the shading attributes. Positions are not part of the result and are uploaded separately at full precision.
+        CompressedVertex Compress() const
         {
-            VkVertexInputBindingDescription bindingDescription = {};
-            bindingDescription.binding = 0;
-            bindingDescription.stride = sizeof(Vertex);
-            bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // Specify the rate at which vertex attributes are pulled from the buffer (vertex/instance).
+            // Octahedral encoding. Project onto the octahedron |x| + |y| + |z| = 1, then fold the lower hemisphere over the diagonals of the upper one.
+            const float manhattanLength = std::abs(m_Normal.x) + std::abs(m_Normal.y) + std::abs(m_Normal.z);
+            glm::vec2 octahedral(0.0f);
+
+            if (manhattanLength > 0.0f)
+            {
+                const glm::vec3 projected = m_Normal / manhattanLength;
+                const glm::vec2 signs(projected.x >= 0.0f ? 1.0f : -1.0f, projected.y >= 0.0f ? 1.0f : -1.0f);
 
-            return bindingDescription;
+                octahedral = projected.z >= 0.0f ? glm::vec2(projected.x, projected.y) : (1.0f - glm::abs(glm::vec2(projected.y, projected.x))) * signs;
+            }
+
+            CompressedVertex compressedVertex = {};
+            compressedVertex.m_Normal = glm::packSnorm2x16(octahedral);
+            compressedVertex.m_TexCoords = glm::packHalf2x16(m_TexCoords);
+            compressedVertex.m_MaterialIndex = static_cast<uint16_t>(m_MaterialIndex);
+
+            return compressedVertex;
         }
 
-        static std::array<VkVertexInputAttributeDescription, 4> GetAttributeDescriptions()
+        // Vertices are drawn from three streams: full precision positions in binding 0, compressed shading attributes in binding 1, and per instance data in binding 2.
+        static std::array<VkVertexInputBindingDescription, 3> GetBindingDescriptions()
         {
-            std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions = {};
+            std::array<VkVertexInputBindingDescription, 3> bindingDescriptions = {};
+
+            bindingDescriptions[0].binding = 0;
+            bindingDescriptions[0].stride = sizeof(glm::vec3);
+            bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX; // Specify the rate at which vertex attributes are pulled from the buffer (vertex/instance).
+
+            bindingDescriptions[1].binding = 1;
+            bindingDescriptions[1].stride = sizeof(CompressedVertex);
+            bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+            bindingDescriptions[2].binding = 2;
+            bindingDescriptions[2].stride = sizeof(InstanceData);
+            bindingDescriptions[2].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+            return bindingDescriptions;
+        }
+
+        static std::array<VkVertexInputAttributeDescription, 9> GetAttributeDescriptions()
+        {
+            std::array<VkVertexInputAttributeDescription, 9> attributeDescriptions = {};
 
             attributeDescriptions[0].binding  = 0;
             attributeDescriptions[0].location = 0;
             attributeDescriptions[0].format   = VK_FORMAT_R32G32B32_SFLOAT;
-            attributeDescriptions[0].offset   = offsetof(Vertex, m_Position);
+            attributeDescriptions[0].offset   = 0;
 
-            attributeDescriptions[1].binding  = 0;
+            attributeDescriptions[1].binding  = 1;
             attributeDescriptions[1].location = 1;
-            attributeDescriptions[1].format   = VK_FORMAT_R32G32B32_SFLOAT;
-            attributeDescriptions[1].offset   = offsetof(Vertex, m_Normal);
+            attributeDescriptions[1].format   = VK_FORMAT_R16G16_SNORM;
+            attributeDescriptions[1].offset   = offsetof(CompressedVertex, m_Normal);
 
-            attributeDescriptions[2].binding  = 0;
+            attributeDescriptions[2].binding  = 1;
             attributeDescriptions[2].location = 2;
-            attributeDescriptions[2].format   = VK_FORMAT_R32G32_SFLOAT;
-            attributeDescriptions[2].offset   = offsetof(Vertex, m_TexCoords);
+            attributeDescriptions[2].format   = VK_FORMAT_R16G16_SFLOAT;
+            attributeDescriptions[2].offset   = offsetof(CompressedVertex, m_TexCoords);
 
-            attributeDescriptions[3].binding  = 0;
+            attributeDescriptions[3].binding  = 1;
             attributeDescriptions[3].location = 3;
-            attributeDescriptions[3].format   = VK_FORMAT_R32_SINT;
-            attributeDescriptions[3].offset   = offsetof(Vertex, m_MaterialIndex);
+            attributeDescriptions[3].format   = VK_FORMAT_R16_UINT;
+            attributeDescriptions[3].offset   = offsetof(CompressedVertex, m_MaterialIndex);
+
+            // A matrix attribute occupies one location per column.
+            for (uint32_t column = 0; column != 4; ++column)
+            {
+                attributeDescriptions[4 + column].binding  = 2;
+                attributeDescriptions[4 + column].location = 4 + column;
+                attributeDescriptions[4 + column].format   = VK_FORMAT_R32G32B32A32_SFLOAT;
+                attributeDescriptions[4 + column].offset   = offsetof(InstanceData, m_Transform) + column * sizeof(glm::vec4);
+            }
+
+            attributeDescriptions[8].binding  = 2;
+            attributeDescriptions[8].location = 8;
+            attributeDescriptions[8].format   = VK_FORMAT_R32_SINT;
+            attributeDescriptions[8].offset   = offsetof(InstanceData, m_MaterialIndex);
 
             return attributeDescriptions;
         }
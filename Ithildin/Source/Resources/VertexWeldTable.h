@@ -0,0 +1,124 @@
+#pragma once
+#include "Vertex.h"
+#include <cstring>
+#include <vector>
+
+namespace Resources
+{
+    // Open addressing hash table with linear probing that maps unique vertices to indices. Vertices are compared by their packed bytes and stored
+    // once, in insertion order, in a flat array that doubles as the welded vertex buffer. Slots are 8 bytes, so a probe rarely leaves its cache line.
+    class VertexWeldTable final
+    {
+    public:
+        static_assert(sizeof(Vertex) == 36, "Vertex is expected to be tightly packed so that it can be hashed and compared by its bytes.");
+
+        explicit VertexWeldTable(size_t expectedVertexCount)
+        {
+            size_t capacity = 16;
+
+            while (capacity < expectedVertexCount * 2) // Keep the load factor below 50%, where linear probing stays short.
+            {
+                capacity *= 2;
+            }
+
+            m_Slots.assign(capacity, Slot{ 0, s_EmptySlot });
+            m_Vertices.reserve(expectedVertexCount);
+        }
+
+        static uint64_t Hash(const Vertex& vertex)
+        {
+            uint64_t words[4];
+            uint32_t lastWord;
+            std::memcpy(words, &vertex, sizeof(words));
+            std::memcpy(&lastWord, reinterpret_cast<const uint8_t*>(&vertex) + sizeof(words), sizeof(lastWord));
+
+            uint64_t hash = lastWord;
+
+            for (const uint64_t word : words)
+            {
+                hash = (hash ^ word) * 0x9e3779b97f4a7c15ull;
+                hash ^= hash >> 29;
+            }
+
+            // Final avalanche so that both the low bits (slot selection) and the high bits (partitioning by callers) are well distributed.
+            hash ^= hash >> 32;
+            hash *= 0xd6e8feb86659fd93ull;
+            hash ^= hash >> 32;
+
+            return hash;
+        }
+
+        // Returns the index of the vertex, inserting it if it has not been seen before. The hash must come from Hash().
+        uint32_t Insert(const Vertex& vertex, uint64_t hash)
+        {
+            if ((m_Vertices.size() + 1) * 2 > m_Slots.size())
+            {
+                Grow();
+            }
+
+            const uint32_t shortHash = static_cast<uint32_t>(hash);
+            const size_t mask = m_Slots.size() - 1;
+
+            for (size_t slotIndex = static_cast<size_t>(hash) & mask; ; slotIndex = (slotIndex + 1) & mask)
+            {
+                Slot& slot = m_Slots[slotIndex];
+
+                if (slot.m_VertexIndex == s_EmptySlot)
+                {
+                    slot.m_Hash = shortHash;
+                    slot.m_VertexIndex = static_cast<uint32_t>(m_Vertices.size());
+                    m_Vertices.push_back(vertex);
+
+                    return slot.m_VertexIndex;
+                }
+
+                if (slot.m_Hash == shortHash && std::memcmp(&m_Vertices[slot.m_VertexIndex], &vertex, sizeof(Vertex)) == 0)
+                {
+                    return slot.m_VertexIndex;
+                }
+            }
+        }
+
+        const std::vector<Vertex>& GetVertices() const { return m_Vertices; }
+        std::vector<Vertex>& GetVertices() { return m_Vertices; }
+
+    private:
+        struct Slot
+        {
+            uint32_t m_Hash; // Low bits of the full hash, checked before comparing whole vertices.
+            uint32_t m_VertexIndex;
+        };
+
+        void Grow()
+        {
+            std::vector<Slot> oldSlots(m_Slots.size() * 2, Slot{ 0, s_EmptySlot });
+            oldSlots.swap(m_Slots);
+
+            const size_t mask = m_Slots.size() - 1;
+
+            for (const Slot& oldSlot : oldSlots)
+            {
+                if (oldSlot.m_VertexIndex == s_EmptySlot)
+                {
+                    continue;
+                }
+
+                // The stored bits are the low bits of the full hash, which is all the wider mask needs as long as the table has at most 2^32 slots.
+                size_t slotIndex = oldSlot.m_Hash & mask;
+
+                while (m_Slots[slotIndex].m_VertexIndex != s_EmptySlot)
+                {
+                    slotIndex = (slotIndex + 1) & mask;
+                }
+
+                m_Slots[slotIndex] = oldSlot;
+            }
+        }
+
+    private:
+        static constexpr uint32_t s_EmptySlot = 0xFFFFFFFF;
+
+        std::vector<Slot> m_Slots;
+        std::vector<Vertex> m_Vertices;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "VertexWelder.h"
+#include "VertexWeldTable.h"
+#include "Core/Parallel.h"
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+#include <algorithm>
+#include <unordered_map>
+
+namespace Resources
+{
+    namespace VertexWelderUtilities
+    {
+        Vertex CreateVertex(const Importers::ObjImporter::Result& model, size_t corner)
+        {
+            const Importers::ObjImporter::Index& index = model.m_Indices[corner];
+
+            Vertex vertex = {};
+            vertex.m_Position =
+            {
+                model.m_Positions[3 * index.m_Position + 0], // Index 0, 1, 2 and so on.
+                model.m_Positions[3 * index.m_Position + 1],
+                model.m_Positions[3 * index.m_Position + 2],
+            };
+
+            if (index.m_Normal >= 0)
+            {
+                vertex.m_Normal =
+                {
+                    model.m_Normals[3 * index.m_Normal + 0],
+                    model.m_Normals[3 * index.m_Normal + 1],
+                    model.m_Normals[3 * index.m_Normal + 2],
+                };
+            }
+
+            if (index.m_TexCoord >= 0)
+            {
+                vertex.m_TexCoords =
+                {
+                    model.m_TexCoords[2 * index.m_TexCoord + 0],
+                    1 - model.m_TexCoords[2 * index.m_TexCoord + 1] // In Vulkan, the Y coordinate of an image begins in the top to bottom orientation, where 0 means the top of the image. Hence, we will flip the Y coordinate as OBJ assumes a coordinate system where 0 means the bottom of the image.
+                };
+            }
+
+            vertex.m_MaterialIndex = std::max(0, model.m_MaterialIDs[corner / 3]);
+
+            // The flat weld table compares bytes, while Vertex::operator== treats 0 and -0 as equal. Adding zero turns -0 into 0, so both tables merge the same vertices.
+            vertex.m_Position += glm::vec3(0.0f);
+            vertex.m_Normal += glm::vec3(0.0f);
+            vertex.m_TexCoords += glm::vec2(0.0f);
+
+            return vertex;
+        }
+
+        // The same interface as VertexWeldTable, on top of a std::unordered_map with the hash the flat table replaced.
+        class VertexWeldMap final
+        {
+        public:
+            explicit VertexWeldMap(size_t expectedVertexCount) : m_UniqueVertices(expectedVertexCount)
+            {
+            }
+
+            // The precomputed hash is ignored, the map hashes the vertex itself.
+            uint32_t Insert(const Vertex& vertex, uint64_t)
+            {
+                const auto result = m_UniqueVertices.emplace(vertex, static_cast<uint32_t>(m_Vertices.size()));
+
+                if (result.second)
+                {
+                    m_Vertices.push_back(vertex);
+                }
+
+                return result.first->second;
+            }
+
+            std::vector<Vertex>& GetVertices() { return m_Vertices; }
+
+        private:
+            struct Hash
+            {
+                size_t operator()(const Vertex& vertex) const noexcept
+                {
+                    return Combine(std::hash<glm::vec3>()(vertex.m_Position),
+                               Combine(std::hash<glm::vec3>()(vertex.m_Normal),
+                                   Combine(std::hash<glm::vec2>()(vertex.m_TexCoords),
+                                       std::hash<int>()(vertex.m_MaterialIndex))));
+                }
+
+                static size_t Combine(size_t hash0, size_t hash1)
+                {
+                    return hash0 ^ (hash1 + 0x9e3779b9 + (hash0 << 6) + (hash0 >> 2));
+                }
+            };
+
+            std::unordered_map<Vertex, uint32_t, Hash> m_UniqueVertices;
+            std::vector<Vertex> m_Vertices;
+        };
+
+        template<typename TTable>
+        void Weld(const Importers::ObjImporter::Result& model, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+        {
+            const size_t cornerCount = model.m_Indices.size();
+            const uint32_t partitionCount = std::min<uint32_t>(Parallel::GetWorkerCount(), 255);
+
+            // Pass 1: Hash each corner once and assign it to a partition.
+            std::vector<uint64_t> cornerHashes(cornerCount);
+            std::vector<uint8_t> cornerPartitions(cornerCount);
+
+            Parallel::ForEachRange(cornerCount, 64 * 1024, [&](size_t begin, size_t end, uint32_t)
+            {
+                for (size_t corner = begin; corner != end; ++corner)
+                {
+                    // Take the partition from the top bits of the hash. The low bits are what the tables use to pick slots and must stay well distributed within each partition.
+                    cornerHashes[corner] = VertexWeldTable::Hash(CreateVertex(model, corner));
+                    cornerPartitions[corner] = static_cast<uint8_t>((cornerHashes[corner] >> 32) % partitionCount);
+                }
+            });
+
+            // Pass 2: Weld each partition. Corners are visited in order, so local vertex IDs are handed out in first use order within a partition.
+            // Tables are sized from the position count, as most models have about one unique vertex per position. They grow if that is exceeded.
+            std::vector<std::vector<Vertex>> partitionVertices(partitionCount);
+            std::vector<uint32_t> cornerLocalIDs(cornerCount);
+            const size_t expectedVerticesPerPartition = model.m_Positions.size() / 3 / partitionCount;
+
+            const uint32_t workerCount = cornerCount > 64 * 1024 ? partitionCount : 1; // Small models are not worth the thread start up.
+
+            Parallel::ForEachWorker(workerCount, [&](uint32_t worker)
+            {
+                for (uint32_t partition = worker; partition < partitionCount; partition += workerCount)
+                {
+                    TTable weldTable(expectedVerticesPerPartition);
+
+                    for (size_t corner = 0; corner != cornerCount; ++corner)
+                    {
+                        if (cornerPartitions[corner] == partition)
+                        {
+                            cornerLocalIDs[corner] = weldTable.Insert(CreateVertex(model, corner), cornerHashes[corner]);
+                        }
+                    }
+
+                    partitionVertices[partition] = std::move(weldTable.GetVertices());
+                }
+            });
+
+            // Pass 3: Merge. The first time we see a partition's next local ID, it is that vertex's first use across the whole model.
+            size_t uniqueCount = 0;
+            std::vector<std::vector<uint32_t>> partitionToGlobal(partitionCount);
+
+            for (uint32_t partition = 0; partition != partitionCount; ++partition)
+            {
+                uniqueCount += partitionVertices[partition].size();
+                partitionToGlobal[partition].resize(partitionVertices[partition].size());
+            }
+
+            vertices.clear();
+            vertices.reserve(uniqueCount);
+            indices.resize(cornerCount);
+
+            std::vector<uint32_t> nextLocalIDs(partitionCount, 0);
+
+            for (size_t corner = 0; corner != cornerCount; ++corner)
+            {
+                const uint8_t partition = cornerPartitions[corner];
+                const uint32_t localID = cornerLocalIDs[corner];
+
+                if (localID == nextLocalIDs[partition])
+                {
+                    partitionToGlobal[partition][localID] = static_cast<uint32_t>(vertices.size());
+                    vertices.push_back(partitionVertices[partition][localID]);
+                    ++nextLocalIDs[partition];
+                }
+
+                indices[corner] = partitionToGlobal[partition][localID];
+            }
+        }
+    }
+
+    void VertexWelder::Weld(const Importers::ObjImporter::Result& model, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, Table table)
+    {
+        if (table == Table::UnorderedMap)
+        {
+            VertexWelderUtilities::Weld<VertexWelderUtilities::VertexWeldMap>(model, vertices, indices);
+        }
+        else
+        {
+            VertexWelderUtilities::Weld<VertexWeldTable>(model, vertices, indices);
+        }
+    }
+}
\ No newline at end of file
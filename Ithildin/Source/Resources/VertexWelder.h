@@ -0,0 +1,21 @@
+#pragma once
+#include "Vertex.h"
+#include "Importers/ObjImporter.h"
+#include <vector>
+
+namespace Resources
+{
+    // Deduplicates the face corners of an imported OBJ into unique vertices and an index buffer. Every corner is assigned to a partition by its hash, and each
+    // partition is welded by its own worker with a private table. A final serial pass hands out vertex indices in first use order, so the result does not depend on the partitioning.
+    class VertexWelder final
+    {
+    public:
+        enum class Table
+        {
+            Flat,        // VertexWeldTable, an open addressing table of 8 byte slots.
+            UnorderedMap // The node based std::unordered_map the flat table replaced. Only kept so that --weld-benchmark can compare the two.
+        };
+
+        static void Weld(const Importers::ObjImporter::Result& model, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, Table table = Table::Flat);
+    };
+}
\ No newline at end of file
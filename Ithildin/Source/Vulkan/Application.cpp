@@ -15,24 +15,27 @@
 #include "VulkanFramebuffer.h"
 #include "VulkanCommandBuffers.h"
 #include "VulkanRenderPass.h"
+#include "VulkanUploadManager.h"
 #include "Resources/UniformBuffer.h"
 #include "Resources/Scene.h"
 #include "Resources/Model.h"
 #include "Resources/Texture.h"
 #include "../Core/Window.h"
+#include <chrono>
 #include <string>
 
 namespace Vulkan
 {
     Application::Application(const WindowSettings& windowSettings, VkPresentModeKHR presentationMode, bool enableValidationLayers)
-        : m_PresentationMode(presentationMode)
+        : m_PresentationMode(presentationMode), m_OffscreenExtent{ windowSettings.m_Width, windowSettings.m_Height }
     {
         const std::vector<const char*> validationLayers = enableValidationLayers ? std::vector<const char*> { "VK_LAYER_KHRONOS_validation" } : std::vector<const char*>();
 
-        m_Window.reset(new Window(windowSettings));
-        m_Instance.reset(new VulkanInstance(*m_Window, validationLayers, VK_API_VERSION_1_2));
+        // Headless applications never create a window, so they run without a display.
+        m_Window.reset(windowSettings.m_IsHeadless ? nullptr : new Window(windowSettings));
+        m_Instance.reset(new VulkanInstance(m_Window.get(), validationLayers, VK_API_VERSION_1_2));
         m_DebugMessenger.reset(enableValidationLayers ? new VulkanDebugMessenger(*m_Instance, VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT) : nullptr);
-        m_Surface.reset(new VulkanSurface(*m_Instance));
+        m_Surface.reset(IsHeadless() ? nullptr : new VulkanSurface(*m_Instance));
     }
 
     Application::~Application()
@@ -40,6 +43,7 @@ namespace Vulkan
         DeleteSwapChain();
 
         // Reverse creation order.
+        m_UploadManager.reset();
         m_CommandPool.reset();
         m_Device.reset();
         m_Surface.reset();
@@ -55,11 +59,13 @@ namespace Vulkan
             std::logic_error("A physical device has already been set.\n");
         }
 
-        std::vector<const char*> requiredExtensions =
+        std::vector<const char*> requiredExtensions;
+
+        if (!IsHeadless())
         {
             // VK_KHR_swapchain
-            VK_KHR_SWAPCHAIN_EXTENSION_NAME,
-        };
+            requiredExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
 
         VkPhysicalDeviceFeatures deviceFeatures = {};
 
@@ -77,6 +83,11 @@ namespace Vulkan
             std::logic_error("Physical device has not been set. Is there any error?\n");
         }
 
+        if (IsHeadless())
+        {
+            throw std::logic_error("Headless applications have no window to update, draw frames directly instead.\n");
+        }
+
         m_Window->DrawFrame = [this]()                                                                { DrawFrame(); };
         m_Window->OnKey = [this](const int key, const int scanCode, const int action, const int mods) { OnKey(key, scanCode, action, mods); };
         m_Window->OnCursorMoved = [this](const double xPosition, const double yPosition)              { OnCursorMoved(xPosition, yPosition); };
@@ -90,6 +101,13 @@ namespace Vulkan
     {
         constexpr auto noTimeout = std::numeric_limits<uint64_t>::max();
 
+        // Offscreen there is nothing to acquire or present.
+        if (m_SwapChain->IsOffscreen())
+        {
+            DrawOffscreenFrame();
+            return;
+        }
+
         VulkanFence& inFlightFence = m_InFlightFences[m_CurrentFrame];
         const VkSemaphore imageAvaliableSemaphore = m_ImageAvaliableSemaphores[m_CurrentFrame].GetHandle();
         const VkSemaphore renderFinishedSemaphore = m_RenderFinishedSemaphores[m_CurrentFrame].GetHandle();
@@ -168,6 +186,30 @@ namespace Vulkan
         m_CurrentFrame = (m_CurrentFrame + 1) % m_InFlightFences.size();
     }
 
+    void Application::DrawOffscreenFrame()
+    {
+        constexpr auto noTimeout = std::numeric_limits<uint64_t>::max();
+        constexpr uint32_t imageIndex = 0; // The offscreen swapchain has a single image.
+
+        VulkanFence& inFlightFence = m_InFlightFences[imageIndex];
+        inFlightFence.Wait(noTimeout);
+
+        const VkCommandBuffer commandBuffer = m_CommandBuffers->BeginRecording(imageIndex);
+        Render(commandBuffer, imageIndex);
+        m_CommandBuffers->EndRecording(imageIndex);
+
+        UpdateUniformBuffer(imageIndex);
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+
+        inFlightFence.Reset();
+
+        CheckResult(vkQueueSubmit(m_Device->GetGraphicsQueue(), 1, &submitInfo, inFlightFence.GetHandle()), "Submitting Queue Operation (Offscreen Drawing)");
+    }
+
     void Application::Render(VkCommandBuffer commandBuffer, uint32_t imageIndex)
     {
         std::array<VkClearValue, 2> clearValues = {};
@@ -189,27 +231,30 @@ namespace Vulkan
         const Resources::Scene& scene = GetScene();
 
         VkDescriptorSet descriptorSets[] = { m_GraphicsPipeline->GetDescriptorSet(imageIndex) };
-        VkBuffer vertexBuffers[] = { scene.GetVertexBuffer().GetHandle() };
+        VkBuffer vertexBuffers[] = { scene.GetPositionBuffer().GetHandle(), scene.GetVertexBuffer().GetHandle(), scene.GetInstanceBuffer().GetHandle() };
         const VkBuffer indexBuffer = scene.GetIndexBuffer().GetHandle();
-        VkDeviceSize offsets[] = { 0 };
+        VkDeviceSize offsets[] = { 0, 0, 0 };
 
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline->GetHandle());
         vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline->GetPipelineLayout().GetHandle(), 0, 1, descriptorSets, 0, nullptr);
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+        vkCmdBindVertexBuffers(commandBuffer, 0, 3, vertexBuffers, offsets);
         vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
         uint32_t vertexOffset = 0;
         uint32_t indexOffset = 0;
+        uint32_t instanceOffset = 0;
 
         for (const Resources::Model& model : scene.GetModels())
         {
             const uint32_t vertexCount = static_cast<uint32_t>(model.GetNumberOfVertices());
             const uint32_t indexCount = static_cast<uint32_t>(model.GetNumberOfIndices());
+            const uint32_t instanceCount = static_cast<uint32_t>(model.GetNumberOfInstances());
 
-            vkCmdDrawIndexed(commandBuffer, indexCount, 1, indexOffset, vertexOffset, 0);
+            vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, indexOffset, vertexOffset, instanceOffset);
 
             vertexOffset += vertexCount;
             indexOffset += indexCount;
+            instanceOffset += instanceCount;
         }
 
         vkCmdEndRenderPass(commandBuffer);
@@ -217,8 +262,15 @@ namespace Vulkan
 
     void Application::SetPhysicalDevice(VkPhysicalDevice physicalDevice, std::vector<const char*>& requiredExtensions, VkPhysicalDeviceFeatures& deviceFeatures, void* nextDeviceFeatures)
     {
-        m_Device.reset(new VulkanDevice(physicalDevice, *m_Surface, requiredExtensions, deviceFeatures, nextDeviceFeatures));
+        // Timeline semaphores let the upload manager track its transfer queue submissions.
+        VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures = {};
+        timelineSemaphoreFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+        timelineSemaphoreFeatures.pNext = nextDeviceFeatures;
+        timelineSemaphoreFeatures.timelineSemaphore = true;
+
+        m_Device.reset(new VulkanDevice(physicalDevice, *m_Instance, m_Surface.get(), requiredExtensions, deviceFeatures, &timelineSemaphoreFeatures));
         m_CommandPool.reset(new VulkanCommandPool(*m_Device, m_Device->GetGraphicsQueueFamilyIndex(), true));
+        m_UploadManager.reset(new VulkanUploadManager(*m_Device, 64 * 1024 * 1024));
     }
 
     void Application::DeleteSwapChain()
@@ -226,7 +278,7 @@ namespace Vulkan
         m_CommandBuffers.reset();
         m_SwapChainFramebuffers.clear();
         m_GraphicsPipeline.reset();
-        m_UniformBuffers.clear();
+        m_UniformBuffer.reset();
         m_InFlightFences.clear();
         m_RenderFinishedSemaphores.clear();
         m_ImageAvaliableSemaphores.clear();
@@ -237,12 +289,12 @@ namespace Vulkan
     void Application::CreateSwapChain()
     {
         // Wait until the window is visible.
-        while (m_Window->IsMinimized())
+        while (!IsHeadless() && m_Window->IsMinimized())
         {
             m_Window->WaitForEvents();
         }
 
-        m_SwapChain.reset(new VulkanSwapChain(*m_Device, m_PresentationMode));
+        m_SwapChain.reset(IsHeadless() ? new VulkanSwapChain(*m_Device, m_OffscreenExtent) : new VulkanSwapChain(*m_Device, m_PresentationMode));
         m_DepthBuffer.reset(new VulkanDepthBuffer(*m_CommandPool, m_SwapChain->GetExtent()));
 
         for (size_t i = 0; i != m_SwapChain->GetImageViews().size(); ++i)
@@ -250,10 +302,11 @@ namespace Vulkan
             m_ImageAvaliableSemaphores.emplace_back(*m_Device);
             m_RenderFinishedSemaphores.emplace_back(*m_Device);
             m_InFlightFences.emplace_back(*m_Device, true);
-            m_UniformBuffers.emplace_back(*m_Device);
         }
 
-        m_GraphicsPipeline.reset(new VulkanGraphicsPipeline(*m_SwapChain, *m_DepthBuffer, m_UniformBuffers, GetScene(), m_IsWireframe));
+        // One uniform buffer slot per swapchain image, matching the command buffers that read them.
+        m_UniformBuffer.reset(new Resources::UniformBuffer(*m_Device, static_cast<uint32_t>(m_SwapChain->GetImageViews().size())));
+        m_GraphicsPipeline.reset(new VulkanGraphicsPipeline(*m_SwapChain, *m_DepthBuffer, *m_UniformBuffer, GetScene(), m_IsWireframe));
 
         for (const auto& imageView : m_SwapChain->GetImageViews())
         {
@@ -265,7 +318,24 @@ namespace Vulkan
 
     void Application::UpdateUniformBuffer(uint32_t imageIndex)
     {
-        m_UniformBuffers[imageIndex].SetValue(GetUniformBufferObject(m_SwapChain->GetExtent()));
+        const Resources::UniformBufferObject uniformBufferObject = GetUniformBufferObject(m_SwapChain->GetExtent());
+
+        const auto timeStart = std::chrono::high_resolution_clock::now();
+        m_UniformBuffer->SetValue(imageIndex, uniformBufferObject);
+        const auto timeEnd = std::chrono::high_resolution_clock::now();
+
+        const float updateTime = std::chrono::duration<float, std::micro>(timeEnd - timeStart).count();
+        m_UniformUpdateTime += (updateTime - m_UniformUpdateTime) * 0.05f;
+
+        if (m_CompareUniformUpdates)
+        {
+            const auto mapUnmapStart = std::chrono::high_resolution_clock::now();
+            m_UniformBuffer->SetValueWithMapUnmap(uniformBufferObject);
+            const auto mapUnmapEnd = std::chrono::high_resolution_clock::now();
+
+            const float mapUnmapTime = std::chrono::duration<float, std::micro>(mapUnmapEnd - mapUnmapStart).count();
+            m_MapUnmapUniformUpdateTime += (mapUnmapTime - m_MapUnmapUniformUpdateTime) * 0.05f;
+        }
     }
 
     void Application::RecreateSwapChain()
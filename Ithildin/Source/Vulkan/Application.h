@@ -18,6 +18,7 @@ namespace Vulkan
     class VulkanDevice;
     class VulkanCommandPool;
     class VulkanDepthBuffer;
+    class VulkanUploadManager;
 
     class Application
     {
@@ -31,6 +32,7 @@ namespace Vulkan
         const VulkanSwapChain& GetSwapChain() const { return *m_SwapChain; }
         Window& GetWindow() const { return *m_Window; }
         bool HasSwapChain() const { return m_SwapChain.get(); }
+        bool IsHeadless() const { return m_Window == nullptr; }
 
         void SetPhysicalDevice(VkPhysicalDevice physicalDevice);
         void OnUpdate();
@@ -48,10 +50,14 @@ namespace Vulkan
         virtual void DeleteSwapChain();
         virtual void OnDeviceSet() {}
         const VulkanDevice& GetDevice() const { return *m_Device; }
-        const std::vector<Resources::UniformBuffer>& GetUniformBuffers() const { return m_UniformBuffers; }
+        const Resources::UniformBuffer& GetUniformBuffer() const { return *m_UniformBuffer; }
         VulkanCommandPool& GetCommandPool() const { return *m_CommandPool; };
+        VulkanUploadManager& GetUploadManager() const { return *m_UploadManager; }
         const VulkanDepthBuffer& GetDepthBuffer() const { return *m_DepthBuffer; }
         const VulkanFramebuffer& GetSwapchainFramebuffer(const size_t i) const { return m_SwapChainFramebuffers[i]; }
+        float GetUniformUpdateTime() const { return m_UniformUpdateTime; }
+        float GetMapUnmapUniformUpdateTime() const { return m_MapUnmapUniformUpdateTime; }
+        void SetCompareUniformUpdates(bool isEnabled) { m_CompareUniformUpdates = isEnabled; } // Also times the Map/Unmap write the uniform ring replaced, every frame.
 
         // Input
         virtual void OnKey(int key, int scanCode, int action, int mods) { }
@@ -62,6 +68,7 @@ namespace Vulkan
         virtual Resources::UniformBufferObject GetUniformBufferObject(VkExtent2D extent) const = 0;
 
     private:
+        void DrawOffscreenFrame();
         void UpdateUniformBuffer(uint32_t imageIndex);
         void RecreateSwapChain();
 
@@ -71,6 +78,7 @@ namespace Vulkan
     private:
         // Properties
         const VkPresentModeKHR m_PresentationMode;
+        const VkExtent2D m_OffscreenExtent; // Size of the render target when headless.
 
     private:        
         std::unique_ptr<class Window> m_Window;
@@ -79,17 +87,21 @@ namespace Vulkan
         std::unique_ptr<class VulkanSurface> m_Surface;
         std::unique_ptr<class VulkanDevice> m_Device;
         std::unique_ptr<class VulkanCommandPool> m_CommandPool;
+        std::unique_ptr<class VulkanUploadManager> m_UploadManager;
         std::unique_ptr<class VulkanSwapChain> m_SwapChain;
         std::unique_ptr<class VulkanDepthBuffer> m_DepthBuffer;
         std::unique_ptr<class VulkanGraphicsPipeline> m_GraphicsPipeline;
         std::vector<VulkanFramebuffer> m_SwapChainFramebuffers;
         std::unique_ptr<class VulkanCommandBuffers> m_CommandBuffers;
 
-        std::vector<Resources::UniformBuffer> m_UniformBuffers;
+        std::unique_ptr<Resources::UniformBuffer> m_UniformBuffer;
         std::vector<class VulkanFence> m_InFlightFences;
         std::vector<class VulkanSemaphore> m_ImageAvaliableSemaphores;
         std::vector<class VulkanSemaphore> m_RenderFinishedSemaphores;
 
         size_t m_CurrentFrame = 0;
+        float m_UniformUpdateTime = 0.0f; // Microseconds spent writing the uniform buffer each frame, smoothed over recent frames.
+        float m_MapUnmapUniformUpdateTime = 0.0f; // The same for the Map/Unmap write, only measured while comparing.
+        bool m_CompareUniformUpdates = false;
     };
 }
\ No newline at end of file
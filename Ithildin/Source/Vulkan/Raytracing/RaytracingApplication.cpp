@@ -23,15 +23,22 @@
 #include "VulkanBottomLevelGeometry.h"
 #include "VulkanRaytracingPipeline.h"
 #include "VulkanShaderBindingTable.h"
+#include "VulkanScratchBuffer.h"
 #include "../VulkanBufferUtilities.h"
 #include "../VulkanImageMemoryBarrier.h"
 #include "Resources/UniformBuffer.h"
 #include "Resources/Scene.h"
 #include "Resources/Model.h"
+#include "Resources/Instance.h"
 #include "Resources/Texture.h"
 #include "Core/Window.h"
 #include <string>
+#include <algorithm>
 #include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
 
 namespace Vulkan::Raytracing
 {
@@ -51,6 +58,35 @@ namespace Vulkan::Raytracing
 
             return totalSize;
         }
+
+        // Bottom level builds are split into batches whose scratch memory fits this budget, which bounds the scratch allocation for large scenes.
+        const VkDeviceSize ScratchBudget = 64 * 1024 * 1024;
+
+        // Refits leave the hierarchy as it was built, so it loosens as instances move. A full rebuild every so many refits restores the trace performance.
+        const uint32_t MaxTopLevelRefits = 64;
+
+        // Only models placed once without a transform can share a bottom level structure, as their vertices are already in world space.
+        bool IsStaticModel(const Resources::Model& model)
+        {
+            return !model.IsDynamic() && model.GetNumberOfInstances() == 1 && model.GetInstances()[0].m_Transform == glm::mat4(1.0f);
+        }
+
+        // Only scenes with dynamic models refit their top level structure, it favours build speed for them and trace speed otherwise.
+        BuildPolicy GetTopLevelBuildPolicy(const std::vector<Resources::Model>& models)
+        {
+            const bool hasDynamicModel = std::any_of(models.begin(), models.end(), [](const Resources::Model& model) { return model.IsDynamic(); });
+            return hasDynamicModel ? BuildPolicy::Dynamic() : BuildPolicy::Static();
+        }
+
+        float GetElapsedTime(const std::chrono::high_resolution_clock::time_point& timer)
+        {
+            return std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
+        }
+
+        float ToMegabytes(VkDeviceSize size)
+        {
+            return static_cast<float>(size) / (1024.0f * 1024.0f);
+        }
     }
 
     RaytracingApplication::RaytracingApplication(const WindowSettings& windowSettings, VkPresentModeKHR requestedPresentationMode, bool enabledValidationLayers)
@@ -63,6 +99,7 @@ namespace Vulkan::Raytracing
         RaytracingApplication::DeleteSwapChain();
         DeleteAccelerationStructures();
 
+        m_ScratchBuffer.reset();
         m_RaytracingProperties.reset();
         m_RaytracingCommandList.reset();
     }
@@ -108,6 +145,7 @@ namespace Vulkan::Raytracing
 
         m_RaytracingCommandList.reset(new VulkanRaytracingCommandList(GetDevice()));
         m_RaytracingProperties.reset(new VulkanRaytracingProperties(GetDevice()));
+        m_ScratchBuffer.reset(new VulkanScratchBuffer(GetDevice(), *m_RaytracingProperties, ASUtilities::ScratchBudget));
     }
 
     void RaytracingApplication::CreateSwapChain()
@@ -117,17 +155,36 @@ namespace Vulkan::Raytracing
         CreateOutputImage();
 
         m_RaytracingPipeline.reset(new VulkanRaytracingPipeline(*m_RaytracingCommandList, GetSwapChain(), m_TopAccelerationStructures[0],
-            *m_AccumulationImageView, *m_OutputImageView, GetUniformBuffers(), GetScene()));
+            *m_AccumulationImageView, *m_OutputImageView, GetUniformBuffer(), GetScene()));
 
         const std::vector<VulkanShaderBindingTable::Entry> rayGenerationPrograms = { { m_RaytracingPipeline->GetRayGenerationShaderIndex(), {}} };
         const std::vector<VulkanShaderBindingTable::Entry> missPrograms = { { m_RaytracingPipeline->GetMissShaderIndex(), {} } };
         const std::vector<VulkanShaderBindingTable::Entry> hitGroups = { { m_RaytracingPipeline->GetTriangleHitGroupIndex(), {} }, { m_RaytracingPipeline->GetProceduralHitGroupIndex(), {} } };
 
         m_ShaderBindingTable.reset(new VulkanShaderBindingTable(*m_RaytracingCommandList, *m_RaytracingPipeline, *m_RaytracingProperties, rayGenerationPrograms, missPrograms, hitGroups));
+        // One slot of top level instances per swapchain image, so the host never overwrites instances a frame in flight is still building from.
+        const VkDeviceSize slotSize = m_TopLevelInstances.size() * sizeof(VkAccelerationStructureInstanceKHR);
+        const VkDeviceSize bufferSize = slotSize * GetSwapChain().GetImages().size();
+
+        m_TopLevelUpdateBuffer.reset(new VulkanBuffer(GetDevice(), bufferSize, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR));
+        m_TopLevelUpdateBufferMemory.reset(new VulkanDeviceMemory(m_TopLevelUpdateBuffer->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, MemoryUsage::HostToDevice)));
+        m_TopLevelUpdateData = m_TopLevelUpdateBufferMemory->Map(0, bufferSize); // Stays mapped until the swapchain is deleted.
+
+        const VulkanDebugUtilities& debugUtilities = GetDevice().GetDebugUtilities();
+        debugUtilities.SetObjectName(m_TopLevelUpdateBuffer->GetHandle(), "TLAS Update Instances Buffer");
+        debugUtilities.SetObjectName(m_TopLevelUpdateBufferMemory->GetHandle(), "TLAS Update Instances Memory");
     }
 
     void RaytracingApplication::DeleteSwapChain()
     {
+        if (m_TopLevelUpdateData != nullptr)
+        {
+            m_TopLevelUpdateBufferMemory->Unmap();
+            m_TopLevelUpdateData = nullptr;
+        }
+
+        m_TopLevelUpdateBuffer.reset();
+        m_TopLevelUpdateBufferMemory.reset();
         m_ShaderBindingTable.reset();
         m_RaytracingPipeline.reset();
         m_OutputImageView.reset();
@@ -144,6 +201,12 @@ namespace Vulkan::Raytracing
     {
         const VkExtent2D extent = GetSwapChain().GetExtent();
 
+        // Bring moved instances into the top level structure before tracing.
+        if (m_IsTopLevelOutdated)
+        {
+            UpdateTopLevelStructure(commandBuffer, imageIndex);
+        }
+
         VkDescriptorSet descriptorSets[] = { m_RaytracingPipeline->GetDescriptorSet(imageIndex) };
 
         VkImageSubresourceRange subresourceRange = {};
@@ -199,26 +262,65 @@ namespace Vulkan::Raytracing
                        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
 
         VulkanImageMemoryBarrier::Insert(commandBuffer, GetSwapChain().GetImages()[imageIndex], subresourceRange, VK_ACCESS_TRANSFER_WRITE_BIT, 0,
-                                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+                                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, GetSwapChain().GetPresentLayout());
     }
 
-    void RaytracingApplication::CreateAccelerationStructures()
+    std::vector<float> RaytracingApplication::ReadAccumulationImage() const
     {
-        const std::chrono::high_resolution_clock::time_point timer = std::chrono::high_resolution_clock::now();
+        const VkExtent2D extent = m_AccumulationImage->GetExtent();
+        const size_t imageSize = static_cast<size_t>(extent.width) * extent.height * 4 * sizeof(float);
 
-        SingleTimeCommands::Submit(GetCommandPool(), [this](VkCommandBuffer commandBuffer)
+        // Read back through host cached memory, which is much faster for the CPU to read than write-combined memory.
+        std::unique_ptr<VulkanBuffer> readbackBuffer(new VulkanBuffer(GetDevice(), imageSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT));
+        std::unique_ptr<VulkanDeviceMemory> readbackBufferMemory(new VulkanDeviceMemory(readbackBuffer->AllocateMemory(MemoryUsage::DeviceToHost)));
+
+        SingleTimeCommands::Submit(GetCommandPool(), [&](VkCommandBuffer commandBuffer)
         {
-            CreateBottomLevelStructures(commandBuffer);
-            CreateTopLevelStructures(commandBuffer);
+            VkImageSubresourceRange subresourceRange = {};
+            subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            subresourceRange.levelCount = 1;
+            subresourceRange.layerCount = 1;
+
+            // The image stays in the general layout that the ray generation shader writes it in.
+            VulkanImageMemoryBarrier::Insert(commandBuffer, m_AccumulationImage->GetHandle(), subresourceRange, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+
+            VkBufferImageCopy copyRegion = {};
+            copyRegion.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+            copyRegion.imageExtent = { extent.width, extent.height, 1 };
+
+            vkCmdCopyImageToBuffer(commandBuffer, m_AccumulationImage->GetHandle(), VK_IMAGE_LAYOUT_GENERAL, readbackBuffer->GetHandle(), 1, &copyRegion);
+
+            VkMemoryBarrier memoryBarrier = {};
+            memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            memoryBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
         });
 
-        m_TopASScratchBuffer.reset();
-        m_TopASScratchBufferMemory.reset();
-        m_BottomASScratchBuffer.reset();
-        m_BottomASScratchBufferMemory.reset();
+        std::vector<float> pixels(imageSize / sizeof(float));
+        std::memcpy(pixels.data(), readbackBufferMemory->Map(0, imageSize), imageSize);
+        readbackBufferMemory->Unmap();
+
+        readbackBuffer.reset();
+        readbackBufferMemory.reset(); // Release memory after bound buffer has been destroyed.
+
+        return pixels;
+    }
+
+    void RaytracingApplication::CreateAccelerationStructures()
+    {
+        const std::chrono::high_resolution_clock::time_point timer = std::chrono::high_resolution_clock::now();
+
+        m_BottomLevelBatches = CreateBottomLevelBatches(m_BatchStaticGeometry);
+
+        CreateBottomLevelStructures();
+        CreateTopLevelStructures();
+
+        std::cout << "Built Acceleration Structures in " << ASUtilities::GetElapsedTime(timer) << " seconds.\n";
+        std::cout << "- Scratch: " << ASUtilities::ToMegabytes(m_ScratchBuffer->GetSize()) << " MB (" << ASUtilities::ToMegabytes(m_ScratchBuffer->GetBudget()) << " MB budget).\n";
 
-        const float elapsedTime = std::chrono::duration<float, std::chrono::seconds::period>(std::chrono::high_resolution_clock::now() - timer).count();
-        std::cout << "Built Acceleration Structures in " << elapsedTime << " seconds.\n";
+        PrintAccelerationStructureStatistics();
     }
 
     void RaytracingApplication::DeleteAccelerationStructures()
@@ -227,73 +329,315 @@ namespace Vulkan::Raytracing
 
         m_InstancesBuffer.reset();
         m_InstancesBufferMemory.reset();
-        m_TopASScratchBuffer.reset();
-        m_TopASScratchBufferMemory.reset();
+        m_TopLevelInstances.clear();
+        m_ModelTopLevelInstances.clear();
+        m_TopLevelRefitCount = 0;
+        m_IsTopLevelOutdated = false;
+        m_PendingInstanceTransforms.clear();
         m_TopASBuffer.reset();
         m_TopASBufferMemory.reset();
 
         m_BottomAccelerationStructures.clear();
+        m_BottomLevelBatches.clear();
+        m_BottomLevelSize = 0;
+        m_CompactedBottomLevelSize = 0;
 
-        m_BottomASScratchBuffer.reset();
-        m_BottomASScratchBufferMemory.reset();
         m_BottomASBuffer.reset();
         m_BottomASBufferMemory.reset();
     }
 
-    void RaytracingApplication::CreateBottomLevelStructures(VkCommandBuffer commandBuffer)
+    std::vector<BottomLevelBatch> RaytracingApplication::CreateBottomLevelBatches(bool batchStaticGeometry) const
+    {
+        const std::vector<Resources::Model>& models = GetScene().GetModels();
+        const uint64_t maxGeometryCount = m_RaytracingProperties->GetMaxGeometryCount();
+        const uint64_t maxPrimitiveCount = m_RaytracingProperties->GetMaxPrimitiveCount();
+
+        // A bottom level structure holds either triangles or AABBs, never both. Batches are therefore runs of consecutive static models of the same kind,
+        // which also keeps their entries in the scene's instance buffer contiguous so the hit shaders can find them with gl_GeometryIndexEXT.
+        std::vector<BottomLevelBatch> batches;
+        uint64_t batchPrimitiveCount = 0;
+
+        for (uint32_t i = 0; i != models.size(); ++i)
+        {
+            const Resources::Model& model = models[i];
+            const bool isStatic = batchStaticGeometry && ASUtilities::IsStaticModel(model);
+            const uint64_t primitiveCount = model.GetProcedural() ? 1 : model.GetNumberOfIndices() / 3;
+
+            if (isStatic && !batches.empty())
+            {
+                BottomLevelBatch& batch = batches.back();
+                const bool isSameKind = (models[batch.m_FirstModel].GetProcedural() != nullptr) == (model.GetProcedural() != nullptr);
+
+                if (batch.m_IsStatic && isSameKind && batch.m_ModelCount < maxGeometryCount && batchPrimitiveCount + primitiveCount <= maxPrimitiveCount)
+                {
+                    batch.m_ModelCount++;
+                    batchPrimitiveCount += primitiveCount;
+                    continue;
+                }
+            }
+
+            batches.push_back({ i, 1, isStatic });
+            batchPrimitiveCount = primitiveCount;
+        }
+
+        return batches;
+    }
+
+    std::vector<VulkanBottomLevelAS> RaytracingApplication::CreateBottomLevelList(const std::vector<BottomLevelBatch>& batches) const
     {
         const Resources::Scene& scene = GetScene();
-        const VulkanDebugUtilities& debugUtilities = GetDevice().GetDebugUtilities();
+        const std::vector<Resources::Model>& models = scene.GetModels();
+
+        // Geometry never changes once the scene is loaded, instance transforms live in the top level structure.
+        BuildPolicy buildPolicy = BuildPolicy::Static();
+        buildPolicy.m_AllowCompaction = m_CompactAccelerationStructures;
 
         // Bottom Level AS. Triangles via Vertex Buffers. Procedurals via AABBs.
+        std::vector<VulkanBottomLevelAS> bottomLevelList;
+        bottomLevelList.reserve(batches.size());
+
         uint32_t vertexOffset = 0;
         uint32_t indexOffset = 0;
         uint32_t aabbOffset = 0;
 
-        for (const auto& model : scene.GetModels())
+        for (const BottomLevelBatch& batch : batches)
         {
-            const uint32_t vertexCount = static_cast<uint32_t>(model.GetNumberOfVertices());
-            const uint32_t indexCount = static_cast<uint32_t>(model.GetNumberOfIndices());
             VulkanBottomLevelGeometry geometries;
 
-            model.GetProcedural() ? geometries.AddGeometry_AABB(scene, aabbOffset, 1, true) : geometries.AddGeometry_Triangles(scene, vertexOffset, vertexCount, indexOffset, indexCount, true);
+            for (uint32_t i = batch.m_FirstModel; i != batch.m_FirstModel + batch.m_ModelCount; ++i)
+            {
+                const Resources::Model& model = models[i];
+                const uint32_t vertexCount = static_cast<uint32_t>(model.GetNumberOfVertices());
+                const uint32_t indexCount = static_cast<uint32_t>(model.GetNumberOfIndices());
+
+                model.GetProcedural() ? geometries.AddGeometry_AABB(scene, aabbOffset, 1, true) : geometries.AddGeometry_Triangles(scene, vertexOffset, vertexCount, indexOffset, indexCount, true);
+
+                vertexOffset += vertexCount * sizeof(glm::vec3);
+                indexOffset += indexCount * sizeof(uint32_t);
+                aabbOffset += sizeof(VkAabbPositionsKHR);
+            }
+
+            bottomLevelList.emplace_back(*m_RaytracingCommandList, *m_RaytracingProperties, geometries, buildPolicy);
+        }
 
-            m_BottomAccelerationStructures.emplace_back(*m_RaytracingCommandList, *m_RaytracingProperties, geometries);
+        return bottomLevelList;
+    }
+
+    uint32_t RaytracingApplication::GetTopLevelInstanceCount(const std::vector<BottomLevelBatch>& batches) const
+    {
+        const std::vector<Resources::Model>& models = GetScene().GetModels();
+        uint32_t instanceCount = 0;
 
-            vertexOffset += vertexCount * sizeof(Resources::Vertex);
-            indexOffset += indexCount * sizeof(uint32_t);
-            aabbOffset += sizeof(VkAabbPositionsKHR);
+        for (const BottomLevelBatch& batch : batches)
+        {
+            instanceCount += batch.m_ModelCount > 1 ? 1 : models[batch.m_FirstModel].GetNumberOfInstances();
         }
 
+        return instanceCount;
+    }
+
+    void RaytracingApplication::PrintAccelerationStructureStatistics() const
+    {
+        const VkDeviceSize topLevelSize = ASUtilities::GetTotalRequirements(m_TopAccelerationStructures).accelerationStructureSize;
+        const uint32_t instanceCount = GetTopLevelInstanceCount(m_BottomLevelBatches);
+
+        std::cout << "- BLAS: " << m_BottomAccelerationStructures.size() << " structures, " << ASUtilities::ToMegabytes(m_BottomLevelSize) << " MB.\n";
+        std::cout << "- TLAS: " << instanceCount << " instances, " << ASUtilities::ToMegabytes(topLevelSize) << " MB.\n";
+
+        if (!m_BatchStaticGeometry)
+        {
+            return;
+        }
+
+        // Size queries alone are enough to compare against one bottom level structure per model. Nothing is allocated or built here.
+        const std::vector<BottomLevelBatch> unbatched = CreateBottomLevelBatches(false);
+        const std::vector<VulkanBottomLevelAS> unbatchedBottomLevel = CreateBottomLevelList(unbatched);
+        const uint32_t unbatchedInstanceCount = GetTopLevelInstanceCount(unbatched);
+        const VulkanTopLevelAS unbatchedTopLevel(*m_RaytracingCommandList, *m_RaytracingProperties, 0, unbatchedInstanceCount, ASUtilities::GetTopLevelBuildPolicy(GetScene().GetModels()));
+
+        const VkDeviceSize unbatchedBottomLevelSize = ASUtilities::GetTotalRequirements(unbatchedBottomLevel).accelerationStructureSize;
+        const VkDeviceSize unbatchedTopLevelSize = unbatchedTopLevel.GetBuildSizes().accelerationStructureSize;
+
+        std::cout << "- Without batching: " << unbatchedBottomLevel.size() << " BLAS, " << ASUtilities::ToMegabytes(unbatchedBottomLevelSize) << " MB, "
+                  << unbatchedInstanceCount << " TLAS instances, " << ASUtilities::ToMegabytes(unbatchedTopLevelSize) << " MB.\n";
+    }
+
+    void RaytracingApplication::CreateBottomLevelStructures()
+    {
+        const VulkanDebugUtilities& debugUtilities = GetDevice().GetDebugUtilities();
+
+        m_BottomAccelerationStructures = CreateBottomLevelList(m_BottomLevelBatches);
+
         // Allocate the structures memory.
         const VkAccelerationStructureBuildSizesInfoKHR totalMemory = ASUtilities::GetTotalRequirements(m_BottomAccelerationStructures);
 
+        m_BottomLevelSize = totalMemory.accelerationStructureSize;
+        m_CompactedBottomLevelSize = 0;
+
         m_BottomASBuffer.reset(new VulkanBuffer(GetDevice(), totalMemory.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT));
-        m_BottomASBufferMemory.reset(new VulkanDeviceMemory(m_BottomASBuffer->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
-        m_BottomASScratchBuffer.reset(new VulkanBuffer(GetDevice(), totalMemory.buildScratchSize, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR));
-        m_BottomASScratchBufferMemory.reset(new VulkanDeviceMemory(m_BottomASScratchBuffer->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+        m_BottomASBufferMemory.reset(new VulkanDeviceMemory(m_BottomASBuffer->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, MemoryUsage::DeviceLocal)));
 
         debugUtilities.SetObjectName(m_BottomASBuffer->GetHandle(), "BLAS Buffer");
         debugUtilities.SetObjectName(m_BottomASBufferMemory->GetHandle(), "BLAS Memory");
-        debugUtilities.SetObjectName(m_BottomASScratchBuffer->GetHandle(), "BLAS Scratch Buffer");
-        debugUtilities.SetObjectName(m_BottomASScratchBufferMemory->GetHandle(), "BLAS Scratch Memory");
 
-        // Generate the structures.
+        // Each structure gets its own range of the result buffer.
+        std::vector<VkDeviceSize> resultBufferOffsets(m_BottomAccelerationStructures.size());
         VkDeviceSize resultBufferOffset = 0;
-        VkDeviceSize scratchBufferOffset = 0;
+        VkDeviceSize largestScratchSize = 0;
 
         for (size_t i = 0; i != m_BottomAccelerationStructures.size(); ++i)
         {
-            m_BottomAccelerationStructures[i].Generate(commandBuffer, *m_BottomASScratchBuffer, scratchBufferOffset, *m_BottomASBuffer, resultBufferOffset);
-
+            resultBufferOffsets[i] = resultBufferOffset;
             resultBufferOffset += m_BottomAccelerationStructures[i].GetBuildSizes().accelerationStructureSize;
-            scratchBufferOffset += m_BottomAccelerationStructures[i].GetBuildSizes().buildScratchSize;
+            largestScratchSize = std::max(largestScratchSize, m_BottomAccelerationStructures[i].GetBuildSizes().buildScratchSize);
+        }
+
+        // Scratch memory is only needed while building. Structures are built in batches whose scratch fits the budget, and each batch reuses the scratch of the one before.
+        const VkDeviceSize scratchBudget = std::max(largestScratchSize, m_ScratchBuffer->GetBudget());
+        m_ScratchBuffer->Reserve(std::min(totalMemory.buildScratchSize, scratchBudget));
 
+        // Generate the structures. Structures sharing a build policy are submitted together so that the cost of each policy can be timed on its own.
+        std::vector<bool> isGenerated(m_BottomAccelerationStructures.size(), false);
+
+        for (size_t i = 0; i != m_BottomAccelerationStructures.size(); ++i)
+        {
+            if (isGenerated[i])
+            {
+                continue;
+            }
+
+            const BuildPolicy& buildPolicy = m_BottomAccelerationStructures[i].GetBuildPolicy();
+            const VkBuildAccelerationStructureFlagsKHR buildFlags = buildPolicy.GetFlags();
+            const std::chrono::high_resolution_clock::time_point timer = std::chrono::high_resolution_clock::now();
+            uint32_t structureCount = 0;
+            uint32_t scratchBatchCount = 1;
+
+            SingleTimeCommands::Submit(GetCommandPool(), [&](VkCommandBuffer commandBuffer)
+            {
+                // Every batch is built with a single command so the driver can work on its structures in parallel, rather than one small build after another.
+                std::vector<VulkanBottomLevelAS*> scratchBatch;
+                VkDeviceSize scratchBufferOffset = 0;
+
+                for (size_t j = i; j != m_BottomAccelerationStructures.size(); ++j)
+                {
+                    if (isGenerated[j] || m_BottomAccelerationStructures[j].GetBuildPolicy().GetFlags() != buildFlags)
+                    {
+                        continue;
+                    }
+
+                    const VkDeviceSize scratchSize = m_BottomAccelerationStructures[j].GetBuildSizes().buildScratchSize;
+
+                    // Start a new batch once the scratch memory is used up, after the builds of the previous batch are done with it.
+                    if (scratchBufferOffset + scratchSize > scratchBudget)
+                    {
+                        VulkanBottomLevelAS::GenerateBatch(commandBuffer, scratchBatch);
+                        VulkanAccelerationStructure::MemoryBarrier(commandBuffer);
+
+                        scratchBatch.clear();
+                        scratchBufferOffset = 0;
+                        scratchBatchCount++;
+                    }
+
+                    m_BottomAccelerationStructures[j].PrepareGenerate(m_ScratchBuffer->GetBuffer(), scratchBufferOffset, *m_BottomASBuffer, resultBufferOffsets[j]);
+                    scratchBatch.push_back(&m_BottomAccelerationStructures[j]);
+                    scratchBufferOffset += scratchSize;
+                    debugUtilities.SetObjectName(m_BottomAccelerationStructures[j].GetHandle(), ("BLAS #" + std::to_string(j)).c_str());
+
+                    isGenerated[j] = true;
+                    structureCount++;
+                }
+
+                VulkanBottomLevelAS::GenerateBatch(commandBuffer, scratchBatch);
+            });
+
+            std::cout << "- BLAS Build (" << buildPolicy.GetName() << "): " << structureCount << " structures, " << scratchBatchCount << " build commands in " << ASUtilities::GetElapsedTime(timer) << " seconds.\n";
+        }
+
+        if (m_CompactAccelerationStructures && !m_BottomAccelerationStructures.empty())
+        {
+            CompactBottomLevelStructures();
+        }
+    }
+
+    void RaytracingApplication::CompactBottomLevelStructures()
+    {
+        const VulkanDevice& device = GetDevice();
+        const VulkanDebugUtilities& debugUtilities = device.GetDebugUtilities();
+        const uint32_t structureCount = static_cast<uint32_t>(m_BottomAccelerationStructures.size());
+        const std::chrono::high_resolution_clock::time_point timer = std::chrono::high_resolution_clock::now();
+
+        // The compacted sizes are only known once the builds have completed, so they have to be read back from a query pool.
+        VkQueryPoolCreateInfo queryPoolInfo = {};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR;
+        queryPoolInfo.queryCount = structureCount;
+
+        VkQueryPool queryPool = nullptr;
+        CheckResult(vkCreateQueryPool(device.GetHandle(), &queryPoolInfo, nullptr, &queryPool), "Compaction Query Pool Creation");
+
+        std::vector<VkAccelerationStructureKHR> handles(structureCount);
+
+        for (uint32_t i = 0; i != structureCount; ++i)
+        {
+            handles[i] = m_BottomAccelerationStructures[i].GetHandle();
+        }
+
+        SingleTimeCommands::Submit(GetCommandPool(), [&](VkCommandBuffer commandBuffer)
+        {
+            vkCmdResetQueryPool(commandBuffer, queryPool, 0, structureCount);
+            VulkanAccelerationStructure::MemoryBarrier(commandBuffer);
+
+            m_RaytracingCommandList->vkCmdWriteAccelerationStructuresPropertiesKHR(commandBuffer, structureCount, handles.data(), VK_QUERY_TYPE_ACCELERATION_STRUCTURE_COMPACTED_SIZE_KHR, queryPool, 0);
+        });
+
+        std::vector<VkDeviceSize> compactedSizes(structureCount);
+        CheckResult(vkGetQueryPoolResults(device.GetHandle(), queryPool, 0, structureCount, compactedSizes.size() * sizeof(VkDeviceSize), compactedSizes.data(), sizeof(VkDeviceSize),
+                                          VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT), "Compacted Size Query");
+
+        vkDestroyQueryPool(device.GetHandle(), queryPool, nullptr);
+
+        // Pack the compacted structures one after the other.
+        std::vector<VkDeviceSize> resultBufferOffsets(structureCount);
+        VkDeviceSize resultBufferOffset = 0;
+
+        for (uint32_t i = 0; i != structureCount; ++i)
+        {
+            resultBufferOffsets[i] = resultBufferOffset;
+            resultBufferOffset += VulkanAccelerationStructure::GetAlignedSize(compactedSizes[i]);
+        }
+
+        std::unique_ptr<VulkanBuffer> compactedBuffer(new VulkanBuffer(device, resultBufferOffset, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT));
+        std::unique_ptr<VulkanDeviceMemory> compactedBufferMemory(new VulkanDeviceMemory(compactedBuffer->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, MemoryUsage::DeviceLocal)));
+
+        SingleTimeCommands::Submit(GetCommandPool(), [&](VkCommandBuffer commandBuffer)
+        {
+            for (uint32_t i = 0; i != structureCount; ++i)
+            {
+                m_BottomAccelerationStructures[i].Compact(commandBuffer, compactedSizes[i], *compactedBuffer, resultBufferOffsets[i]);
+            }
+        });
+
+        // The copies have completed, the original structures and their buffer can go.
+        for (uint32_t i = 0; i != structureCount; ++i)
+        {
+            m_BottomAccelerationStructures[i].ReleaseUncompacted();
             debugUtilities.SetObjectName(m_BottomAccelerationStructures[i].GetHandle(), ("BLAS #" + std::to_string(i)).c_str());
         }
+
+        m_BottomASBuffer.reset();
+        m_BottomASBufferMemory.reset();
+        m_BottomASBuffer = std::move(compactedBuffer);
+        m_BottomASBufferMemory = std::move(compactedBufferMemory);
+
+        debugUtilities.SetObjectName(m_BottomASBuffer->GetHandle(), "BLAS Buffer");
+        debugUtilities.SetObjectName(m_BottomASBufferMemory->GetHandle(), "BLAS Memory");
+
+        m_CompactedBottomLevelSize = resultBufferOffset;
+
+        std::cout << "- BLAS Compaction: " << ASUtilities::ToMegabytes(m_BottomLevelSize) << " MB to " << ASUtilities::ToMegabytes(m_CompactedBottomLevelSize) << " MB in " << ASUtilities::GetElapsedTime(timer) << " seconds.\n";
     }
 
-    void RaytracingApplication::CreateTopLevelStructures(VkCommandBuffer commandBuffer)
+    void RaytracingApplication::CreateTopLevelStructures()
     {
         const Resources::Scene& scene = GetScene();
         const VulkanDebugUtilities& debugUtilities = GetDevice().GetDebugUtilities();
@@ -303,41 +647,154 @@ namespace Vulkan::Raytracing
 
         // Hit Group 0 - Triangles
         // Hit Group 1 - Procedurals
+        // Every instance of a model references the model's bottom level structure. The custom index points into the scene's instance buffer.
+        // A batch of static models is placed once, the hit shaders add gl_GeometryIndexEXT to the custom index to find the model that was hit.
+        const std::vector<Resources::Model>& models = scene.GetModels();
         uint32_t instanceID = 0;
 
-        for (const auto& model : scene.GetModels())
+        for (size_t i = 0; i != m_BottomLevelBatches.size(); ++i)
         {
-            instances.push_back(VulkanTopLevelAS::CreateASInstance(m_BottomAccelerationStructures[instanceID], glm::mat4(1.0f), instanceID, model.GetProcedural() ? 1 : 0));
-            instanceID++;
+            const BottomLevelBatch& batch = m_BottomLevelBatches[i];
+            const Resources::Model& firstModel = models[batch.m_FirstModel];
+            const uint32_t hitGroupID = firstModel.GetProcedural() ? 1 : 0;
+
+            if (batch.m_ModelCount > 1)
+            {
+                instances.push_back(VulkanTopLevelAS::CreateASInstance(m_BottomAccelerationStructures[i], glm::mat4(1.0f), instanceID, hitGroupID));
+                instanceID += batch.m_ModelCount;
+                m_ModelTopLevelInstances.insert(m_ModelTopLevelInstances.end(), batch.m_ModelCount, std::numeric_limits<uint32_t>::max());
+                continue;
+            }
+
+            m_ModelTopLevelInstances.push_back(static_cast<uint32_t>(instances.size()));
+
+            for (const Resources::ModelInstance& instance : firstModel.GetInstances())
+            {
+                instances.push_back(VulkanTopLevelAS::CreateASInstance(m_BottomAccelerationStructures[i], instance.m_Transform, instanceID, hitGroupID));
+                instanceID++;
+            }
         }
 
         // Create and copy instances buffer (do it in a seperate one-time synchronous command buffer).
         VulkanBufferUtilities::CreateDeviceBuffer(GetCommandPool(), "TLAS Instances", VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR, instances, m_InstancesBuffer, m_InstancesBufferMemory);
 
-        // Memory Barrier for BLAS Builds
-        VulkanAccelerationStructure::MemoryBarrier(commandBuffer);
+        // Keep a copy of the instances, moving one only changes its transform.
+        m_TopLevelInstances = instances;
 
-        m_TopAccelerationStructures.emplace_back(*m_RaytracingCommandList, *m_RaytracingProperties, m_InstancesBuffer->GetDeviceAddress(), static_cast<uint32_t>(instances.size()));
+        m_TopAccelerationStructures.emplace_back(*m_RaytracingCommandList, *m_RaytracingProperties, m_InstancesBuffer->GetDeviceAddress(), static_cast<uint32_t>(instances.size()),
+                                                 ASUtilities::GetTopLevelBuildPolicy(GetScene().GetModels()));
 
         // Allocate the structure memory.
         const VkAccelerationStructureBuildSizesInfoKHR totalMemory = ASUtilities::GetTotalRequirements(m_TopAccelerationStructures);
 
         m_TopASBuffer.reset(new VulkanBuffer(GetDevice(), totalMemory.accelerationStructureSize, VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR));
-        m_TopASBufferMemory.reset(new VulkanDeviceMemory(m_TopASBuffer->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+        m_TopASBufferMemory.reset(new VulkanDeviceMemory(m_TopASBuffer->AllocateMemory(MemoryUsage::DeviceLocal)));
 
-        m_TopASScratchBuffer.reset(new VulkanBuffer(GetDevice(), totalMemory.buildScratchSize, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR));
-        m_TopASScratchBufferMemory.reset(new VulkanDeviceMemory(m_TopASScratchBuffer->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+        // The bottom level builds have completed, so the top level build and its later refits can use the start of the shared scratch buffer.
+        m_ScratchBuffer->Reserve(std::max(totalMemory.buildScratchSize, totalMemory.updateScratchSize));
 
         debugUtilities.SetObjectName(m_TopASBuffer->GetHandle(), "TLAS Buffer");
         debugUtilities.SetObjectName(m_TopASBufferMemory->GetHandle(), "TLAS Memory");
-        debugUtilities.SetObjectName(m_TopASScratchBuffer->GetHandle(), "TLAS Scratch Buffer");
-        debugUtilities.SetObjectName(m_TopASScratchBufferMemory->GetHandle(), "TLAS Scratch Memory");
         debugUtilities.SetObjectName(m_InstancesBuffer->GetHandle(), "TLAS Instances Buffer");
         debugUtilities.SetObjectName(m_InstancesBufferMemory->GetHandle(), "TLAS Instances Memory");
 
         // Generate the structure.
-        m_TopAccelerationStructures[0].Generate(commandBuffer, *m_TopASScratchBuffer, 0, *m_TopASBuffer, 0);
+        const std::chrono::high_resolution_clock::time_point timer = std::chrono::high_resolution_clock::now();
+
+        SingleTimeCommands::Submit(GetCommandPool(), [this](VkCommandBuffer commandBuffer)
+        {
+            // Memory Barrier for BLAS Builds
+            VulkanAccelerationStructure::MemoryBarrier(commandBuffer);
+
+            m_TopAccelerationStructures[0].Generate(commandBuffer, m_ScratchBuffer->GetBuffer(), 0, *m_TopASBuffer, 0);
+        });
+
         debugUtilities.SetObjectName(m_TopAccelerationStructures[0].GetHandle(), "TLAS");
+
+        std::cout << "- TLAS Build (" << m_TopAccelerationStructures[0].GetBuildPolicy().GetName() << "): " << instances.size() << " instances in " << ASUtilities::GetElapsedTime(timer) << " seconds.\n";
+    }
+
+    void RaytracingApplication::SetInstanceTransform(uint32_t modelIndex, uint32_t instanceIndex, const glm::mat4& transform)
+    {
+        const uint32_t firstInstance = m_ModelTopLevelInstances.at(modelIndex);
+
+        if (firstInstance == std::numeric_limits<uint32_t>::max() || !GetScene().GetModels()[modelIndex].IsDynamic())
+        {
+            throw std::runtime_error("Model " + std::to_string(modelIndex) + " is static and cannot be moved. Mark it as dynamic.");
+        }
+
+        if (instanceIndex >= GetScene().GetModels()[modelIndex].GetNumberOfInstances())
+        {
+            throw std::out_of_range("Model " + std::to_string(modelIndex) + " has no instance " + std::to_string(instanceIndex) + ".");
+        }
+
+        VulkanTopLevelAS::SetInstanceTransform(m_TopLevelInstances[firstInstance + instanceIndex], transform);
+        m_IsTopLevelOutdated = true;
+
+        m_PendingInstanceTransforms.emplace_back(GetScene().GetInstanceIndex(modelIndex, instanceIndex), transform);
+    }
+
+    void RaytracingApplication::UpdateInstanceBuffer(VkCommandBuffer commandBuffer)
+    {
+        if (m_PendingInstanceTransforms.empty())
+        {
+            return;
+        }
+
+        const VkBuffer instanceBuffer = GetScene().GetInstanceBuffer().GetHandle();
+
+        // Wait for earlier frames to finish reading the instances before overwriting them. Only the transforms change, the offsets and indices stay as uploaded.
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+        for (const auto& [instanceIndex, transform] : m_PendingInstanceTransforms)
+        {
+            vkCmdUpdateBuffer(commandBuffer, instanceBuffer, instanceIndex * sizeof(Resources::InstanceData) + offsetof(Resources::InstanceData, m_Transform), sizeof(transform), &transform);
+        }
+
+        VkMemoryBarrier memoryBarrier = {};
+        memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        memoryBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR,
+                             0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        m_PendingInstanceTransforms.clear();
+    }
+
+    void RaytracingApplication::UpdateTopLevelStructure(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+    {
+        const VkDeviceSize slotSize = m_TopLevelInstances.size() * sizeof(VkAccelerationStructureInstanceKHR);
+        const VkDeviceSize slotOffset = slotSize * imageIndex;
+
+        // The memory is host coherent, the writes are visible to the device once the frame is submitted.
+        std::memcpy(static_cast<uint8_t*>(m_TopLevelUpdateData) + slotOffset, m_TopLevelInstances.data(), slotSize);
+
+        const bool isFullRebuild = ++m_TopLevelRefitCount > ASUtilities::MaxTopLevelRefits;
+
+        if (isFullRebuild)
+        {
+            m_TopLevelRefitCount = 0;
+        }
+
+        // Wait for earlier frames to finish tracing against the structure and using the scratch buffer before rewriting them, then make the new structure visible to this frame's rays.
+        VkMemoryBarrier memoryBarrier = {};
+        memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        memoryBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+        memoryBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+                             0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        m_TopAccelerationStructures[0].Update(commandBuffer, m_TopLevelUpdateBuffer->GetDeviceAddress() + slotOffset, m_ScratchBuffer->GetBuffer(), 0, isFullRebuild);
+
+        memoryBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+        memoryBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+
+        m_IsTopLevelOutdated = false;
     }
 
     void RaytracingApplication::CreateOutputImage()
@@ -346,12 +803,12 @@ namespace Vulkan::Raytracing
         const VkFormat format = GetSwapChain().GetFormat();
         const VkImageTiling tiling = VK_IMAGE_TILING_OPTIMAL; // We will always go for optimal tiling.
 
-        m_AccumulationImage.reset(new VulkanImage(GetDevice(), extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT));
-        m_AccumulationImageMemory.reset(new VulkanDeviceMemory(m_AccumulationImage->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+        m_AccumulationImage.reset(new VulkanImage(GetDevice(), extent, VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
+        m_AccumulationImageMemory.reset(new VulkanDeviceMemory(m_AccumulationImage->AllocateMemory(MemoryUsage::DeviceLocal)));
         m_AccumulationImageView.reset(new VulkanImageView(GetDevice(), m_AccumulationImage->GetHandle(), VK_FORMAT_R32G32B32A32_SFLOAT, VK_IMAGE_ASPECT_COLOR_BIT));
 
         m_OutputImage.reset(new VulkanImage(GetDevice(), extent, format, tiling, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
-        m_OutputImageMemory.reset(new VulkanDeviceMemory(m_OutputImage->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+        m_OutputImageMemory.reset(new VulkanDeviceMemory(m_OutputImage->AllocateMemory(MemoryUsage::DeviceLocal)));
         m_OutputImageView.reset(new VulkanImageView(GetDevice(), m_OutputImage->GetHandle(), format, VK_IMAGE_ASPECT_COLOR_BIT));
 
         const VulkanDebugUtilities& debugUtilities = GetDevice().GetDebugUtilities();
@@ -1,5 +1,6 @@
 #pragma once
 #include "Vulkan/Application.h"
+#include "Math/Math.h"
 
 namespace Vulkan
 {
@@ -12,6 +13,14 @@ namespace Vulkan
 
 namespace Vulkan::Raytracing
 {
+    // A run of consecutive scene models that share one bottom level acceleration structure, one geometry per model.
+    struct BottomLevelBatch final
+    {
+        uint32_t m_FirstModel;
+        uint32_t m_ModelCount;
+        bool m_IsStatic; // Static models are placed once without a transform, so their geometry can be merged with their neighbours.
+    };
+
     class RaytracingApplication : public Vulkan::Application
     {
     public:
@@ -29,9 +38,35 @@ namespace Vulkan::Raytracing
         void CreateAccelerationStructures();
         void DeleteAccelerationStructures();
 
+        // Merges static models into shared bottom level structures on the next call to CreateAccelerationStructures().
+        void SetBatchStaticGeometry(bool isEnabled) { m_BatchStaticGeometry = isEnabled; }
+        // Copies every bottom level structure into a tightly packed buffer after it is built.
+        void SetCompactAccelerationStructures(bool isEnabled) { m_CompactAccelerationStructures = isEnabled; }
+
+        // Moves an instance of a dynamic model. The top level structure is refit at the start of the next rendered frame, the rasterizer's
+        // instance buffer is written by the next call to UpdateInstanceBuffer().
+        void SetInstanceTransform(uint32_t modelIndex, uint32_t instanceIndex, const glm::mat4& transform);
+
+        VkDeviceSize GetBottomLevelSize() const { return m_BottomLevelSize; }
+        VkDeviceSize GetCompactedBottomLevelSize() const { return m_CompactedBottomLevelSize; } // 0 if compaction is disabled.
+
+        // Copies the accumulation image back to the host as RGBA floats, holding the sum of every sample traced so far. Waits for the copy to complete.
+        std::vector<float> ReadAccumulationImage() const;
+
+    protected:
+        // Records the transforms set since the last call into the scene's instance buffer. Must be called outside of a render pass, before drawing.
+        void UpdateInstanceBuffer(VkCommandBuffer commandBuffer);
+
     private:
-        void CreateBottomLevelStructures(VkCommandBuffer commandBuffer);
-        void CreateTopLevelStructures(VkCommandBuffer commandBuffer);
+        std::vector<BottomLevelBatch> CreateBottomLevelBatches(bool batchStaticGeometry) const;
+        std::vector<class VulkanBottomLevelAS> CreateBottomLevelList(const std::vector<BottomLevelBatch>& batches) const;
+        uint32_t GetTopLevelInstanceCount(const std::vector<BottomLevelBatch>& batches) const;
+        void PrintAccelerationStructureStatistics() const;
+
+        void CreateBottomLevelStructures();
+        void CompactBottomLevelStructures();
+        void UpdateTopLevelStructure(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+        void CreateTopLevelStructures();
         void CreateOutputImage();
 
     private:
@@ -40,21 +75,34 @@ namespace Vulkan::Raytracing
         std::unique_ptr<class VulkanRaytracingProperties> m_RaytracingProperties;
         std::unique_ptr<class VulkanRaytracingPipeline> m_RaytracingPipeline;
         std::unique_ptr<class VulkanShaderBindingTable> m_ShaderBindingTable;
+        std::unique_ptr<class VulkanScratchBuffer> m_ScratchBuffer; // Shared by every build and update, and kept across scene reloads.
+
+        bool m_BatchStaticGeometry = true;
+        bool m_CompactAccelerationStructures = true;
+        VkDeviceSize m_BottomLevelSize = 0;
+        VkDeviceSize m_CompactedBottomLevelSize = 0;
+        std::vector<BottomLevelBatch> m_BottomLevelBatches;
 
         std::vector<class VulkanBottomLevelAS> m_BottomAccelerationStructures;
         std::unique_ptr<VulkanBuffer> m_BottomASBuffer;
         std::unique_ptr<VulkanDeviceMemory> m_BottomASBufferMemory;
-        std::unique_ptr<VulkanBuffer> m_BottomASScratchBuffer;
-        std::unique_ptr<VulkanDeviceMemory> m_BottomASScratchBufferMemory;
 
         std::vector<class VulkanTopLevelAS> m_TopAccelerationStructures;
         std::unique_ptr<VulkanBuffer> m_TopASBuffer;
         std::unique_ptr<VulkanDeviceMemory> m_TopASBufferMemory;
-        std::unique_ptr<VulkanBuffer> m_TopASScratchBuffer;
-        std::unique_ptr<VulkanDeviceMemory> m_TopASScratchBufferMemory;
         std::unique_ptr<VulkanBuffer> m_InstancesBuffer;
         std::unique_ptr<VulkanDeviceMemory> m_InstancesBufferMemory;
 
+        // Top level updates. The instances are rewritten into the swapchain image's slot of a persistently mapped buffer before each refit.
+        std::vector<VkAccelerationStructureInstanceKHR> m_TopLevelInstances;
+        std::vector<uint32_t> m_ModelTopLevelInstances; // First top level instance of each model, or UINT32_MAX if the model is batched.
+        std::unique_ptr<VulkanBuffer> m_TopLevelUpdateBuffer;
+        std::unique_ptr<VulkanDeviceMemory> m_TopLevelUpdateBufferMemory;
+        void* m_TopLevelUpdateData = nullptr;
+        uint32_t m_TopLevelRefitCount = 0;
+        bool m_IsTopLevelOutdated = false;
+        std::vector<std::pair<uint32_t, glm::mat4>> m_PendingInstanceTransforms; // Scene instance index and its new transform.
+
         std::unique_ptr<VulkanImage> m_AccumulationImage;
         std::unique_ptr<VulkanDeviceMemory> m_AccumulationImageMemory;
         std::unique_ptr<VulkanImageView> m_AccumulationImageView;
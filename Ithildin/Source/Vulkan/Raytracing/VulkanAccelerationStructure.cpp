@@ -6,23 +6,60 @@
 
 namespace Vulkan::Raytracing
 {
-    VulkanAccelerationStructure::VulkanAccelerationStructure(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties)
-                               : m_CommandList(commandList), m_BuildFlags(VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR), // We are prioritizing fast tracing over build time.
-                                 m_Device(m_CommandList.GetDevice()), m_RaytracingProperties(raytracingProperties)
+    VkBuildAccelerationStructureFlagsKHR BuildPolicy::GetFlags() const
+    {
+        VkBuildAccelerationStructureFlagsKHR flags = m_PreferFastTrace ? VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR : VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_BUILD_BIT_KHR;
+
+        if (m_AllowUpdate)
+        {
+            flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_UPDATE_BIT_KHR; // Costs some trace performance and extra update scratch memory.
+        }
+
+        if (m_AllowCompaction)
+        {
+            flags |= VK_BUILD_ACCELERATION_STRUCTURE_ALLOW_COMPACTION_BIT_KHR;
+        }
+
+        return flags;
+    }
+
+    std::string BuildPolicy::GetName() const
+    {
+        std::string name = m_PreferFastTrace ? "Fast Trace" : "Fast Build";
+
+        if (m_AllowUpdate)
+        {
+            name += ", Update";
+        }
+
+        if (m_AllowCompaction)
+        {
+            name += ", Compaction";
+        }
+
+        return name;
+    }
+
+    VulkanAccelerationStructure::VulkanAccelerationStructure(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties, const BuildPolicy& buildPolicy)
+                               : m_CommandList(commandList), m_BuildPolicy(buildPolicy), m_BuildFlags(buildPolicy.GetFlags()),
+                                 m_Device(m_CommandList.GetDevice()), m_RaytracingProperties(raytracingProperties), m_AccelerationStructure(nullptr)
     {
     }
 
     VulkanAccelerationStructure::VulkanAccelerationStructure(VulkanAccelerationStructure&& otherAS) noexcept
-                               : m_CommandList(otherAS.m_CommandList), m_BuildFlags(otherAS.m_BuildFlags), m_BuildGeometryInfo(otherAS.m_BuildGeometryInfo), 
+                               : m_CommandList(otherAS.m_CommandList), m_BuildPolicy(otherAS.m_BuildPolicy), m_BuildFlags(otherAS.m_BuildFlags), m_BuildGeometryInfo(otherAS.m_BuildGeometryInfo), 
                                  m_BuildSizesInfo(otherAS.m_BuildSizesInfo), m_Device(otherAS.m_Device), m_RaytracingProperties(otherAS.m_RaytracingProperties),
-                                 m_AccelerationStructure(otherAS.m_AccelerationStructure)
+                                 m_UncompactedAccelerationStructure(otherAS.m_UncompactedAccelerationStructure), m_AccelerationStructure(otherAS.m_AccelerationStructure)
           
     {
+        otherAS.m_UncompactedAccelerationStructure = nullptr;
         otherAS.m_AccelerationStructure = nullptr;
     }
 
     VulkanAccelerationStructure::~VulkanAccelerationStructure()
     {
+        ReleaseUncompacted();
+
         if (m_AccelerationStructure != nullptr)
         {
             m_CommandList.vkDestroyAccelerationStructureKHR(m_Device.GetHandle(), m_AccelerationStructure, nullptr);
@@ -46,11 +83,9 @@ namespace Vulkan::Raytracing
         m_CommandList.vkGetAccelerationStructureBuildSizesKHR(m_Device.GetHandle(), VK_ACCELERATION_STRUCTURE_BUILD_TYPE_DEVICE_KHR, 
                                                               &m_BuildGeometryInfo, pMaxPrimitiveCounts, &sizeInfo);
 
-        // AccelerationStructure offset needs to be 256 bytes aligned according to Vulkan specifications. https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkAccelerationStructureCreateInfoKHR.html
-        const uint64_t accelerationStructureAlignment = 256;
         const uint64_t scratchMemoryAlignment = m_RaytracingProperties.GetMinAccelerationStructureScratchOffsetAlignment();
 
-        sizeInfo.accelerationStructureSize = RoundUp(sizeInfo.accelerationStructureSize, accelerationStructureAlignment);
+        sizeInfo.accelerationStructureSize = GetAlignedSize(sizeInfo.accelerationStructureSize);
         sizeInfo.buildScratchSize = RoundUp(sizeInfo.buildScratchSize, scratchMemoryAlignment);
 
         return sizeInfo;
@@ -69,6 +104,41 @@ namespace Vulkan::Raytracing
         CheckResult(m_CommandList.vkCreateAccelerationStructureKHR(m_Device.GetHandle(), &creationInfo, nullptr, &m_AccelerationStructure), "Acceleration Structure Creation");
     }
 
+    void VulkanAccelerationStructure::Compact(VkCommandBuffer commandBuffer, VkDeviceSize compactedSize, VulkanBuffer& resultBuffer, VkDeviceSize resultOffset)
+    {
+        m_UncompactedAccelerationStructure = m_AccelerationStructure;
+        m_AccelerationStructure = nullptr;
+
+        // From here on the structure only occupies its compacted size.
+        m_BuildSizesInfo.accelerationStructureSize = GetAlignedSize(compactedSize);
+        CreateAccelerationStructure(resultBuffer, resultOffset);
+
+        VkCopyAccelerationStructureInfoKHR copyInfo = {};
+        copyInfo.sType = VK_STRUCTURE_TYPE_COPY_ACCELERATION_STRUCTURE_INFO_KHR;
+        copyInfo.src = m_UncompactedAccelerationStructure;
+        copyInfo.dst = m_AccelerationStructure;
+        copyInfo.mode = VK_COPY_ACCELERATION_STRUCTURE_MODE_COMPACT_KHR;
+
+        m_CommandList.vkCmdCopyAccelerationStructureKHR(commandBuffer, &copyInfo);
+    }
+
+    void VulkanAccelerationStructure::ReleaseUncompacted()
+    {
+        if (m_UncompactedAccelerationStructure != nullptr)
+        {
+            m_CommandList.vkDestroyAccelerationStructureKHR(m_Device.GetHandle(), m_UncompactedAccelerationStructure, nullptr);
+            m_UncompactedAccelerationStructure = nullptr;
+        }
+    }
+
+    VkDeviceSize VulkanAccelerationStructure::GetAlignedSize(VkDeviceSize size)
+    {
+        // AccelerationStructure offset needs to be 256 bytes aligned according to Vulkan specifications. https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkAccelerationStructureCreateInfoKHR.html
+        const uint64_t accelerationStructureAlignment = 256;
+
+        return RoundUp(size, accelerationStructureAlignment);
+    }
+
     void VulkanAccelerationStructure::MemoryBarrier(VkCommandBuffer commandBuffer)
     {
         // Wait for the builder to complete by setting a barrier on the resulting buffer. This is important as the construction of the top level hierarchy may be called right afterwards, before executing the command list.
@@ -76,7 +146,7 @@ namespace Vulkan::Raytracing
         memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
         memoryBarrier.pNext = nullptr;
         memoryBarrier.srcAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
-        memoryBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+        memoryBarrier.dstAccessMask = VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR | VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR;
 
         vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
     }
@@ -1,5 +1,6 @@
 #pragma once
 #include "Core/Core.h"
+#include <string>
 
 namespace Vulkan
 {
@@ -12,6 +13,21 @@ namespace Vulkan
         class VulkanRaytracingCommandList;
         class VulkanRaytracingProperties;
 
+        // How the driver should trade build time against trace performance, and which operations the structure must support once built.
+        struct BuildPolicy final
+        {
+            bool m_PreferFastTrace = true;  // Otherwise prefer fast builds.
+            bool m_AllowUpdate = false;     // The structure can be refit in place from new input data.
+            bool m_AllowCompaction = false; // The structure can be copied into a smaller one once built.
+
+            // Static geometry is built once and traced every frame. Dynamic content is rebuilt or refit often.
+            static BuildPolicy Static() { return { true, false, false }; }
+            static BuildPolicy Dynamic() { return { false, true, false }; }
+
+            VkBuildAccelerationStructureFlagsKHR GetFlags() const;
+            std::string GetName() const;
+        };
+
         class VulkanAccelerationStructure
         {
         public:
@@ -21,17 +37,25 @@ namespace Vulkan
             const VulkanDevice& GetDevice() const { return m_Device; }
             const VulkanRaytracingCommandList& GetCommandList() const { return m_CommandList; }
             const VkAccelerationStructureBuildSizesInfoKHR GetBuildSizes() const { return m_BuildSizesInfo; }
+            const BuildPolicy& GetBuildPolicy() const { return m_BuildPolicy; }
+
+            // Recreates the structure at resultOffset in resultBuffer with its compacted size and records the copy into it.
+            // The original structure stays alive until ReleaseUncompacted() is called once the copy has completed.
+            void Compact(VkCommandBuffer commandBuffer, VkDeviceSize compactedSize, VulkanBuffer& resultBuffer, VkDeviceSize resultOffset);
+            void ReleaseUncompacted();
 
             static void MemoryBarrier(VkCommandBuffer commandBuffer);
+            static VkDeviceSize GetAlignedSize(VkDeviceSize size); // Structures must be placed at 256 byte aligned offsets.
 
         protected:
-            explicit VulkanAccelerationStructure(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties);
+            explicit VulkanAccelerationStructure(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties, const BuildPolicy& buildPolicy);
 
             VkAccelerationStructureBuildSizesInfoKHR GetBuildSizes(const uint32_t* pMaxPrimitiveCounts) const;
             void CreateAccelerationStructure(VulkanBuffer& resultBuffer, VkDeviceSize resultOffset);
 
         protected:
             const VulkanRaytracingCommandList& m_CommandList;
+            const BuildPolicy m_BuildPolicy;
             const VkBuildAccelerationStructureFlagsKHR m_BuildFlags;
             VkAccelerationStructureBuildGeometryInfoKHR m_BuildGeometryInfo = {};
             VkAccelerationStructureBuildSizesInfoKHR m_BuildSizesInfo = {};
@@ -39,6 +63,7 @@ namespace Vulkan
         private:
             const VulkanDevice& m_Device;
             const VulkanRaytracingProperties& m_RaytracingProperties;
+            VkAccelerationStructureKHR m_UncompactedAccelerationStructure = nullptr;
 
             VULKAN_HANDLE(VkAccelerationStructureKHR, m_AccelerationStructure)
         };
@@ -6,8 +6,8 @@
 
 namespace Vulkan::Raytracing
 {
-    VulkanBottomLevelAS::VulkanBottomLevelAS(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties, const VulkanBottomLevelGeometry& geometry)
-                        : VulkanAccelerationStructure(commandList, raytracingProperties), m_Geometries(geometry)
+    VulkanBottomLevelAS::VulkanBottomLevelAS(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties, const VulkanBottomLevelGeometry& geometry, const BuildPolicy& buildPolicy)
+                        : VulkanAccelerationStructure(commandList, raytracingProperties, buildPolicy), m_Geometries(geometry)
     {
         m_BuildGeometryInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_BUILD_GEOMETRY_INFO_KHR;
         m_BuildGeometryInfo.flags = m_BuildFlags;
@@ -40,15 +40,41 @@ namespace Vulkan::Raytracing
 
     void VulkanBottomLevelAS::Generate(VkCommandBuffer commandBuffer, VulkanBuffer& scratchBuffer, VkDeviceSize scratchBufferOffset, VulkanBuffer& resultBuffer, VkDeviceSize resultBufferOffset)
     {
-        // Create the acceleration structure.
-        CreateAccelerationStructure(resultBuffer, resultBufferOffset);
+        PrepareGenerate(scratchBuffer, scratchBufferOffset, resultBuffer, resultBufferOffset);
 
         // Build the actual bottom-level acceleration structure.
         const VkAccelerationStructureBuildRangeInfoKHR* pBuildOffsetInfo = m_Geometries.GetBuildOffsetInfo().data();
 
+        m_CommandList.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &m_BuildGeometryInfo, &pBuildOffsetInfo);
+    }
+
+    void VulkanBottomLevelAS::PrepareGenerate(VulkanBuffer& scratchBuffer, VkDeviceSize scratchBufferOffset, VulkanBuffer& resultBuffer, VkDeviceSize resultBufferOffset)
+    {
+        // Create the acceleration structure.
+        CreateAccelerationStructure(resultBuffer, resultBufferOffset);
+
         m_BuildGeometryInfo.dstAccelerationStructure = GetHandle();
         m_BuildGeometryInfo.scratchData.deviceAddress = scratchBuffer.GetDeviceAddress() + scratchBufferOffset;
+    }
 
-        m_CommandList.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &m_BuildGeometryInfo, &pBuildOffsetInfo);
+    void VulkanBottomLevelAS::GenerateBatch(VkCommandBuffer commandBuffer, const std::vector<VulkanBottomLevelAS*>& bottomLevelStructures)
+    {
+        if (bottomLevelStructures.empty())
+        {
+            return;
+        }
+
+        std::vector<VkAccelerationStructureBuildGeometryInfoKHR> buildGeometryInfos;
+        std::vector<const VkAccelerationStructureBuildRangeInfoKHR*> buildOffsetInfos;
+        buildGeometryInfos.reserve(bottomLevelStructures.size());
+        buildOffsetInfos.reserve(bottomLevelStructures.size());
+
+        for (const VulkanBottomLevelAS* bottomLevelAS : bottomLevelStructures)
+        {
+            buildGeometryInfos.push_back(bottomLevelAS->m_BuildGeometryInfo);
+            buildOffsetInfos.push_back(bottomLevelAS->m_Geometries.GetBuildOffsetInfo().data());
+        }
+
+        bottomLevelStructures[0]->m_CommandList.vkCmdBuildAccelerationStructuresKHR(commandBuffer, static_cast<uint32_t>(buildGeometryInfos.size()), buildGeometryInfos.data(), buildOffsetInfos.data());
     }
 }
\ No newline at end of file
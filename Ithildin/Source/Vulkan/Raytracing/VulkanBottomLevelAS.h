@@ -1,6 +1,7 @@
 #pragma once
 #include "VulkanAccelerationStructure.h"
 #include "VulkanBottomLevelGeometry.h"
+#include <vector>
 
 namespace Resources
 {
@@ -16,12 +17,18 @@ namespace Vulkan::Raytracing
     class VulkanBottomLevelAS final : public VulkanAccelerationStructure
     {
     public:
-        VulkanBottomLevelAS(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties, const VulkanBottomLevelGeometry& geometry);
+        VulkanBottomLevelAS(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties, const VulkanBottomLevelGeometry& geometry, const BuildPolicy& buildPolicy);
         VulkanBottomLevelAS(VulkanBottomLevelAS&& otherAS) noexcept;
         ~VulkanBottomLevelAS();
 
         void Generate(VkCommandBuffer commandBuffer, VulkanBuffer& scratchBuffer, VkDeviceSize scratchBufferOffset, VulkanBuffer& resultBuffer, VkDeviceSize resultBufferOffset);
 
+        // Creates the structure and fills in its build info without recording the build, so that several structures can be built by GenerateBatch().
+        void PrepareGenerate(VulkanBuffer& scratchBuffer, VkDeviceSize scratchBufferOffset, VulkanBuffer& resultBuffer, VkDeviceSize resultBufferOffset);
+
+        // Records the builds of prepared structures with a single command, which lets the driver build them in parallel. Their scratch ranges must not overlap.
+        static void GenerateBatch(VkCommandBuffer commandBuffer, const std::vector<VulkanBottomLevelAS*>& bottomLevelStructures);
+
     private:
         VulkanBottomLevelGeometry m_Geometries;
     };
@@ -15,8 +15,8 @@ namespace Vulkan::Raytracing
         geometryInfo.geometryType = VK_GEOMETRY_TYPE_TRIANGLES_KHR;
         geometryInfo.geometry.triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
         geometryInfo.geometry.triangles.pNext = nullptr;
-        geometryInfo.geometry.triangles.vertexData.deviceAddress = scene.GetVertexBuffer().GetDeviceAddress();
-        geometryInfo.geometry.triangles.vertexStride = sizeof(Resources::Vertex);
+        geometryInfo.geometry.triangles.vertexData.deviceAddress = scene.GetPositionBuffer().GetDeviceAddress();
+        geometryInfo.geometry.triangles.vertexStride = sizeof(glm::vec3);
         geometryInfo.geometry.triangles.maxVertex = vertexCount;
         geometryInfo.geometry.triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
         geometryInfo.geometry.triangles.indexData.deviceAddress = scene.GetIndexBuffer().GetDeviceAddress();
@@ -25,7 +25,7 @@ namespace Vulkan::Raytracing
         geometryInfo.flags = isOpaque ? VK_GEOMETRY_OPAQUE_BIT_KHR : 0; // If opaque, indicate that the geometry does not invoke Any-Hit shaders even if present in a hit group.
     
         VkAccelerationStructureBuildRangeInfoKHR buildOffsetInfo = {};
-        buildOffsetInfo.firstVertex = vertexOffset / sizeof(Resources::Vertex);
+        buildOffsetInfo.firstVertex = vertexOffset / sizeof(glm::vec3);
         buildOffsetInfo.primitiveOffset = indexOffset;
         buildOffsetInfo.primitiveCount = indexCount / 3; 
         buildOffsetInfo.transformOffset = 0;
@@ -22,7 +22,7 @@ namespace Vulkan::Raytracing
         const VulkanTopLevelAS& accelerationStructure,
         const VulkanImageView& accumulationImageView,
         const VulkanImageView& outputImageView,
-        const std::vector<Resources::UniformBuffer>& uniformBuffers,
+        const Resources::UniformBuffer& uniformBuffer,
         const Resources::Scene& scene) : m_SwapChain(swapChain)
     {
         // Create descriptor pool/sets.
@@ -39,11 +39,11 @@ namespace Vulkan::Raytracing
             // Camera Information & Others
             { 3, 1, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_RAYGEN_BIT_KHR | VK_SHADER_STAGE_MISS_BIT_KHR },
 
-            // Vertex Buffer, Index Buffer, Material buffer, Offset Buffer
+            // Vertex Buffer, Index Buffer, Material buffer, Instance Buffer
             { 4, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR },
             { 5, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR },
             { 6, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR },
-            { 7, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR },
+            { 7, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR },
 
             // Textures and Image samplers
             { 8, static_cast<uint32_t>(scene.GetTextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR },
@@ -52,7 +52,7 @@ namespace Vulkan::Raytracing
             { 9, 1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_CLOSEST_HIT_BIT_KHR | VK_SHADER_STAGE_INTERSECTION_BIT_KHR }
         };
 
-        m_DescriptorSetManager.reset(new VulkanDescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+        m_DescriptorSetManager.reset(new VulkanDescriptorSetManager(device, descriptorBindings, uniformBuffer.GetSlotCount()));
 
         VulkanDescriptorSets& descriptorSets = m_DescriptorSetManager->GetDescriptorSets();
 
@@ -79,8 +79,9 @@ namespace Vulkan::Raytracing
 
             // Uniform Buffer
             VkDescriptorBufferInfo uniformBufferInfo = {};
-            uniformBufferInfo.buffer = uniformBuffers[i].GetBuffer().GetHandle();
-            uniformBufferInfo.range = VK_WHOLE_SIZE;
+            uniformBufferInfo.buffer = uniformBuffer.GetBuffer().GetHandle();
+            uniformBufferInfo.offset = uniformBuffer.GetSlotOffset(i);
+            uniformBufferInfo.range = uniformBuffer.GetSlotSize();
 
             // Vertex Buffer
             VkDescriptorBufferInfo vertexBufferInfo = {};
@@ -97,10 +98,10 @@ namespace Vulkan::Raytracing
             materialBufferInfo.buffer = scene.GetMaterialBuffer().GetHandle();
             materialBufferInfo.range = VK_WHOLE_SIZE;
 
-            // Offsets Buffer
-            VkDescriptorBufferInfo offsetsBufferInfo = {};
-            offsetsBufferInfo.buffer = scene.GetOffsetBuffer().GetHandle();
-            offsetsBufferInfo.range = VK_WHOLE_SIZE;
+            // Instance Buffer
+            VkDescriptorBufferInfo instanceBufferInfo = {};
+            instanceBufferInfo.buffer = scene.GetInstanceBuffer().GetHandle();
+            instanceBufferInfo.range = VK_WHOLE_SIZE;
 
             // Image and Texture Samplers
             std::vector<VkDescriptorImageInfo> imageInfos(scene.GetTextureSamplers().size());
@@ -122,7 +123,7 @@ namespace Vulkan::Raytracing
                 descriptorSets.Bind(i, 4, vertexBufferInfo),
                 descriptorSets.Bind(i, 5, indexBufferInfo),
                 descriptorSets.Bind(i, 6, materialBufferInfo),
-                descriptorSets.Bind(i, 7, offsetsBufferInfo),
+                descriptorSets.Bind(i, 7, instanceBufferInfo),
                 descriptorSets.Bind(i, 8, *imageInfos.data(), static_cast<uint32_t>(imageInfos.size()))
             };
 
@@ -27,7 +27,7 @@ namespace Vulkan::Raytracing
     public:
         VulkanRaytracingPipeline(const VulkanRaytracingCommandList& commandList, const VulkanSwapChain& swapChain, const VulkanTopLevelAS& accelerationStructure,
                                  const VulkanImageView& accumulationImageView, const VulkanImageView& outputImageView, 
-                                 const std::vector<Resources::UniformBuffer>& uniformBuffers, const Resources::Scene& scene);
+                                 const Resources::UniformBuffer& uniformBuffer, const Resources::Scene& scene);
         ~VulkanRaytracingPipeline();
 
         uint32_t GetRayGenerationShaderIndex() const { return m_RayGenerationShaderIndex; }
@@ -0,0 +1,41 @@
+#include "VulkanScratchBuffer.h"
+#include "VulkanRaytracingProperties.h"
+#include "../VulkanBuffer.h"
+#include "../VulkanDevice.h"
+#include "../VulkanDebugUtilities.h"
+
+namespace Vulkan::Raytracing
+{
+    VulkanScratchBuffer::VulkanScratchBuffer(const VulkanDevice& device, const VulkanRaytracingProperties& raytracingProperties, VkDeviceSize budget)
+                                           : m_Device(device), m_RaytracingProperties(raytracingProperties), m_Budget(budget)
+    {
+    }
+
+    VulkanScratchBuffer::~VulkanScratchBuffer()
+    {
+        m_Buffer.reset();
+        m_BufferMemory.reset(); // Release memory after the bound buffer has been destroyed.
+    }
+
+    void VulkanScratchBuffer::Reserve(VkDeviceSize size)
+    {
+        if (size <= m_Size)
+        {
+            return;
+        }
+
+        m_Buffer.reset();
+        m_BufferMemory.reset();
+
+        m_Buffer.reset(new VulkanBuffer(m_Device, size, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_STORAGE_BIT_KHR));
+        // Builds use the buffer address plus multiples of aligned scratch sizes, so the start of the buffer must meet the scratch alignment too.
+        const VkDeviceSize scratchAlignment = m_RaytracingProperties.GetMinAccelerationStructureScratchOffsetAlignment();
+        m_BufferMemory.reset(new VulkanDeviceMemory(m_Buffer->AllocateMemory(VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT, MemoryUsage::DeviceLocal, scratchAlignment)));
+        m_Size = size;
+
+        const VulkanDebugUtilities& debugUtilities = m_Device.GetDebugUtilities();
+
+        debugUtilities.SetObjectName(m_Buffer->GetHandle(), "AS Scratch Buffer");
+        debugUtilities.SetObjectName(m_BufferMemory->GetHandle(), "AS Scratch Memory");
+    }
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+#include "Core/Core.h"
+#include <memory>
+
+namespace Vulkan
+{
+    class VulkanBuffer;
+    class VulkanDevice;
+    class VulkanDeviceMemory;
+
+    namespace Raytracing
+    {
+        class VulkanRaytracingProperties;
+
+        // Scratch memory shared by every acceleration structure build and update. It only ever grows, so reloading a scene reuses the allocation of the largest scene so far.
+        // The budget caps how much scratch a single batch of builds should use. A larger structure still gets the memory it needs, but is then built on its own.
+        class VulkanScratchBuffer final
+        {
+        public:
+            VulkanScratchBuffer(const VulkanDevice& device, const VulkanRaytracingProperties& raytracingProperties, VkDeviceSize budget);
+            ~VulkanScratchBuffer();
+
+            VulkanBuffer& GetBuffer() const { return *m_Buffer; }
+            VkDeviceSize GetBudget() const { return m_Budget; }
+            VkDeviceSize GetSize() const { return m_Size; }
+
+            // Grows the buffer to hold at least size bytes. The previous contents are lost, so the device must not be using the buffer.
+            void Reserve(VkDeviceSize size);
+
+        private:
+            const VulkanDevice& m_Device;
+            const VulkanRaytracingProperties& m_RaytracingProperties;
+            const VkDeviceSize m_Budget;
+            VkDeviceSize m_Size = 0;
+
+            std::unique_ptr<VulkanBuffer> m_Buffer;
+            std::unique_ptr<VulkanDeviceMemory> m_BufferMemory;
+        };
+    }
+}
\ No newline at end of file
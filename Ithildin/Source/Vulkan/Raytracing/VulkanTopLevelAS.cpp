@@ -3,12 +3,13 @@
 #include "VulkanRaytracingCommandList.h"
 #include "../VulkanBuffer.h"
 #include "../VulkanDevice.h"
+#include <stdexcept>
 #include <string>
 
 namespace Vulkan::Raytracing
 {
-    VulkanTopLevelAS::VulkanTopLevelAS(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties, VkDeviceAddress instanceAddress, uint32_t instancesCount)
-                                     : VulkanAccelerationStructure(commandList, raytracingProperties), m_InstancesCount(instancesCount)
+    VulkanTopLevelAS::VulkanTopLevelAS(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties, VkDeviceAddress instanceAddress, uint32_t instancesCount, const BuildPolicy& buildPolicy)
+                                     : VulkanAccelerationStructure(commandList, raytracingProperties, buildPolicy), m_InstancesCount(instancesCount)
     {
         // Create VkAccelerationStructureGeometryInstancesDataKHGR. This wraps a device pointer to the above uploaded instances.
         m_VulkanASInstancesInfo.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_INSTANCES_DATA_KHR;
@@ -31,9 +32,10 @@ namespace Vulkan::Raytracing
         m_BuildSizesInfo = GetBuildSizes(&instancesCount);
     }
 
-    VulkanTopLevelAS::VulkanTopLevelAS(VulkanTopLevelAS&& otherAS) noexcept : VulkanAccelerationStructure(std::move(otherAS)), m_InstancesCount(otherAS.m_InstancesCount)
+    VulkanTopLevelAS::VulkanTopLevelAS(VulkanTopLevelAS&& otherAS) noexcept : VulkanAccelerationStructure(std::move(otherAS)), m_InstancesCount(otherAS.m_InstancesCount),
+                                                                            m_VulkanASInstancesInfo(otherAS.m_VulkanASInstancesInfo), m_TopASGeometryInfo(otherAS.m_TopASGeometryInfo)
     {
-
+        m_BuildGeometryInfo.pGeometries = &m_TopASGeometryInfo; // The build info must point at our own copy of the geometry.
     }
 
     VulkanTopLevelAS::~VulkanTopLevelAS()
@@ -58,6 +60,29 @@ namespace Vulkan::Raytracing
         m_CommandList.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &m_BuildGeometryInfo, &pBuildOffsetInfo);
     }
 
+    void VulkanTopLevelAS::Update(VkCommandBuffer commandBuffer, VkDeviceAddress instanceAddress, VulkanBuffer& scratchBuffer, VkDeviceSize scratchBufferOffset, bool isFullRebuild)
+    {
+        if (!m_BuildPolicy.m_AllowUpdate)
+        {
+            throw std::runtime_error("Top level acceleration structure was not built to allow updates.");
+        }
+
+        // The instance count and flags must match the original build, only the instance data may change.
+        m_TopASGeometryInfo.geometry.instances.data.deviceAddress = instanceAddress;
+
+        VkAccelerationStructureBuildRangeInfoKHR buildOffsetInfo = {};
+        buildOffsetInfo.primitiveCount = m_InstancesCount;
+
+        const VkAccelerationStructureBuildRangeInfoKHR* pBuildOffsetInfo = &buildOffsetInfo;
+
+        m_BuildGeometryInfo.mode = isFullRebuild ? VK_BUILD_ACCELERATION_STRUCTURE_MODE_BUILD_KHR : VK_BUILD_ACCELERATION_STRUCTURE_MODE_UPDATE_KHR;
+        m_BuildGeometryInfo.srcAccelerationStructure = isFullRebuild ? nullptr : GetHandle(); // Refits happen in place.
+        m_BuildGeometryInfo.dstAccelerationStructure = GetHandle();
+        m_BuildGeometryInfo.scratchData.deviceAddress = scratchBuffer.GetDeviceAddress() + scratchBufferOffset;
+
+        m_CommandList.vkCmdBuildAccelerationStructuresKHR(commandBuffer, 1, &m_BuildGeometryInfo, &pBuildOffsetInfo);
+    }
+
     VkAccelerationStructureInstanceKHR VulkanTopLevelAS::CreateASInstance(const VulkanBottomLevelAS& bottomLevelAS, const glm::mat4& transform, uint32_t instanceID, uint32_t hitGroupID)
     {
         const VulkanDevice& device = bottomLevelAS.GetDevice();
@@ -78,9 +103,16 @@ namespace Vulkan::Raytracing
         instanceInfo.flags = VK_GEOMETRY_INSTANCE_TRIANGLE_FACING_CULL_DISABLE_BIT_KHR; // Disable culling.
         instanceInfo.accelerationStructureReference = deviceAddress;
 
-        // The instance.transform value only contains 12 values, corresponding to a 3x4 matrix, hence saving the last row that is anyway always (0, 0, 0, 1). Since the matrix is row-major, we simply copy the first 12 values of the original 4x4 matrix.
-        std::memcpy(&instanceInfo.transform, &transform, sizeof(instanceInfo.transform));
+        SetInstanceTransform(instanceInfo, transform);
 
         return instanceInfo;
     }
+
+    void VulkanTopLevelAS::SetInstanceTransform(VkAccelerationStructureInstanceKHR& instance, const glm::mat4& transform)
+    {
+        // The instance.transform value only contains 12 values, corresponding to a 3x4 matrix, hence saving the last row that is anyway always (0, 0, 0, 1).
+        // Vulkan expects the matrix in row-major order while GLM stores it column-major, so we transpose it first and copy the first 12 values.
+        const glm::mat4 rowMajorTransform = glm::transpose(transform);
+        std::memcpy(&instance.transform, &rowMajorTransform, sizeof(instance.transform));
+    }
 }
\ No newline at end of file
@@ -12,12 +12,18 @@ namespace Vulkan::Raytracing
     class VulkanTopLevelAS final : public VulkanAccelerationStructure
     {
     public:
-        VulkanTopLevelAS(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties, VkDeviceAddress instanceAddress, uint32_t instancesCount);
+        VulkanTopLevelAS(const VulkanRaytracingCommandList& commandList, const VulkanRaytracingProperties& raytracingProperties, VkDeviceAddress instanceAddress, uint32_t instancesCount, const BuildPolicy& buildPolicy);
         VulkanTopLevelAS(VulkanTopLevelAS&& otherAS) noexcept;
         virtual ~VulkanTopLevelAS();
 
         void Generate(VkCommandBuffer commandBuffer, VulkanBuffer& scratchBuffer, VkDeviceSize scratchBufferOffset, VulkanBuffer& resultBuffer, VkDeviceSize resultBufferOffset);
+
+        // Rebuilds the generated structure in place from the instances at instanceAddress. Unless isFullRebuild is set, the existing hierarchy is only refit,
+        // which is much cheaper but degrades as instances move away from where they were when the hierarchy was built. Requires a policy that allows updates.
+        void Update(VkCommandBuffer commandBuffer, VkDeviceAddress instanceAddress, VulkanBuffer& scratchBuffer, VkDeviceSize scratchBufferOffset, bool isFullRebuild);
+
         static VkAccelerationStructureInstanceKHR CreateASInstance(const VulkanBottomLevelAS& bottomLevelAS, const glm::mat4& transform, uint32_t instanceID, uint32_t hitGroupID);
+        static void SetInstanceTransform(VkAccelerationStructureInstanceKHR& instance, const glm::mat4& transform);
 
     private:
         uint32_t m_InstancesCount;
@@ -24,17 +24,22 @@ namespace Vulkan
         }
     }
 
-    VulkanDeviceMemory VulkanBuffer::AllocateMemory(VkMemoryPropertyFlags propertyFlags)
+    VulkanDeviceMemory VulkanBuffer::AllocateMemory(MemoryUsage memoryUsage)
     {
-        return AllocateMemory(0, propertyFlags);
+        return AllocateMemory(0, memoryUsage);
     }
 
-    VulkanDeviceMemory VulkanBuffer::AllocateMemory(VkMemoryAllocateFlags allocationFlags, VkMemoryPropertyFlags propertyFlags)
+    VulkanDeviceMemory VulkanBuffer::AllocateMemory(VkMemoryAllocateFlags allocationFlags, MemoryUsage memoryUsage)
+    {
+        return AllocateMemory(allocationFlags, memoryUsage, 1);
+    }
+
+    VulkanDeviceMemory VulkanBuffer::AllocateMemory(VkMemoryAllocateFlags allocationFlags, MemoryUsage memoryUsage, VkDeviceSize minimumAlignment)
     {
         const VkMemoryRequirements memoryRequirements = GetMemoryRequirements();
-        VulkanDeviceMemory memory(m_Device, memoryRequirements.size, memoryRequirements.memoryTypeBits, allocationFlags, propertyFlags);
+        VulkanDeviceMemory memory(m_Device, memoryRequirements, allocationFlags, memoryUsage, minimumAlignment);
 
-        CheckResult(vkBindBufferMemory(m_Device.GetHandle(), m_Buffer, memory.GetHandle(), 0), "Buffer Memory Binding");
+        CheckResult(vkBindBufferMemory(m_Device.GetHandle(), m_Buffer, memory.GetHandle(), memory.GetOffset()), "Buffer Memory Binding");
 
         return memory;
     }
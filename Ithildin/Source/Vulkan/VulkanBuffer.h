@@ -15,8 +15,9 @@ namespace Vulkan
 
         const VulkanDevice& GetDevice() const { return m_Device; }
 
-        VulkanDeviceMemory AllocateMemory(VkMemoryPropertyFlags propertyFlags);
-        VulkanDeviceMemory AllocateMemory(VkMemoryAllocateFlags allocationFlags, VkMemoryPropertyFlags propertyFlags);
+        VulkanDeviceMemory AllocateMemory(MemoryUsage memoryUsage);
+        VulkanDeviceMemory AllocateMemory(VkMemoryAllocateFlags allocationFlags, MemoryUsage memoryUsage);
+        VulkanDeviceMemory AllocateMemory(VkMemoryAllocateFlags allocationFlags, MemoryUsage memoryUsage, VkDeviceSize minimumAlignment);
         VkMemoryRequirements GetMemoryRequirements() const;
         VkDeviceAddress GetDeviceAddress() const;
 
@@ -3,6 +3,7 @@
 #include "VulkanCommandPool.h"
 #include "VulkanDevice.h"
 #include "VulkanDeviceMemory.h"
+#include "VulkanUploadManager.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -18,6 +19,11 @@ namespace Vulkan
         template<typename T>
         static void CreateDeviceBuffer(VulkanCommandPool& commandPool, const char* name, VkBufferUsageFlags usageFlags, 
                                        const std::vector<T>& content, std::unique_ptr<VulkanBuffer>& buffer, std::unique_ptr<VulkanDeviceMemory>& memory);
+
+        // Same as above, but the copy is batched by the upload manager rather than submitted and waited on straight away.
+        template<typename T>
+        static void CreateDeviceBuffer(VulkanUploadManager& uploadManager, const char* name, VkBufferUsageFlags usageFlags,
+                                       const std::vector<T>& content, std::unique_ptr<VulkanBuffer>& buffer, std::unique_ptr<VulkanDeviceMemory>& memory);
     };
 
     template <typename T>
@@ -28,7 +34,7 @@ namespace Vulkan
 
         // Create a temporary host visible staging buffer.
         std::unique_ptr<VulkanBuffer> stagingBuffer = std::make_unique<VulkanBuffer>(device, contentSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
-        VulkanDeviceMemory stagingBufferMemory = stagingBuffer->AllocateMemory(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        VulkanDeviceMemory stagingBufferMemory = stagingBuffer->AllocateMemory(MemoryUsage::Staging);
 
         // Copy the host data into the staging buffer.
         const auto pointerToGPU = stagingBufferMemory.Map(0, contentSize);
@@ -52,11 +58,29 @@ namespace Vulkan
         const VkMemoryAllocateFlags allocateFlags = usageFlags & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT ? VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT : 0;
 
         buffer.reset(new VulkanBuffer(device, contentSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageFlags));
-        memory.reset(new VulkanDeviceMemory(buffer->AllocateMemory(allocateFlags, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)));
+        memory.reset(new VulkanDeviceMemory(buffer->AllocateMemory(allocateFlags, MemoryUsage::DeviceLocal)));
 
         debugUtilities.SetObjectName(buffer->GetHandle(), (name + std::string(" Buffer")).c_str());
         debugUtilities.SetObjectName(memory->GetHandle(), (name + std::string(" Memory")).c_str());
 
         CopyFromStagingBuffer(commandPool, *buffer, content);
     }
+
+    template<typename T>
+    void VulkanBufferUtilities::CreateDeviceBuffer(VulkanUploadManager& uploadManager, const char* name, VkBufferUsageFlags usageFlags,
+                            const std::vector<T>& content, std::unique_ptr<VulkanBuffer>& buffer, std::unique_ptr<VulkanDeviceMemory>& memory)
+    {
+        const VulkanDevice& device = uploadManager.GetDevice();
+        const VulkanDebugUtilities& debugUtilities = device.GetDebugUtilities();
+        const size_t contentSize = sizeof(content[0]) * content.size();
+        const VkMemoryAllocateFlags allocateFlags = usageFlags & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT ? VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT : 0;
+
+        buffer.reset(new VulkanBuffer(device, contentSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usageFlags));
+        memory.reset(new VulkanDeviceMemory(buffer->AllocateMemory(allocateFlags, MemoryUsage::DeviceLocal)));
+
+        debugUtilities.SetObjectName(buffer->GetHandle(), (name + std::string(" Buffer")).c_str());
+        debugUtilities.SetObjectName(memory->GetHandle(), (name + std::string(" Memory")).c_str());
+
+        uploadManager.UploadBuffer(*buffer, content.data(), contentSize);
+    }
 }
\ No newline at end of file
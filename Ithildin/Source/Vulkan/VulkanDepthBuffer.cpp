@@ -47,7 +47,7 @@ namespace Vulkan
         const VulkanDevice& device = commandPool.GetDevice();
 
         m_Image.reset(new VulkanImage(device, extent, m_Format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)); // Specifies that our image will be used as a depth stencil attachment.
-        m_ImageMemory.reset(new VulkanDeviceMemory(m_Image->AllocateMemory(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))); // Best for device (GPU) access. 
+        m_ImageMemory.reset(new VulkanDeviceMemory(m_Image->AllocateMemory(MemoryUsage::DeviceLocal))); // Best for device (GPU) access. 
         m_ImageView.reset(new VulkanImageView(device, m_Image->GetHandle(), m_Format, VK_IMAGE_ASPECT_DEPTH_BIT)); // We specify that the depth aspect of our image will be included in the view.
         
         m_Image->TransitionImageLayout(commandPool, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL); // Transition to a layout most efficient to be used as a depth stencil attachment.
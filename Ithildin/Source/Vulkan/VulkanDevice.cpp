@@ -2,6 +2,10 @@
 #include "VulkanSurface.h"
 #include "VulkanInstance.h"
 #include "VulkanUtilities.h"
+#include "VulkanDeviceMemory.h"
+#include "VulkanMemoryAllocator.h"
+#include <bitset>
+#include <stdexcept>
 #include <string>
 #include <iostream>
 #include <set>
@@ -28,8 +32,40 @@ namespace Vulkan
         }
     }
 
-    VulkanDevice::VulkanDevice(VkPhysicalDevice physicalDevice, const VulkanSurface& surface, const std::vector<const char*>& requiredExtensions, const VkPhysicalDeviceFeatures& deviceFeatures, const void* nextDeviceFeatures)
-                             : m_PhysicalDevice(physicalDevice), m_Surface(surface), m_DebugUtilities(surface.GetInstance().GetHandle())
+    namespace MemoryUtilities
+    {
+        struct MemoryPreference
+        {
+            VkMemoryPropertyFlags m_RequiredFlags;
+            VkMemoryPropertyFlags m_PreferredFlags;
+            VkMemoryPropertyFlags m_AvoidedFlags;
+        };
+
+        // Mapped memory is never flushed or invalidated, so host visible usages require coherent memory.
+        MemoryPreference GetMemoryPreference(MemoryUsage memoryUsage)
+        {
+            switch (memoryUsage)
+            {
+                case MemoryUsage::DeviceLocal:
+                    return { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT };
+
+                case MemoryUsage::HostToDevice:
+                    return { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT };
+
+                case MemoryUsage::Staging:
+                    return { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT };
+
+                case MemoryUsage::DeviceToHost:
+                    return { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 0 };
+            }
+
+            throw std::runtime_error("Unknown memory usage.");
+        }
+    }
+
+    VulkanDevice::VulkanDevice(VkPhysicalDevice physicalDevice, const VulkanInstance& instance, const VulkanSurface* surface, const std::vector<const char*>& requiredExtensions, 
+                               const VkPhysicalDeviceFeatures& deviceFeatures, const void* nextDeviceFeatures)
+                             : m_PhysicalDevice(physicalDevice), m_Surface(surface), m_DebugUtilities(instance.GetHandle())
     {
         QueryRequiredExtensions(physicalDevice, requiredExtensions);
 
@@ -38,14 +74,20 @@ namespace Vulkan
         // Find the graphics queue.
         const std::vector<VkQueueFamilyProperties>::const_iterator graphicsFamily = QueueUtilities::FindQueue(queueFamilies, "Graphics", VK_QUEUE_GRAPHICS_BIT, 0);
         const std::vector<VkQueueFamilyProperties>::const_iterator computeFamily  = QueueUtilities::FindQueue(queueFamilies, "Compute", VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT);
-        const std::vector<VkQueueFamilyProperties>::const_iterator transferFamily = QueueUtilities::FindQueue(queueFamilies, "Transfer", VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+        std::vector<VkQueueFamilyProperties>::const_iterator transferFamily = QueueUtilities::FindQueue(queueFamilies, "Transfer", VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
 
-        // Find the presentation queue (usually the same as the graphics queue).
-        const auto presentationFamily = std::find_if(queueFamilies.begin(), queueFamilies.end(), [&](const VkQueueFamilyProperties& queueFamily)
+        // Without a dedicated transfer family, uploads go through the graphics family, which always supports transfers.
+        if (transferFamily == queueFamilies.end())
+        {
+            transferFamily = graphicsFamily;
+        }
+
+        // Find the presentation queue (usually the same as the graphics queue). Without a surface nothing is presented, so the graphics queue stands in.
+        const auto presentationFamily = surface == nullptr ? graphicsFamily : std::find_if(queueFamilies.begin(), queueFamilies.end(), [&](const VkQueueFamilyProperties& queueFamily)
         {
             VkBool32 presentationSupport = false;
-            const uint32_t i = static_cast<uint32_t>(&*queueFamilies.cbegin() - &queueFamily);
-            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface.GetHandle(), &presentationSupport);
+            const uint32_t i = static_cast<uint32_t>(&queueFamily - &*queueFamilies.cbegin());
+            vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface->GetHandle(), &presentationSupport);
 
             return queueFamily.queueCount > 0 && presentationSupport;
         });
@@ -91,8 +133,8 @@ namespace Vulkan
         deviceCreationInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
         deviceCreationInfo.pQueueCreateInfos = queueCreateInfos.data();
         deviceCreationInfo.pEnabledFeatures = &deviceFeatures;
-        deviceCreationInfo.enabledLayerCount = static_cast<uint32_t>(surface.GetInstance().GetValidationLayers().size());
-        deviceCreationInfo.ppEnabledLayerNames = surface.GetInstance().GetValidationLayers().data();
+        deviceCreationInfo.enabledLayerCount = static_cast<uint32_t>(instance.GetValidationLayers().size());
+        deviceCreationInfo.ppEnabledLayerNames = instance.GetValidationLayers().data();
         deviceCreationInfo.enabledExtensionCount = static_cast<uint32_t>(requiredExtensions.size());
         deviceCreationInfo.ppEnabledExtensionNames = requiredExtensions.data();
 
@@ -104,10 +146,17 @@ namespace Vulkan
         vkGetDeviceQueue(m_Device, m_QueueComputeFamilyIndex, 0, &m_QueueCompute);
         vkGetDeviceQueue(m_Device, m_QueuePresentFamilyIndex, 0, &m_QueuePresent);
         vkGetDeviceQueue(m_Device, m_QueueTransferFamilyIndex, 0, &m_QueueTransfer);
+
+        // Memory types and heaps never change for a device, so they are only queried once.
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+
+        m_MemoryAllocator.reset(new VulkanMemoryAllocator(*this));
     }
 
     VulkanDevice::~VulkanDevice()
     {
+        m_MemoryAllocator.reset();
+
         if (m_Device != nullptr)
         {
             vkDestroyDevice(m_Device, nullptr);
@@ -121,6 +170,42 @@ namespace Vulkan
         CheckResult(vkDeviceWaitIdle(m_Device), "Waiting for Device Idle.\n");
     }
 
+    // https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkMemoryPropertyFlagBits.html
+    uint32_t VulkanDevice::FindMemoryType(uint32_t typeFilter, MemoryUsage memoryUsage) const
+    {
+        const MemoryUtilities::MemoryPreference preference = MemoryUtilities::GetMemoryPreference(memoryUsage);
+        const VkMemoryPropertyFlags excludedFlags = VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT | VK_MEMORY_PROPERTY_PROTECTED_BIT;
+
+        // Of the types that have every required flag, take the one with the most preferred and fewest avoided flags. Ties go to the lower index, as drivers list faster types first.
+        uint32_t bestType = UINT32_MAX;
+        int bestScore = 0;
+
+        for (uint32_t i = 0; i != m_MemoryProperties.memoryTypeCount; ++i)
+        {
+            const VkMemoryPropertyFlags propertyFlags = m_MemoryProperties.memoryTypes[i].propertyFlags;
+
+            if (!(typeFilter & (1 << i)) || (propertyFlags & preference.m_RequiredFlags) != preference.m_RequiredFlags || (propertyFlags & excludedFlags))
+            {
+                continue;
+            }
+
+            const int score = static_cast<int>(std::bitset<32>(propertyFlags & preference.m_PreferredFlags).count()) - static_cast<int>(std::bitset<32>(propertyFlags & preference.m_AvoidedFlags).count());
+
+            if (bestType == UINT32_MAX || score > bestScore)
+            {
+                bestType = i;
+                bestScore = score;
+            }
+        }
+
+        if (bestType == UINT32_MAX)
+        {
+            throw std::runtime_error("Failed to find suitable memory type.\n");
+        }
+
+        return bestType;
+    }
+
     void VulkanDevice::QueryRequiredExtensions(VkPhysicalDevice physicalDevice, const std::vector<const char*>& requiredExtensions) const
     {
         const std::vector<VkExtensionProperties> avaliableExtensions = GetEnumerateVector(physicalDevice, static_cast<const char*>(nullptr), vkEnumerateDeviceExtensionProperties, "Query Device Extensions");
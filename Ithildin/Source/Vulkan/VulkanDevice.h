@@ -1,22 +1,29 @@
 #pragma once
+#include <memory>
 #include <vector>
 #include "../Core/Core.h"
 #include "VulkanDebugUtilities.h"
 
 namespace Vulkan
 {
+    class VulkanInstance;
     class VulkanSurface;
+    class VulkanMemoryAllocator;
+    enum class MemoryUsage;
 
     class VulkanDevice final
     {
     public:
-        VulkanDevice(VkPhysicalDevice physicalDevice, const VulkanSurface& surface, const std::vector<const char*>& requiredExtensions,
+        VulkanDevice(VkPhysicalDevice physicalDevice, const VulkanInstance& instance, const VulkanSurface* surface, const std::vector<const char*>& requiredExtensions,
                      const VkPhysicalDeviceFeatures& deviceFeatures, const void* nextDeviceFeatures);
         ~VulkanDevice();
 
         VkPhysicalDevice GetPhysicalDevice() const { return m_PhysicalDevice; }
-        const VulkanSurface& GetSurface() const { return m_Surface; }
+        const VulkanSurface& GetSurface() const { return *m_Surface; }
+        bool HasSurface() const { return m_Surface != nullptr; }
         const VulkanDebugUtilities& GetDebugUtilities() const { return m_DebugUtilities; }
+        VulkanMemoryAllocator& GetMemoryAllocator() const { return *m_MemoryAllocator; }
+        const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const { return m_MemoryProperties; }
 
         uint32_t GetGraphicsQueueFamilyIndex() const { return m_QueueGraphicsFamilyIndex; }
         uint32_t GetComputeQueueFamilyIndex() const { return m_QueueComputeFamilyIndex; }
@@ -30,12 +37,15 @@ namespace Vulkan
 
         void WaitIdle() const;
 
+        // Picks the memory type allowed by typeFilter that best suits the usage. Throws if none of them can serve it at all.
+        uint32_t FindMemoryType(uint32_t typeFilter, MemoryUsage memoryUsage) const;
+
     private:
         void QueryRequiredExtensions(VkPhysicalDevice physicalDevice, const std::vector<const char*>& requiredExtensions) const;
 
     private:
         const VkPhysicalDevice m_PhysicalDevice;
-        const VulkanSurface& m_Surface;
+        const VulkanSurface* m_Surface; // Null when rendering headless.
 
         uint32_t m_QueueGraphicsFamilyIndex = 0;
         uint32_t m_QueueComputeFamilyIndex = 0;
@@ -47,7 +57,10 @@ namespace Vulkan
         VkQueue m_QueuePresent = nullptr;
         VkQueue m_QueueTransfer = nullptr;
 
+        VkPhysicalDeviceMemoryProperties m_MemoryProperties = {};
+
         VulkanDebugUtilities m_DebugUtilities;
+        std::unique_ptr<VulkanMemoryAllocator> m_MemoryAllocator;
         VULKAN_HANDLE(VkDevice, m_Device)
     };
 }
\ No newline at end of file
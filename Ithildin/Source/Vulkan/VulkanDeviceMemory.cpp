@@ -4,67 +4,49 @@
 
 namespace Vulkan
 {
-    VulkanDeviceMemory::VulkanDeviceMemory(const VulkanDevice& device, size_t size, uint32_t memoryTypeBits, VkMemoryAllocateFlags allocationFlags, VkMemoryPropertyFlags propertyFlags)
+    VulkanDeviceMemory::VulkanDeviceMemory(const VulkanDevice& device, const VkMemoryRequirements& memoryRequirements, VkMemoryAllocateFlags allocationFlags, MemoryUsage memoryUsage, VkDeviceSize minimumAlignment)
                                          : m_Device(device)
     {
-        // Contains flags controlling how many instances of the memory will be allocated: https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkMemoryAllocateFlagBits.html
-        VkMemoryAllocateFlagsInfo flagsInfoDescription = {};
-        flagsInfoDescription.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
-        flagsInfoDescription.pNext = nullptr;
-        flagsInfoDescription.flags = allocationFlags;
-
-        VkMemoryAllocateInfo allocationInfoDescription = {};
-        allocationInfoDescription.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocationInfoDescription.pNext = &flagsInfoDescription;
-        allocationInfoDescription.allocationSize = size;
-        allocationInfoDescription.memoryTypeIndex = FindMemoryType(memoryTypeBits, propertyFlags);
-
-        CheckResult(vkAllocateMemory(m_Device.GetHandle(), &allocationInfoDescription, nullptr, &m_Memory), "Memory Allocation");
+        // Allocation flags control how many instances of the memory will be allocated: https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkMemoryAllocateFlagBits.html
+        // Memory with different flags can't share a block, so they are part of the pool key along with the memory type.
+        const uint32_t memoryTypeIndex = m_Device.FindMemoryType(memoryRequirements.memoryTypeBits, memoryUsage);
+        m_Allocation = m_Device.GetMemoryAllocator().Allocate(memoryRequirements, memoryTypeIndex, allocationFlags, minimumAlignment);
     }
 
     VulkanDeviceMemory::VulkanDeviceMemory(VulkanDeviceMemory&& otherMemory) noexcept 
-                                          : m_Device(otherMemory.m_Device), m_Memory(otherMemory.m_Memory)
+                                          : m_Device(otherMemory.m_Device), m_Allocation(otherMemory.m_Allocation)
     {
-        otherMemory.m_Memory = nullptr;
+        otherMemory.m_Allocation.m_Memory = nullptr;
     }
 
     VulkanDeviceMemory::~VulkanDeviceMemory()
     {
-        if (m_Memory != nullptr)
+        if (m_Allocation.m_Memory != nullptr)
         {
-            vkFreeMemory(m_Device.GetHandle(), m_Memory, nullptr);
-            m_Memory = nullptr;
+            m_Device.GetMemoryAllocator().Free(m_Allocation);
+            m_Allocation.m_Memory = nullptr;
         }
     }
 
     void* VulkanDeviceMemory::Map(size_t offset, size_t size)
     {
         // We must guarantee that the any previously submitted commands that writes to the incoming mapped range has completed before the host reads from or writes again to that range.
-        void* data;
-        CheckResult(vkMapMemory(m_Device.GetHandle(), m_Memory, offset, size, 0, &data), "Map Memory"); // Maps a CPU (host) pointer to GPU (device) memory.
+        // Host visible blocks are mapped once by the allocator, so this only offsets into the block's mapping.
+        if (m_Allocation.m_MappedData == nullptr)
+        {
+            throw std::runtime_error("Failed to map memory that is not host visible.");
+        }
 
-        return data;
-    }
+        if (offset + size > m_Allocation.m_Size)
+        {
+            throw std::runtime_error("Mapped range exceeds the memory allocation.");
+        }
 
-    void VulkanDeviceMemory::Unmap()
-    {
-        vkUnmapMemory(m_Device.GetHandle(), m_Memory);
+        return static_cast<uint8_t*>(m_Allocation.m_MappedData) + offset;
     }
 
-    // https://www.khronos.org/registry/vulkan/specs/1.2-extensions/man/html/VkMemoryPropertyFlagBits.html
-    uint32_t VulkanDeviceMemory::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags propertyFlags) const 
+    void VulkanDeviceMemory::Unmap()
     {
-        VkPhysicalDeviceMemoryProperties memoryProperties; 
-        vkGetPhysicalDeviceMemoryProperties(m_Device.GetPhysicalDevice(), &memoryProperties);
-
-        for (uint32_t i = 0; i != memoryProperties.memoryTypeCount; ++i)
-        {
-            if ((typeFilter & (1 << i)) && (memoryProperties.memoryTypes[i].propertyFlags & propertyFlags) == propertyFlags)
-            {
-                return i;
-            }
-        }
-
-        std::runtime_error("Failed to find suitable memory type.\n");
+        // Nothing to do, the block stays mapped until it is freed.
     }
 }
\ No newline at end of file
@@ -1,27 +1,37 @@
 #pragma once
 #include "../Core/Core.h"
+#include "VulkanMemoryAllocator.h"
 
 namespace Vulkan
 {
     class VulkanDevice;
 
+    // What an allocation is used for, from which the device picks the best memory type the hardware offers.
+    enum class MemoryUsage
+    {
+        DeviceLocal,  // Only accessed by the GPU, such as geometry, textures and acceleration structures.
+        HostToDevice, // Written by the host and read by the GPU, often every frame. Prefers device local host visible memory (resizable BAR).
+        Staging,      // Written by the host once as a transfer source. Avoids device local memory to leave it to the other usages.
+        DeviceToHost  // Written by the GPU and read back by the host. Prefers host cached memory.
+    };
+
+    // A range of device memory sub-allocated from the device's memory allocator. The handle is the block shared with other resources, so bind at GetOffset().
     class VulkanDeviceMemory final
     {
     public:
-        VulkanDeviceMemory(const VulkanDevice& device, size_t size, uint32_t memoryTypeBits, VkMemoryAllocateFlags allocationFlags, VkMemoryPropertyFlags propertyFlags);
+        VulkanDeviceMemory(const VulkanDevice& device, const VkMemoryRequirements& memoryRequirements, VkMemoryAllocateFlags allocationFlags, MemoryUsage memoryUsage, VkDeviceSize minimumAlignment);
         VulkanDeviceMemory(VulkanDeviceMemory&& otherMemory) noexcept; // Terminate if an exception is thrown at runtime.
         ~VulkanDeviceMemory();
 
         const VulkanDevice& GetDevice() const { return m_Device; }
+        VkDeviceMemory GetHandle() const { return m_Allocation.m_Memory; }
+        VkDeviceSize GetOffset() const { return m_Allocation.m_Offset; }
 
         void* Map(size_t offset, size_t size);
         void Unmap();
 
-    private:
-        uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags propertyFlags) const;
-
     private:
         const VulkanDevice& m_Device;
-        VULKAN_HANDLE(VkDeviceMemory, m_Memory)
+        VulkanMemoryAllocator::Allocation m_Allocation;
     };
 }
\ No newline at end of file
@@ -15,18 +15,18 @@
 
 namespace Vulkan
 {
-    VulkanGraphicsPipeline::VulkanGraphicsPipeline(const VulkanSwapChain& swapChain, const VulkanDepthBuffer& depthBuffer, const std::vector<Resources::UniformBuffer>& uniformBuffers, const Resources::Scene& scene, bool isWireFrame)
+    VulkanGraphicsPipeline::VulkanGraphicsPipeline(const VulkanSwapChain& swapChain, const VulkanDepthBuffer& depthBuffer, const Resources::UniformBuffer& uniformBuffer, const Resources::Scene& scene, bool isWireFrame)
         : m_SwapChain(swapChain), m_IsWireFrame(isWireFrame)
     {
         const VulkanDevice& device = swapChain.GetDevice();
-        const VkVertexInputBindingDescription bindingDescription = Resources::Vertex::GetBindingDescription();
-        const std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions = Resources::Vertex::GetAttributeDescriptions();
+        const std::array<VkVertexInputBindingDescription, 3> bindingDescriptions = Resources::Vertex::GetBindingDescriptions();
+        const std::array<VkVertexInputAttributeDescription, 9> attributeDescriptions = Resources::Vertex::GetAttributeDescriptions();
         
         // Our vertex format data.
         VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertexInputInfo.vertexBindingDescriptionCount = 1;
-        vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+        vertexInputInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size());
+        vertexInputInfo.pVertexBindingDescriptions = bindingDescriptions.data();
         vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
         vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 
@@ -117,7 +117,7 @@ namespace Vulkan
             { 2, static_cast<uint32_t>(scene.GetTextureSamplers().size()), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT }
         };
 
-        m_DescriptorSetManager.reset(new VulkanDescriptorSetManager(device, descriptorBindings, uniformBuffers.size()));
+        m_DescriptorSetManager.reset(new VulkanDescriptorSetManager(device, descriptorBindings, uniformBuffer.GetSlotCount()));
 
         VulkanDescriptorSets& descriptorSets = m_DescriptorSetManager->GetDescriptorSets();
 
@@ -125,8 +125,9 @@ namespace Vulkan
         {
             // Uniform Buffer
             VkDescriptorBufferInfo uniformBufferInfo = {};
-            uniformBufferInfo.buffer = uniformBuffers[i].GetBuffer().GetHandle();
-            uniformBufferInfo.range = VK_WHOLE_SIZE;
+            uniformBufferInfo.buffer = uniformBuffer.GetBuffer().GetHandle();
+            uniformBufferInfo.offset = uniformBuffer.GetSlotOffset(i);
+            uniformBufferInfo.range = uniformBuffer.GetSlotSize();
 
             // Material Buffer
             VkDescriptorBufferInfo materialBufferInfo = {};
@@ -21,7 +21,7 @@ namespace Vulkan
     {
     public:
         VulkanGraphicsPipeline(const VulkanSwapChain& swapChain, const VulkanDepthBuffer& depthBuffer,
-                               const std::vector<Resources::UniformBuffer>& uniformBuffers, const Resources::Scene& scene, bool isWireFrame);
+                               const Resources::UniformBuffer& uniformBuffer, const Resources::Scene& scene, bool isWireFrame);
         ~VulkanGraphicsPipeline();
 
         VkDescriptorSet GetDescriptorSet(uint32_t index) const;
@@ -49,12 +49,12 @@ namespace Vulkan
         }
     }
 
-    VulkanDeviceMemory VulkanImage::AllocateMemory(VkMemoryPropertyFlags propertyFlags) const
+    VulkanDeviceMemory VulkanImage::AllocateMemory(MemoryUsage memoryUsage) const
     {
         const VkMemoryRequirements memoryRequirements = GetMemoryRequirements();
-        VulkanDeviceMemory memory(m_Device, memoryRequirements.size, memoryRequirements.memoryTypeBits, 0, propertyFlags);
+        VulkanDeviceMemory memory(m_Device, memoryRequirements, 0, memoryUsage, 1);
 
-        CheckResult(vkBindImageMemory(m_Device.GetHandle(), m_Image, memory.GetHandle(), 0), "Bind Memory to Image");
+        CheckResult(vkBindImageMemory(m_Device.GetHandle(), m_Image, memory.GetHandle(), memory.GetOffset()), "Bind Memory to Image");
 
         return memory;
     }
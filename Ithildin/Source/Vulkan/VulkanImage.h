@@ -20,11 +20,12 @@ namespace Vulkan
         VkExtent2D GetExtent() const { return m_Extent; }
         VkFormat GetFormat() const { return m_Format; }
 
-        VulkanDeviceMemory AllocateMemory(VkMemoryPropertyFlags propertyFlags) const;
+        VulkanDeviceMemory AllocateMemory(MemoryUsage memoryUsage) const;
         VkMemoryRequirements GetMemoryRequirements() const;
 
         void TransitionImageLayout(VulkanCommandPool& commandPool, VkImageLayout newLayout);
         void CopyFrom(VulkanCommandPool& commandPool, const VulkanBuffer& buffer);
+        void SetImageLayout(VkImageLayout imageLayout) { m_ImageLayout = imageLayout; } // For transitions recorded elsewhere, such as by the upload manager.
 
     private:
         const VulkanDevice& m_Device;
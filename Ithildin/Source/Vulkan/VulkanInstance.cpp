@@ -4,14 +4,14 @@
 
 namespace Vulkan
 {
-    VulkanInstance::VulkanInstance(const Window& window, const std::vector<const char*>& validationLayers, uint32_t vulkanVersion) 
+    VulkanInstance::VulkanInstance(const Window* window, const std::vector<const char*>& validationLayers, uint32_t vulkanVersion) 
         : m_Window(window), m_ValidationLayers(validationLayers)
     {
         // Check minimum version.
         QueryVulkanMinimumVersion(vulkanVersion);
 
-        // Get the list of required extensions.
-        std::vector<const char*> extensions = window.GetRequiredInstanceExtensions();
+        // Get the list of required extensions. Without a window, nothing is presented and no surface extensions are needed.
+        std::vector<const char*> extensions = window != nullptr ? window->GetRequiredInstanceExtensions() : std::vector<const char*>();
 
         // Check the validation layers and ensure they are suported.
         QueryVulkanValidationLayerSupport(validationLayers);
@@ -9,10 +9,10 @@ namespace Vulkan
     class VulkanInstance final
     {
     public:
-        VulkanInstance(const Window& window, const std::vector<const char*>& validationLayers, uint32_t vulkanVersion);
+        VulkanInstance(const Window* window, const std::vector<const char*>& validationLayers, uint32_t vulkanVersion);
         ~VulkanInstance();
 
-        const Window& GetWindow() const { return m_Window; }
+        const Window& GetWindow() const { return *m_Window; }
 
         const std::vector<const char*>& GetValidationLayers() const { return m_ValidationLayers; }
         const std::vector<VkExtensionProperties>& GetExtensions() const { return m_Extensions; }
@@ -33,7 +33,7 @@ namespace Vulkan
         std::vector<VkLayerProperties> m_Layers;
         std::vector<VkPhysicalDevice> m_PhysicalDevices;
 
-        const Window& m_Window;
+        const Window* m_Window; // Null when headless.
         VULKAN_HANDLE(VkInstance, m_Instance)
     };
 }
\ No newline at end of file
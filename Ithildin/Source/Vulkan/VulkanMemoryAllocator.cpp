@@ -0,0 +1,238 @@
+#include "VulkanMemoryAllocator.h"
+#include "VulkanDevice.h"
+#include <algorithm>
+#include <string>
+
+namespace Vulkan
+{
+    namespace AllocatorUtilities
+    {
+        // Resources larger than half a block get a block of their own, rather than leaving most of a shared block unusable.
+        const VkDeviceSize BlockSize = 64 * 1024 * 1024;
+
+        VkDeviceSize RoundUp(VkDeviceSize size, VkDeviceSize granularity)
+        {
+            return ((size + granularity - 1) / granularity) * granularity;
+        }
+    }
+
+    struct VulkanMemoryAllocator::Block
+    {
+        VkDeviceMemory m_Memory = nullptr;
+        VkDeviceSize m_Size = 0;
+        void* m_MappedData = nullptr;
+        std::map<VkDeviceSize, VkDeviceSize> m_FreeRanges; // Offset to size.
+        uint32_t m_AllocationCount = 0;
+        bool m_IsDedicated = false;
+    };
+
+    VulkanMemoryAllocator::VulkanMemoryAllocator(const VulkanDevice& device) : m_Device(device)
+    {
+        // Linear and optimally tiled resources must not share a page of this size, so every allocation is rounded up to it.
+        VkPhysicalDeviceProperties deviceProperties;
+        vkGetPhysicalDeviceProperties(device.GetPhysicalDevice(), &deviceProperties);
+        m_BufferImageGranularity = std::max<VkDeviceSize>(1, deviceProperties.limits.bufferImageGranularity);
+    }
+
+    VulkanMemoryAllocator::~VulkanMemoryAllocator()
+    {
+        for (auto& [key, blocks] : m_Pools)
+        {
+            for (std::unique_ptr<Block>& block : blocks)
+            {
+                DestroyBlock(*block);
+            }
+        }
+
+        m_Pools.clear();
+    }
+
+    VulkanMemoryAllocator::Allocation VulkanMemoryAllocator::Allocate(const VkMemoryRequirements& memoryRequirements, uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocationFlags, VkDeviceSize minimumAlignment)
+    {
+        const std::lock_guard<std::mutex> lock(m_Mutex);
+
+        const VkDeviceSize alignment = std::max({ memoryRequirements.alignment, m_BufferImageGranularity, minimumAlignment });
+        const VkDeviceSize size = AllocatorUtilities::RoundUp(memoryRequirements.size, m_BufferImageGranularity);
+
+        Allocation allocation = {};
+        allocation.m_Size = size;
+        allocation.m_MemoryTypeIndex = memoryTypeIndex;
+        allocation.m_AllocationFlags = allocationFlags;
+
+        std::vector<std::unique_ptr<Block>>& blocks = m_Pools[{ memoryTypeIndex, allocationFlags }];
+
+        // First fit over the free ranges of the existing blocks.
+        for (const std::unique_ptr<Block>& block : blocks)
+        {
+            if (block->m_IsDedicated)
+            {
+                continue;
+            }
+
+            for (auto range = block->m_FreeRanges.begin(); range != block->m_FreeRanges.end(); ++range)
+            {
+                const VkDeviceSize rangeBegin = range->first;
+                const VkDeviceSize rangeEnd = range->first + range->second;
+                const VkDeviceSize offset = AllocatorUtilities::RoundUp(rangeBegin, alignment);
+
+                if (offset + size > rangeEnd)
+                {
+                    continue;
+                }
+
+                // Split the range around the allocation.
+                block->m_FreeRanges.erase(range);
+
+                if (offset != rangeBegin)
+                {
+                    block->m_FreeRanges.emplace(rangeBegin, offset - rangeBegin);
+                }
+
+                if (offset + size != rangeEnd)
+                {
+                    block->m_FreeRanges.emplace(offset + size, rangeEnd - (offset + size));
+                }
+
+                allocation.m_Block = block.get();
+                allocation.m_Offset = offset;
+                break;
+            }
+
+            if (allocation.m_Block != nullptr)
+            {
+                break;
+            }
+        }
+
+        // Otherwise start a new block.
+        if (allocation.m_Block == nullptr)
+        {
+            const bool isDedicated = size > AllocatorUtilities::BlockSize / 2;
+            Block* const block = CreateBlock(isDedicated ? size : AllocatorUtilities::BlockSize, memoryTypeIndex, allocationFlags, isDedicated);
+
+            block->m_FreeRanges.clear();
+
+            if (size != block->m_Size)
+            {
+                block->m_FreeRanges.emplace(size, block->m_Size - size);
+            }
+
+            allocation.m_Block = block;
+            allocation.m_Offset = 0;
+        }
+
+        Block& block = *allocation.m_Block;
+        block.m_AllocationCount++;
+
+        allocation.m_Memory = block.m_Memory;
+        allocation.m_MappedData = block.m_MappedData != nullptr ? static_cast<uint8_t*>(block.m_MappedData) + allocation.m_Offset : nullptr;
+
+        m_Statistics.m_AllocationCount++;
+        m_Statistics.m_UsedSize += size;
+
+        return allocation;
+    }
+
+    void VulkanMemoryAllocator::Free(const Allocation& allocation)
+    {
+        const std::lock_guard<std::mutex> lock(m_Mutex);
+
+        Block& block = *allocation.m_Block;
+        block.m_AllocationCount--;
+
+        m_Statistics.m_AllocationCount--;
+        m_Statistics.m_UsedSize -= allocation.m_Size;
+
+        // Give empty blocks back to the driver.
+        if (block.m_AllocationCount == 0)
+        {
+            std::vector<std::unique_ptr<Block>>& blocks = m_Pools[{ allocation.m_MemoryTypeIndex, allocation.m_AllocationFlags }];
+            const auto blockIterator = std::find_if(blocks.begin(), blocks.end(), [&block](const std::unique_ptr<Block>& pooledBlock) { return pooledBlock.get() == &block; });
+
+            DestroyBlock(block);
+            blocks.erase(blockIterator);
+            return;
+        }
+
+        // Return the range and merge it with its free neighbours.
+        VkDeviceSize offset = allocation.m_Offset;
+        VkDeviceSize size = allocation.m_Size;
+
+        const auto next = block.m_FreeRanges.lower_bound(offset);
+
+        if (next != block.m_FreeRanges.end() && offset + size == next->first)
+        {
+            size += next->second;
+            block.m_FreeRanges.erase(next);
+        }
+
+        auto previous = block.m_FreeRanges.lower_bound(offset);
+
+        if (previous != block.m_FreeRanges.begin() && (--previous)->first + previous->second == offset)
+        {
+            offset = previous->first;
+            size += previous->second;
+            block.m_FreeRanges.erase(previous);
+        }
+
+        block.m_FreeRanges.emplace(offset, size);
+    }
+
+    VulkanMemoryAllocator::Statistics VulkanMemoryAllocator::GetStatistics() const
+    {
+        const std::lock_guard<std::mutex> lock(m_Mutex);
+
+        return m_Statistics;
+    }
+
+    VulkanMemoryAllocator::Block* VulkanMemoryAllocator::CreateBlock(VkDeviceSize size, uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocationFlags, bool isDedicated)
+    {
+        VkMemoryAllocateFlagsInfo flagsInfoDescription = {};
+        flagsInfoDescription.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+        flagsInfoDescription.flags = allocationFlags;
+
+        VkMemoryAllocateInfo allocationInfoDescription = {};
+        allocationInfoDescription.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocationInfoDescription.pNext = &flagsInfoDescription;
+        allocationInfoDescription.allocationSize = size;
+        allocationInfoDescription.memoryTypeIndex = memoryTypeIndex;
+
+        std::unique_ptr<Block> block(new Block());
+        block->m_Size = size;
+        block->m_IsDedicated = isDedicated;
+        block->m_FreeRanges.emplace(0, size);
+
+        CheckResult(vkAllocateMemory(m_Device.GetHandle(), &allocationInfoDescription, nullptr, &block->m_Memory), "Memory Block Allocation");
+
+        if (m_Device.GetMemoryProperties().memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            CheckResult(vkMapMemory(m_Device.GetHandle(), block->m_Memory, 0, VK_WHOLE_SIZE, 0, &block->m_MappedData), "Map Memory Block");
+        }
+
+        const std::string name = (isDedicated ? "Dedicated Memory Block (Type " : "Memory Block (Type ") + std::to_string(memoryTypeIndex) + ")";
+        m_Device.GetDebugUtilities().SetObjectName(block->m_Memory, name.c_str());
+
+        m_Statistics.m_BlockCount++;
+        m_Statistics.m_BlockSize += size;
+
+        std::vector<std::unique_ptr<Block>>& blocks = m_Pools[{ memoryTypeIndex, allocationFlags }];
+        blocks.push_back(std::move(block));
+
+        return blocks.back().get();
+    }
+
+    void VulkanMemoryAllocator::DestroyBlock(Block& block)
+    {
+        if (block.m_MappedData != nullptr)
+        {
+            vkUnmapMemory(m_Device.GetHandle(), block.m_Memory);
+            block.m_MappedData = nullptr;
+        }
+
+        vkFreeMemory(m_Device.GetHandle(), block.m_Memory, nullptr);
+        block.m_Memory = nullptr;
+
+        m_Statistics.m_BlockCount--;
+        m_Statistics.m_BlockSize -= block.m_Size;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+#include "../Core/Core.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Vulkan
+{
+    class VulkanDevice;
+
+    // Sub-allocates buffer and image memory from large blocks, so that a scene needs a handful of vkAllocateMemory calls rather than one per resource.
+    // Blocks are pooled per memory type and allocation flags, and keep a free list of ranges that merge again as allocations are released.
+    // Host visible blocks stay mapped for their whole lifetime, as a memory object can only be mapped once at a time.
+    class VulkanMemoryAllocator final
+    {
+    public:
+        struct Block;
+
+        struct Allocation
+        {
+            VkDeviceMemory m_Memory = nullptr; // Shared with every other allocation in the block.
+            VkDeviceSize m_Offset = 0;
+            VkDeviceSize m_Size = 0;
+            void* m_MappedData = nullptr;      // Start of the allocation, if the memory is host visible.
+            uint32_t m_MemoryTypeIndex = 0;
+            VkMemoryAllocateFlags m_AllocationFlags = 0;
+            Block* m_Block = nullptr;
+        };
+
+        struct Statistics
+        {
+            uint32_t m_BlockCount = 0;
+            uint32_t m_AllocationCount = 0;
+            VkDeviceSize m_BlockSize = 0; // Bytes allocated from the driver.
+            VkDeviceSize m_UsedSize = 0;  // Bytes handed out to buffers and images.
+        };
+
+        explicit VulkanMemoryAllocator(const VulkanDevice& device);
+        ~VulkanMemoryAllocator();
+
+        // The minimum alignment applies on top of the memory requirements, for offsets the driver checks beyond binding, such as acceleration structure scratch addresses.
+        Allocation Allocate(const VkMemoryRequirements& memoryRequirements, uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocationFlags, VkDeviceSize minimumAlignment);
+        void Free(const Allocation& allocation);
+
+        Statistics GetStatistics() const;
+
+    private:
+        Block* CreateBlock(VkDeviceSize size, uint32_t memoryTypeIndex, VkMemoryAllocateFlags allocationFlags, bool isDedicated);
+        void DestroyBlock(Block& block);
+
+    private:
+        const VulkanDevice& m_Device;
+        VkDeviceSize m_BufferImageGranularity = 1;
+
+        mutable std::mutex m_Mutex;
+        std::map<std::pair<uint32_t, VkMemoryAllocateFlags>, std::vector<std::unique_ptr<Block>>> m_Pools;
+        Statistics m_Statistics = {};
+    };
+}
\ No newline at end of file
@@ -18,8 +18,8 @@ namespace Vulkan
         colorAttachmentInfo.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachmentInfo.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         // Set as undefined if our load operation is a buffer clear since its existing contents don't matter due to the clear.
-        colorAttachmentInfo.initialLayout = colorBufferLoadOperation == VK_ATTACHMENT_LOAD_OP_CLEAR ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-        colorAttachmentInfo.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // Set to presentation layout.
+        colorAttachmentInfo.initialLayout = colorBufferLoadOperation == VK_ATTACHMENT_LOAD_OP_CLEAR ? VK_IMAGE_LAYOUT_UNDEFINED : swapChain.GetPresentLayout();
+        colorAttachmentInfo.finalLayout = swapChain.GetPresentLayout(); // Set to presentation layout.
 
         VkAttachmentDescription depthAttachmentInfo = {};
         depthAttachmentInfo.format = depthBuffer.GetFormat();
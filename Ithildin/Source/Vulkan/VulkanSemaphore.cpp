@@ -11,6 +11,21 @@ namespace Vulkan
         CheckResult(vkCreateSemaphore(m_Device.GetHandle(), &semaphoreInfo, nullptr, &m_Semaphore), "Semaphore Creation");
     }
 
+    VulkanSemaphore::VulkanSemaphore(const VulkanDevice& device, uint64_t initialValue) : m_Device(device)
+    {
+        // Unlike binary semaphores, a timeline semaphore holds a counter that submissions signal to increasing values and the host can wait on.
+        VkSemaphoreTypeCreateInfo semaphoreTypeInfo = {};
+        semaphoreTypeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+        semaphoreTypeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+        semaphoreTypeInfo.initialValue = initialValue;
+
+        VkSemaphoreCreateInfo semaphoreInfo = {};
+        semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+        semaphoreInfo.pNext = &semaphoreTypeInfo;
+
+        CheckResult(vkCreateSemaphore(m_Device.GetHandle(), &semaphoreInfo, nullptr, &m_Semaphore), "Timeline Semaphore Creation");
+    }
+
     VulkanSemaphore::VulkanSemaphore(VulkanSemaphore&& otherSemaphore) noexcept : m_Device(otherSemaphore.m_Device), m_Semaphore(otherSemaphore.m_Semaphore)
     {
         otherSemaphore.m_Semaphore = nullptr;
@@ -24,4 +39,15 @@ namespace Vulkan
             m_Semaphore = nullptr;
         }
     }
+
+    void VulkanSemaphore::Wait(uint64_t value, uint64_t timeout) const
+    {
+        VkSemaphoreWaitInfo waitInfo = {};
+        waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+        waitInfo.semaphoreCount = 1;
+        waitInfo.pSemaphores = &m_Semaphore;
+        waitInfo.pValues = &value;
+
+        CheckResult(vkWaitSemaphores(m_Device.GetHandle(), &waitInfo, timeout), "Wait For Semaphore");
+    }
 }
\ No newline at end of file
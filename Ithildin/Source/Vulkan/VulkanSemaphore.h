@@ -9,11 +9,14 @@ namespace Vulkan
     {
     public:
         explicit VulkanSemaphore(const VulkanDevice& device);
+        VulkanSemaphore(const VulkanDevice& device, uint64_t initialValue); // Timeline semaphore. Requires the timelineSemaphore device feature.
         VulkanSemaphore(VulkanSemaphore&& otherSemaphore) noexcept;
         ~VulkanSemaphore();
 
         const VulkanDevice& GetDevice() const { return m_Device; }
 
+        void Wait(uint64_t value, uint64_t timeout) const; // Timeline semaphores only. Blocks until the counter reaches value.
+
     private:
         const VulkanDevice& m_Device;
         VULKAN_HANDLE(VkSemaphore, m_Semaphore)
@@ -4,6 +4,7 @@
 #include "VulkanInstance.h"
 #include "VulkanUtilities.h"
 #include "VulkanDebugUtilities.h"
+#include "VulkanImage.h"
 #include "VulkanImageView.h"
 #include "../Core/Window.h"
 #include <stdexcept>
@@ -80,9 +81,32 @@ namespace Vulkan
         }
     }
 
+    VulkanSwapChain::VulkanSwapChain(const VulkanDevice& device, VkExtent2D offscreenExtent)
+        : m_PhysicalDevice(device.GetPhysicalDevice()), m_Device(device)
+    {
+        // Same format as a windowed swapchain, so that pipelines and render passes are created the same way.
+        m_SwapChain = nullptr;
+        m_MinimumImageCount = 1;
+        m_PresentationMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+        m_Format = VK_FORMAT_B8G8R8A8_UNORM;
+        m_Extent = offscreenExtent;
+
+        m_OffscreenImage.reset(new VulkanImage(device, m_Extent, m_Format, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT));
+        m_OffscreenImageMemory.reset(new VulkanDeviceMemory(m_OffscreenImage->AllocateMemory(MemoryUsage::DeviceLocal)));
+
+        m_Images.push_back(m_OffscreenImage->GetHandle());
+        m_ImageViews.push_back(std::make_unique<VulkanImageView>(device, m_Images[0], m_Format, VK_IMAGE_ASPECT_COLOR_BIT));
+
+        const VulkanDebugUtilities& debugUtilities = device.GetDebugUtilities();
+        debugUtilities.SetObjectName(m_Images[0], "Offscreen Image");
+        debugUtilities.SetObjectName(m_ImageViews[0]->GetHandle(), "Offscreen Image View");
+    }
+
     VulkanSwapChain::~VulkanSwapChain()
     {
         m_ImageViews.clear();
+        m_OffscreenImage.reset();
+        m_OffscreenImageMemory.reset(); // Release memory after bound image has been destroyed.
 
         // Images are destroyed alongside the swapchain.
         if (m_SwapChain != nullptr)
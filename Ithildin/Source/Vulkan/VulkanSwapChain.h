@@ -6,6 +6,8 @@
 namespace Vulkan
 {
     class VulkanDevice;
+    class VulkanDeviceMemory;
+    class VulkanImage;
     class VulkanImageView;
     class Window;
 
@@ -20,6 +22,7 @@ namespace Vulkan
     {
     public:
         VulkanSwapChain(const VulkanDevice& device, VkPresentModeKHR requestedPresentationMode);
+        VulkanSwapChain(const VulkanDevice& device, VkExtent2D offscreenExtent); // A single offscreen image that is never presented, for headless rendering.
         ~VulkanSwapChain();
 
         VkPhysicalDevice GetPhysicalDevice() const { return m_PhysicalDevice; }
@@ -30,6 +33,10 @@ namespace Vulkan
         const VkExtent2D& GetExtent() const { return m_Extent; }
         VkFormat GetFormat() const { return m_Format; }
         VkPresentModeKHR GetPresentationMode() const { return m_PresentationMode; }
+        bool IsOffscreen() const { return m_SwapChain == nullptr; }
+
+        // The layout images are left in at the end of a frame: ready to present, or to be copied from when offscreen.
+        VkImageLayout GetPresentLayout() const { return IsOffscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; }
 
     private:
         static SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface);
@@ -45,6 +52,8 @@ namespace Vulkan
         VkExtent2D m_Extent;
         std::vector<VkImage> m_Images;
         std::vector<std::unique_ptr<VulkanImageView>> m_ImageViews;
+        std::unique_ptr<VulkanImage> m_OffscreenImage;
+        std::unique_ptr<VulkanDeviceMemory> m_OffscreenImageMemory;
 
         const VkPhysicalDevice m_PhysicalDevice;
         const VulkanDevice& m_Device;
@@ -0,0 +1,316 @@
+#include "VulkanUploadManager.h"
+#include "VulkanDevice.h"
+#include "VulkanBuffer.h"
+#include "VulkanImage.h"
+#include "VulkanDeviceMemory.h"
+#include "VulkanCommandPool.h"
+#include "VulkanCommandBuffers.h"
+#include "VulkanSemaphore.h"
+#include "VulkanDebugUtilities.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace Vulkan
+{
+    namespace UploadUtilities
+    {
+        // Keeps every staging allocation aligned for buffer copies and for image copies of any texel size.
+        const VkDeviceSize StagingAlignment = 16;
+
+        VkDeviceSize RoundUp(VkDeviceSize size, VkDeviceSize granularity)
+        {
+            return ((size + granularity - 1) / granularity) * granularity;
+        }
+    }
+
+    VulkanUploadManager::VulkanUploadManager(const VulkanDevice& device, VkDeviceSize stagingSize) : m_Device(device), m_StagingSize(stagingSize)
+    {
+        m_TransferCommandPool.reset(new VulkanCommandPool(device, device.GetTransferQueueFamilyIndex(), false));
+        m_GraphicsCommandPool.reset(new VulkanCommandPool(device, device.GetGraphicsQueueFamilyIndex(), false));
+
+        m_StagingBuffer.reset(new VulkanBuffer(device, stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT));
+        m_StagingBufferMemory.reset(new VulkanDeviceMemory(m_StagingBuffer->AllocateMemory(MemoryUsage::Staging)));
+        m_StagingData = static_cast<uint8_t*>(m_StagingBufferMemory->Map(0, stagingSize)); // Stays mapped for the lifetime of the manager.
+
+        m_TimelineSemaphore.reset(new VulkanSemaphore(device, m_TimelineValue));
+
+        const VulkanDebugUtilities& debugUtilities = device.GetDebugUtilities();
+
+        debugUtilities.SetObjectName(m_StagingBuffer->GetHandle(), "Upload Staging Buffer");
+        debugUtilities.SetObjectName(m_StagingBufferMemory->GetHandle(), "Upload Staging Memory");
+        debugUtilities.SetObjectName(m_TimelineSemaphore->GetHandle(), "Upload Timeline Semaphore");
+    }
+
+    VulkanUploadManager::~VulkanUploadManager()
+    {
+        Wait();
+
+        m_TimelineSemaphore.reset();
+        m_StagingBufferMemory->Unmap();
+        m_StagingBuffer.reset();
+        m_StagingBufferMemory.reset(); // Release memory after the bound buffer has been destroyed.
+        m_GraphicsCommandPool.reset();
+        m_TransferCommandPool.reset();
+    }
+
+    void VulkanUploadManager::UploadBuffer(VulkanBuffer& destinationBuffer, const void* data, VkDeviceSize size)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+        // Uploads larger than the staging ring are split into several copies.
+        for (VkDeviceSize copiedSize = 0; copiedSize < size;)
+        {
+            const VkDeviceSize copySize = std::min(size - copiedSize, m_StagingSize);
+
+            VkBufferCopy copyRegion = {};
+            copyRegion.srcOffset = AllocateStaging(bytes + copiedSize, copySize);
+            copyRegion.dstOffset = copiedSize;
+            copyRegion.size = copySize;
+
+            vkCmdCopyBuffer(GetTransferCommandBuffer(), m_StagingBuffer->GetHandle(), destinationBuffer.GetHandle(), 1, &copyRegion);
+            copiedSize += copySize;
+        }
+
+        VkBufferMemoryBarrier barrierInfo = {};
+        barrierInfo.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrierInfo.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrierInfo.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        barrierInfo.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrierInfo.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrierInfo.buffer = destinationBuffer.GetHandle();
+        barrierInfo.offset = 0;
+        barrierInfo.size = VK_WHOLE_SIZE;
+
+        if (!IsOwnershipTransferRequired())
+        {
+            vkCmdPipelineBarrier(GetTransferCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 1, &barrierInfo, 0, nullptr);
+            return;
+        }
+
+        // Release the buffer to the graphics queue family. The matching acquire is recorded on the graphics queue when the batch is submitted.
+        barrierInfo.dstAccessMask = 0;
+        barrierInfo.srcQueueFamilyIndex = m_Device.GetTransferQueueFamilyIndex();
+        barrierInfo.dstQueueFamilyIndex = m_Device.GetGraphicsQueueFamilyIndex();
+
+        vkCmdPipelineBarrier(GetTransferCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrierInfo, 0, nullptr);
+
+        barrierInfo.srcAccessMask = 0;
+        barrierInfo.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        m_RecordingBatch->m_BufferAcquireBarriers.push_back(barrierInfo);
+    }
+
+    void VulkanUploadManager::UploadImage(VulkanImage& destinationImage, const void* data)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        const VkExtent2D extent = destinationImage.GetExtent();
+        const VkDeviceSize rowSize = static_cast<VkDeviceSize>(extent.width) * 4;
+
+        if (rowSize > m_StagingSize)
+        {
+            throw std::runtime_error("Image rows of " + std::to_string(rowSize) + " bytes do not fit the upload staging buffer.");
+        }
+
+        // Images larger than the staging ring are copied a band of rows at a time.
+        const uint32_t maxRowCount = static_cast<uint32_t>(std::min<VkDeviceSize>(extent.height, m_StagingSize / rowSize));
+
+        VkImageMemoryBarrier barrierInfo = {};
+        barrierInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrierInfo.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrierInfo.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrierInfo.image = destinationImage.GetHandle();
+        barrierInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+        uint32_t rowCount = 0;
+
+        for (uint32_t row = 0; row < extent.height; row += rowCount)
+        {
+            rowCount = std::min(maxRowCount, extent.height - row);
+
+            VkBufferImageCopy copyRegion = {};
+            copyRegion.bufferOffset = AllocateStaging(bytes + row * rowSize, rowCount * rowSize);
+            copyRegion.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+            copyRegion.imageOffset = { 0, static_cast<int32_t>(row), 0 };
+            copyRegion.imageExtent = { extent.width, rowCount, 1 };
+
+            const VkCommandBuffer commandBuffer = GetTransferCommandBuffer();
+
+            if (row == 0)
+            {
+                barrierInfo.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                barrierInfo.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrierInfo.srcAccessMask = 0;
+                barrierInfo.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierInfo);
+            }
+
+            vkCmdCopyBufferToImage(commandBuffer, m_StagingBuffer->GetHandle(), destinationImage.GetHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+        }
+
+        barrierInfo.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrierInfo.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrierInfo.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        destinationImage.SetImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        if (!IsOwnershipTransferRequired())
+        {
+            vkCmdPipelineBarrier(GetTransferCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierInfo);
+            return;
+        }
+
+        // Release the image to the graphics queue family. Both halves of the transfer describe the same layout transition, which happens only once.
+        barrierInfo.dstAccessMask = 0;
+        barrierInfo.srcQueueFamilyIndex = m_Device.GetTransferQueueFamilyIndex();
+        barrierInfo.dstQueueFamilyIndex = m_Device.GetGraphicsQueueFamilyIndex();
+
+        vkCmdPipelineBarrier(GetTransferCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrierInfo);
+
+        barrierInfo.srcAccessMask = 0;
+        barrierInfo.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        m_RecordingBatch->m_ImageAcquireBarriers.push_back(barrierInfo);
+    }
+
+    void VulkanUploadManager::Flush()
+    {
+        if (!m_RecordingBatch)
+        {
+            return;
+        }
+
+        Batch& batch = *m_RecordingBatch;
+        VulkanCommandBuffers& transferCommands = *batch.m_TransferCommands;
+        transferCommands.EndRecording(0);
+
+        const VkSemaphore timelineSemaphore = m_TimelineSemaphore->GetHandle();
+        const uint64_t transferValue = ++m_TimelineValue;
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &transferValue;
+
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &transferCommands[0];
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &timelineSemaphore;
+
+        CheckResult(vkQueueSubmit(m_Device.GetTransferQueue(), 1, &submitInfo, nullptr), "Submitting Uploads");
+
+        // The graphics queue takes ownership of the uploaded resources once the copies have completed.
+        if (!batch.m_BufferAcquireBarriers.empty() || !batch.m_ImageAcquireBarriers.empty())
+        {
+            batch.m_AcquireCommands.reset(new VulkanCommandBuffers(*m_GraphicsCommandPool, 1));
+
+            const VkCommandBuffer commandBuffer = batch.m_AcquireCommands->BeginRecording(0);
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr,
+                                 static_cast<uint32_t>(batch.m_BufferAcquireBarriers.size()), batch.m_BufferAcquireBarriers.data(),
+                                 static_cast<uint32_t>(batch.m_ImageAcquireBarriers.size()), batch.m_ImageAcquireBarriers.data());
+            batch.m_AcquireCommands->EndRecording(0);
+
+            const uint64_t acquireValue = ++m_TimelineValue;
+            const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+
+            timelineInfo.waitSemaphoreValueCount = 1;
+            timelineInfo.pWaitSemaphoreValues = &transferValue;
+            timelineInfo.pSignalSemaphoreValues = &acquireValue;
+
+            submitInfo.waitSemaphoreCount = 1;
+            submitInfo.pWaitSemaphores = &timelineSemaphore;
+            submitInfo.pWaitDstStageMask = &waitStage;
+            submitInfo.pCommandBuffers = &(*batch.m_AcquireCommands)[0];
+
+            CheckResult(vkQueueSubmit(m_Device.GetGraphicsQueue(), 1, &submitInfo, nullptr), "Submitting Upload Ownership Acquisitions");
+        }
+
+        batch.m_CompletionValue = m_TimelineValue;
+        m_SubmittedBatches.push_back(std::move(batch));
+        m_RecordingBatch.reset();
+    }
+
+    void VulkanUploadManager::Wait()
+    {
+        Flush();
+
+        if (m_SubmittedBatches.empty())
+        {
+            return;
+        }
+
+        // Batches complete in submission order, so waiting for the last one covers them all.
+        m_TimelineSemaphore->Wait(m_TimelineValue, std::numeric_limits<uint64_t>::max());
+        m_SubmittedBatches.clear();
+    }
+
+    VkDeviceSize VulkanUploadManager::AllocateStaging(const void* data, VkDeviceSize size)
+    {
+        if (size > m_StagingSize)
+        {
+            throw std::runtime_error("Upload of " + std::to_string(size) + " bytes does not fit the upload staging buffer.");
+        }
+
+        VkDeviceSize offset = UploadUtilities::RoundUp(m_StagingHead, UploadUtilities::StagingAlignment);
+
+        if (offset + size > m_StagingSize)
+        {
+            offset = 0; // Wrap around to the start of the ring.
+        }
+
+        const auto isOverlapping = [offset, size](const Batch& batch)
+        {
+            return std::any_of(batch.m_StagingRanges.begin(), batch.m_StagingRanges.end(), [offset, size](const std::pair<VkDeviceSize, VkDeviceSize>& range)
+            {
+                return offset < range.first + range.second && range.first < offset + size;
+            });
+        };
+
+        // Earlier uploads may still be reading from the range. Submit them if they are still being recorded, then wait until they have completed.
+        if (m_RecordingBatch && isOverlapping(*m_RecordingBatch))
+        {
+            Flush();
+        }
+
+        while (std::any_of(m_SubmittedBatches.begin(), m_SubmittedBatches.end(), isOverlapping))
+        {
+            RetireOldestBatch();
+        }
+
+        std::memcpy(m_StagingData + offset, data, size);
+
+        GetTransferCommandBuffer();
+        m_RecordingBatch->m_StagingRanges.emplace_back(offset, size);
+        m_StagingHead = offset + size;
+
+        return offset;
+    }
+
+    VkCommandBuffer VulkanUploadManager::GetTransferCommandBuffer()
+    {
+        if (!m_RecordingBatch)
+        {
+            m_RecordingBatch.reset(new Batch());
+            m_RecordingBatch->m_TransferCommands.reset(new VulkanCommandBuffers(*m_TransferCommandPool, 1));
+            m_RecordingBatch->m_TransferCommands->BeginRecording(0);
+        }
+
+        return (*m_RecordingBatch->m_TransferCommands)[0];
+    }
+
+    void VulkanUploadManager::RetireOldestBatch()
+    {
+        m_TimelineSemaphore->Wait(m_SubmittedBatches.front().m_CompletionValue, std::numeric_limits<uint64_t>::max());
+        m_SubmittedBatches.pop_front();
+    }
+
+    bool VulkanUploadManager::IsOwnershipTransferRequired() const
+    {
+        return m_Device.GetTransferQueueFamilyIndex() != m_Device.GetGraphicsQueueFamilyIndex();
+    }
+}
\ No newline at end of file
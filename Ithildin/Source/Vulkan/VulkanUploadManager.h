@@ -0,0 +1,74 @@
+#pragma once
+#include "../Core/Core.h"
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Vulkan
+{
+    class VulkanBuffer;
+    class VulkanCommandBuffers;
+    class VulkanCommandPool;
+    class VulkanDevice;
+    class VulkanDeviceMemory;
+    class VulkanImage;
+    class VulkanSemaphore;
+
+    // Uploads host data into device local buffers and images through the transfer queue.
+    // Data is copied into a persistently mapped ring of staging memory, and the copies are batched into one command buffer that is only submitted when Flush() is called or the ring runs out of space.
+    // Every submission signals the next value of a timeline semaphore, which tells when its staging memory can be reused and lets Wait() block once for all uploads.
+    class VulkanUploadManager final
+    {
+    public:
+        VulkanUploadManager(const VulkanDevice& device, VkDeviceSize stagingSize);
+        ~VulkanUploadManager();
+
+        const VulkanDevice& GetDevice() const { return m_Device; }
+
+        // The destination buffer must have been created with VK_BUFFER_USAGE_TRANSFER_DST_BIT.
+        void UploadBuffer(VulkanBuffer& destinationBuffer, const void* data, VkDeviceSize size);
+
+        // The image data must be tightly packed 4 byte texels. The image ends up in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+        void UploadImage(VulkanImage& destinationImage, const void* data);
+
+        // Submits the recorded uploads without waiting for them.
+        void Flush();
+
+        // Submits the recorded uploads and blocks until every upload so far has completed.
+        void Wait();
+
+    private:
+        struct Batch
+        {
+            std::unique_ptr<VulkanCommandBuffers> m_TransferCommands;
+            std::unique_ptr<VulkanCommandBuffers> m_AcquireCommands;             // Graphics queue side of the queue family ownership transfers.
+            std::vector<VkBufferMemoryBarrier> m_BufferAcquireBarriers;
+            std::vector<VkImageMemoryBarrier> m_ImageAcquireBarriers;
+            std::vector<std::pair<VkDeviceSize, VkDeviceSize>> m_StagingRanges; // Offset and size of the staging memory the batch copies from.
+            uint64_t m_CompletionValue = 0;
+        };
+
+        VkDeviceSize AllocateStaging(const void* data, VkDeviceSize size);
+        VkCommandBuffer GetTransferCommandBuffer();
+        void RetireOldestBatch();
+        bool IsOwnershipTransferRequired() const;
+
+    private:
+        const VulkanDevice& m_Device;
+        const VkDeviceSize m_StagingSize;
+
+        std::unique_ptr<VulkanCommandPool> m_TransferCommandPool;
+        std::unique_ptr<VulkanCommandPool> m_GraphicsCommandPool;
+        std::unique_ptr<VulkanBuffer> m_StagingBuffer;
+        std::unique_ptr<VulkanDeviceMemory> m_StagingBufferMemory;
+        uint8_t* m_StagingData = nullptr;
+        VkDeviceSize m_StagingHead = 0;
+
+        std::unique_ptr<VulkanSemaphore> m_TimelineSemaphore;
+        uint64_t m_TimelineValue = 0;
+
+        std::unique_ptr<Batch> m_RecordingBatch;
+        std::deque<Batch> m_SubmittedBatches;
+    };
+}
\ No newline at end of file